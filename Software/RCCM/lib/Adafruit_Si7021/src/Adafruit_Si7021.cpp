@@ -86,6 +86,71 @@ float Adafruit_Si7021::readTemperature(void) {
   return temperature;
 }
 
+bool Adafruit_Si7021::startHumidity(void) {
+  Wire.beginTransmission(_i2caddr);
+  Wire.write((uint8_t)SI7021_MEASRH_NOHOLD_CMD);
+  return (Wire.endTransmission() == 0);
+}
+
+bool Adafruit_Si7021::readHumidityResult(float &humidity) {
+  // NACKed while the conversion is still running
+  if (Wire.requestFrom(_i2caddr, 3) != 3) return false;
+  uint16_t hum = Wire.read();
+  hum <<= 8;
+  hum |= Wire.read();
+  if (Wire.read() != crc8(hum)) return false;
+
+  humidity = hum;
+  humidity *= 125;
+  humidity /= 65536;
+  humidity -= 6;
+
+  // Saturated readings can fall slightly outside 0..100 %RH (datasheet 5.1.1)
+  if (humidity > 100) humidity = 100;
+  if (humidity < 0) humidity = 0;
+
+  return true;
+}
+
+bool Adafruit_Si7021::readPreviousTemperature(float &temperature) {
+  Wire.beginTransmission(_i2caddr);
+  Wire.write((uint8_t)SI7021_READPREVTEMP_CMD);
+  if (Wire.endTransmission(false) != 0) return false;
+
+  // No checksum is sent for this command
+  if (Wire.requestFrom(_i2caddr, 2) != 2) return false;
+  uint16_t temp = Wire.read();
+  temp <<= 8;
+  temp |= Wire.read();
+
+  temperature = temp;
+  temperature *= 175.72;
+  temperature /= 65536;
+  temperature -= 46.85;
+
+  return true;
+}
+
+void Adafruit_Si7021::heater(bool h) {
+  uint8_t regValue = readRegister8(SI7021_READRHT_REG_CMD);
+
+  if (h) {
+    regValue |= SI7021_REG_HTRE_BIT;
+  } else {
+    regValue &= ~SI7021_REG_HTRE_BIT;
+  }
+  writeRegister8(SI7021_WRITERHT_REG_CMD, regValue);
+}
+
+bool Adafruit_Si7021::isHeaterEnabled(void) {
+  return (readRegister8(SI7021_READRHT_REG_CMD) & SI7021_REG_HTRE_BIT) != 0;
+}
+
+void Adafruit_Si7021::setHeatLevel(uint8_t level) {
+  if (level > SI7021_HEATER_LEVEL_MAX) level = SI7021_HEATER_LEVEL_MAX;
+  writeRegister8(SI7021_WRITEHEATER_REG_CMD, level);
+}
+
 void Adafruit_Si7021::reset(void) {
   Wire.beginTransmission(_i2caddr);
   Wire.write((uint8_t)SI7021_RESET_CMD);
@@ -142,6 +207,19 @@ void Adafruit_Si7021::writeRegister8(uint8_t reg, uint8_t value) {
   //Serial.print("Wrote $"); Serial.print(reg, HEX); Serial.print(": 0x"); Serial.println(value, HEX);
 }
 
+// x^8 + x^5 + x^4 + 1, MSB first (datasheet 5.1)
+uint8_t Adafruit_Si7021::crc8(uint16_t value) {
+  uint8_t crc = 0;
+
+  for (int8_t i = 1; i >= 0; i--) {
+    crc ^= (uint8_t)(value >> (i * 8));
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
 uint8_t Adafruit_Si7021::readRegister8(uint8_t reg) {
   uint8_t value;
   Wire.beginTransmission(_i2caddr);
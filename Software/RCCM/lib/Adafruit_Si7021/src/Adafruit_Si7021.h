@@ -23,6 +23,9 @@ Modified for Particle Photon/Electron
 Need application.h for types    RMB
 */
 
+#ifndef __Si7021_H__
+#define __Si7021_H__
+
 #include "application.h"
 
 
@@ -45,6 +48,10 @@ Need application.h for types    RMB
 #define SI7021_ID2_CMD                   0xFCC9
 #define SI7021_FIRMVERS_CMD              0x84B8
 
+#define SI7021_REG_HTRE_BIT              0x04       // User register 1; heater enable
+#define SI7021_HEATER_LEVEL_MAX          0x0F       // Heater control register; 3.09 mA (0x00) to 94.2 mA (0x0F)
+#define SI7021_CONVERT_MS                25         // No hold RH + temperature conversion, 12/14 bit (max 12 + 10.8 ms)
+
 
 /*=========================================================================*/
 
@@ -58,6 +65,16 @@ class Adafruit_Si7021 {
   void readSerialNumber(void);
   float readHumidity(void);
 
+  // Non blocking humidity: start a no hold conversion, then collect it at least SI7021_CONVERT_MS later.
+  // The temperature measured for the RH compensation is read back without a second conversion.
+  bool startHumidity(void);
+  bool readHumidityResult(float &humidity);
+  bool readPreviousTemperature(float &temperature);
+
+  void heater(bool h);
+  bool isHeaterEnabled(void);
+  void setHeatLevel(uint8_t level);
+
   uint32_t sernum_a, sernum_b;
 
  private:
@@ -65,8 +82,11 @@ class Adafruit_Si7021 {
   uint8_t readRegister8(uint8_t reg);
   uint16_t readRegister16(uint8_t reg);
   void writeRegister8(uint8_t reg, uint8_t value);
+  static uint8_t crc8(uint16_t value);
 
   int8_t  _i2caddr;
 };
 
 /**************************************************************************/
+
+#endif // __Si7021_H__
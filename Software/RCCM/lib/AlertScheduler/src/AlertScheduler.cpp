@@ -0,0 +1,203 @@
+
+// INCLUDEs
+#include "AlertScheduler.h"
+
+
+
+
+// CONSTRUCTOR
+AlertScheduler::AlertScheduler(LocalTimeHMS heartbeatTime, LocalTimeHMS quietStart, LocalTimeHMS quietEnd) :
+    heartbeatTime(heartbeatTime), quietStart(quietStart), quietEnd(quietEnd), heartbeatInterval(86400),
+    started(false), scheduledAt(0), nextHeartbeat(0), nextQuietStart(0), nextQuietEnd(0), quiet(false), digest(0) {
+
+}
+
+
+// DESTRUCTOR
+AlertScheduler::~AlertScheduler() {
+
+}
+
+
+// Compute all deadlines.  Call once the time zone is configured & the clock is valid; deadlines computed from an
+// unset clock would all be in the past at the first time sync.
+void AlertScheduler::begin(time_t now) {
+    started = true;
+    scheduleHeartbeat(now);
+    scheduleQuietHours(now);
+}
+
+
+// Whole days (86400 * N) or a divisor of a day; anything else is refused and the interval is unchanged.  Takes
+// effect from the next heartbeat check.
+bool AlertScheduler::setHeartbeatInterval(long intervalSeconds) {
+    if (heartbeatIntervalValid(intervalSeconds) == false) {
+        return false;
+    }
+
+    heartbeatInterval   = intervalSeconds;
+    nextHeartbeat       = 0;
+
+    return true;
+}
+
+
+// True once per heartbeat slot.  Slots missed while offline (or across a clock change) collapse into one.
+bool AlertScheduler::heartbeatDue(time_t now) {
+    if (started == false) {
+        return false;
+    }
+    checkClock(now);
+
+    if (nextHeartbeat == 0) {
+        scheduleHeartbeat(now);
+        return false;
+    }
+    if (now < nextHeartbeat) {
+        return false;
+    }
+
+    scheduleHeartbeat(now);
+    return true;
+}
+
+
+//
+bool AlertScheduler::isQuiet(time_t now) {
+    if (started == false) {
+        return false;
+    }
+    checkClock(now);
+
+    if ((nextQuietStart == 0) || (now >= nextQuietStart) || (now >= nextQuietEnd)) {
+        scheduleQuietHours(now);
+    }
+
+    return quiet;
+}
+
+
+// Hold alertBits for the digest if it is quiet hours.  Returns false (publish now) otherwise.
+bool AlertScheduler::defer(uint32_t alertBits, time_t now) {
+    if (isQuiet(now) == false) {
+        return false;
+    }
+
+    digest |= alertBits;
+    return true;
+}
+
+
+// Deferred alert bits, once quiet hours are over; 0 if there are none or it is still quiet.  Clears the digest.
+uint32_t AlertScheduler::takeDigest(time_t now) {
+    uint32_t alertBits;
+
+    if ((digest == 0) || (isQuiet(now) == true)) {
+        return 0;
+    }
+
+    alertBits   = digest;
+    digest      = 0;
+
+    return alertBits;
+}
+
+
+// Earliest cached deadline (UTC); nothing changes state before then.
+time_t AlertScheduler::nextDeadline(void) const {
+    time_t quietDeadline = (quiet == true) ? nextQuietEnd : nextQuietStart;
+
+    return (nextHeartbeat < quietDeadline) ? nextHeartbeat : quietDeadline;
+}
+
+
+//
+void AlertScheduler::scheduleHeartbeat(time_t now) {
+    scheduledAt = now;
+
+    if (heartbeatInterval < 86400) {
+        // Divisor of a day: the slots are fixed local times of day, heartbeatTime plus multiples of the interval,
+        // each converted on its own local date.  Over a DST change the UTC gap is an hour longer or shorter rather
+        // than a slot repeating (fall back); a slot in the spring forward gap does not exist that day and is skipped.
+        convert.withTime(now).convert();
+        LocalTimeValue today = convert.localTimeValue;
+
+        long local = today.hms().toSeconds();
+        long phase = (local - heartbeatTime.toSeconds()) % heartbeatInterval;
+        if (phase < 0) {
+            phase += heartbeatInterval;
+        }
+
+        long slot = local - phase;
+        while (true) {
+            slot += heartbeatInterval;
+            LocalTimeValue slotTime = today;
+            slotTime.tm_hour    = 0;
+            slotTime.tm_min     = 0;
+            slotTime.tm_sec     = slot;     // Normalized (onto the next day, too) by toUTC()
+            nextHeartbeat       = slotTime.toUTC(convert.config);
+            if (nextHeartbeat <= now) {
+                continue;
+            }
+
+            // (toUTC() moves a time in the gap back an hour; it then reads differently.)
+            convert.withTime(nextHeartbeat).convert();
+            if (convert.localTimeValue.hms().toSeconds() == (slot % 86400)) {
+                break;
+            }
+        }
+        return;
+    }
+
+    // Whole days: heartbeatTime every Nth local day, counted on from the slot that just came due.  The local date is
+    // stepped, not the UTC time; a day is 23 or 25 hours long across a DST change.
+    if ((nextHeartbeat != 0) && (nextHeartbeat <= now)) {
+        convert.withTime(nextHeartbeat).convert();
+        LocalTimeValue slotTime = convert.localTimeValue;
+        slotTime.tm_mday    += heartbeatInterval / 86400;     // Normalized (onto the next month, too) by toUTC()
+        slotTime.setHMS(heartbeatTime);
+        nextHeartbeat       = slotTime.toUTC(convert.config);
+        if (nextHeartbeat > now) {
+            return;
+        }
+    }
+
+    // First schedule, or slots were missed; next occurrence from now.
+    convert.withTime(now).convert();
+    convert.nextLocalTime(heartbeatTime);
+    nextHeartbeat = convert.time;
+}
+
+
+//
+void AlertScheduler::scheduleQuietHours(time_t now) {
+    scheduledAt = now;
+
+    if (quietStart.toSeconds() == quietEnd.toSeconds()) {
+        // Disabled; look again in a day.
+        quiet           = false;
+        nextQuietStart  = now + 86400;
+        nextQuietEnd    = now + 86400;
+        return;
+    }
+
+    convert.withTime(now).convert();
+    convert.nextLocalTime(quietStart);
+    nextQuietStart = convert.time;
+
+    convert.withTime(now).convert();
+    convert.nextLocalTime(quietEnd);
+    nextQuietEnd = convert.time;
+
+    // Inside quiet hours exactly when they end before they next begin.
+    quiet = (nextQuietEnd < nextQuietStart);
+}
+
+
+// Deadlines are only valid going forward; a clock stepped backwards (e.g. a cloud time correction) recomputes them.
+void AlertScheduler::checkClock(time_t now) {
+    if (now < scheduledAt) {
+        nextHeartbeat = 0;
+        begin(now);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef AlertScheduler_h
+#define AlertScheduler_h
+
+//
+#include <Particle.h>
+#include <LocalTimeRK.h>
+
+
+// Local (wall clock) time alert scheduling.
+//  - Heartbeats land on a fixed local time of day (e.g. 08:00 daily, or on the hour when hourly) instead of
+//    drifting with boot time.
+//  - Non-critical alerts raised during quiet hours are held as bits and handed back once, as a digest, when
+//    quiet hours end.
+// All deadlines are absolute UTC times computed once through LocalTimeConvert (so DST is handled there) and
+// cached; the per loop() checks are plain comparisons against Time.now().  Nothing is due, and it is never quiet,
+// until begin() is called with a valid clock.
+class AlertScheduler {
+    public:
+        // PUBLIC - Class Functions
+        AlertScheduler(LocalTimeHMS heartbeatTime, LocalTimeHMS quietStart, LocalTimeHMS quietEnd);
+        ~AlertScheduler();
+        void begin(time_t now);
+        bool setHeartbeatInterval(long intervalSeconds);
+        bool heartbeatDue(time_t now);
+        bool isQuiet(time_t now);
+        bool defer(uint32_t alertBits, time_t now);
+        uint32_t takeDigest(time_t now);
+        time_t nextDeadline(void) const;
+
+        // Heartbeat slots are local times of day, so the interval must be whole days or divide a day evenly.
+        static constexpr bool heartbeatIntervalValid(long intervalSeconds) {
+            return (intervalSeconds > 0) && (((intervalSeconds % 86400) == 0) || ((86400 % intervalSeconds) == 0));
+        }
+
+    private:
+        // PRIVATE - Class Variables
+        LocalTimeHMS        heartbeatTime;      // Local time of day heartbeats are aligned to
+        LocalTimeHMS        quietStart;         // Local time quiet hours begin; equal to quietEnd disables them
+        LocalTimeHMS        quietEnd;           // Local time quiet hours end & the digest is released
+        long                heartbeatInterval;  // s; whole days, or a divisor of a day
+        bool                started;            // begin() has been called
+
+        LocalTimeConvert    convert;            // Keeps this year's DST transitions cached
+        time_t              scheduledAt;        // now at the last full reschedule; a clock step backwards forces another
+        time_t              nextHeartbeat;
+        time_t              nextQuietStart;
+        time_t              nextQuietEnd;
+        bool                quiet;
+        uint32_t            digest;             // Deferred alert bits
+
+        // PRIVATE - Class Functions
+        void scheduleHeartbeat(time_t now);
+        void scheduleQuietHours(time_t now);
+        void checkClock(time_t now);
+
+};
+
+#endif
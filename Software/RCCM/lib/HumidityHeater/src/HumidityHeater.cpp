@@ -0,0 +1,150 @@
+
+// INCLUDEs
+#include "HumidityHeater.h"
+
+
+
+
+// CONSTRUCTOR
+HumidityHeater::HumidityHeater(Adafruit_Si7021 &sensor, uint32_t samplePeriodMs, float triggerRh, uint32_t triggerHoldMs, uint32_t heatMs, uint32_t settleMs, uint8_t heatLevel) :
+    sensor(sensor), samplePeriodMs(samplePeriodMs), triggerRh(triggerRh), triggerHoldMs(triggerHoldMs), heatMs(heatMs), settleMs(settleMs), heatLevel(heatLevel),
+    current(IDLE), stateMs(0), lastSampleMs(0), saturated(false), saturatedSinceMs(0), cycles(0), fresh(false) {
+
+    latest.temperatureC = NAN;
+    latest.humidity     = NAN;
+    latest.sampleMs     = 0;
+    latest.valid        = false;
+}
+
+
+// DESTRUCTOR
+HumidityHeater::~HumidityHeater() {
+
+}
+
+
+// Call after the sensor's begin().  Heater off (a reset already clears it), then one blocking sample so
+// there is a reading before the first process().
+void HumidityHeater::begin(void) {
+    sensor.heater(false);
+    sensor.setHeatLevel(heatLevel);
+
+    current = CONVERTING;
+    lastSampleMs = millis();
+    if (sensor.startHumidity() == true) {
+        delay(SI7021_CONVERT_MS);
+    }
+    collectSample();
+}
+
+
+// Call from loop(); starts or collects a sample, or steps the heater cycle.
+void HumidityHeater::process(void) {
+    uint32_t now = millis();
+
+    switch (current) {
+        case IDLE:
+            if ((now - lastSampleMs) >= samplePeriodMs) {
+                lastSampleMs = now;
+                current = CONVERTING;
+                if (sensor.startHumidity() == false) {
+                    // Not acknowledged; counts as a failed sample & is retried next period.
+                    collectSample();
+                }
+            }
+            break;
+
+        case CONVERTING:
+            if ((now - lastSampleMs) >= SI7021_CONVERT_MS) {
+                collectSample();
+            }
+            break;
+
+        case HEATING:
+            if ((now - stateMs) >= heatMs) {
+                sensor.heater(false);
+                current = SETTLING;
+                stateMs = now;
+            }
+            break;
+
+        case SETTLING:
+            if ((now - stateMs) >= settleMs) {
+                // Sample straight away; saturation is timed afresh from here.
+                current = IDLE;
+                lastSampleMs = now - samplePeriodMs;
+            }
+            break;
+    }
+}
+
+
+// Saturation tracking for one good sample.  Starts a heater cycle once RH has been held at or above triggerRh.
+void HumidityHeater::addSample(float humidity, uint32_t timeMs) {
+    if (humidity < triggerRh) {
+        saturated = false;
+        return;
+    }
+
+    if (saturated == false) {
+        saturated = true;
+        saturatedSinceMs = timeMs;
+    }
+
+    if ((timeMs - saturatedSinceMs) >= triggerHoldMs) {
+        sensor.heater(true);
+        current = HEATING;
+        stateMs = millis();
+        saturated = false;
+        cycles++;
+    }
+}
+
+
+// Copy out the latest reading.  While masked() this is the last reading taken before the heater went on.
+bool HumidityHeater::takeReading(struct reading &sample) {
+    bool wasFresh = fresh;
+
+    sample = latest;
+    fresh = false;
+
+    return wasFresh;
+}
+
+
+// Heater on or settling; the sensor's own readings are not ambient.
+bool HumidityHeater::masked(void) const {
+    return (current == HEATING) || (current == SETTLING);
+}
+
+
+//
+uint32_t HumidityHeater::takeCycles(void) {
+    uint32_t taken = cycles;
+
+    cycles = 0;
+
+    return taken;
+}
+
+
+// Read back the conversion started at lastSampleMs.  Leaves IDLE unless the sample starts a heater cycle.
+void HumidityHeater::collectSample(void) {
+    float humidity;
+    float temperatureC;
+
+    current = IDLE;
+    fresh = true;
+
+    if ((sensor.readHumidityResult(humidity) == false) || (sensor.readPreviousTemperature(temperatureC) == false)) {
+        latest.valid = false;
+        return;
+    }
+
+    latest.temperatureC = temperatureC;
+    latest.humidity     = humidity;
+    latest.sampleMs     = lastSampleMs;
+    latest.valid        = true;
+
+    addSample(humidity, lastSampleMs);
+}
@@ -0,0 +1,64 @@
+#ifndef HumidityHeater_h
+#define HumidityHeater_h
+
+//
+#include <Particle.h>
+#include <Adafruit_Si7021.h>
+
+
+// Si7021 sampling with heater cycles for condensation recovery.  In a closed, damp cabin the sensor saturates
+// and its RH reading then drifts high; once RH has stayed at or above triggerRh for triggerHoldMs, the on-chip
+// heater is run for heatMs to dry the sensor, then left off for settleMs while the die cools back to ambient.
+// Readings are masked from heater on to the end of the settle period; the last good reading is held instead.
+//
+// Nothing waits: a sample is a no hold conversion started in one process() call & collected in a later one,
+// and heater on/off are single register writes.  Saturation is timed from samples taken after the settle
+// period, so while RH stays high the heater runs at most heatMs per (triggerHoldMs + heatMs + settleMs).
+class HumidityHeater {
+    public:
+        // PUBLIC - Class Variables
+        struct reading {
+            float       temperatureC;       // Measured with the RH conversion
+            float       humidity;           // %RH, 0..100
+            uint32_t    sampleMs;           // millis() when the conversion was started
+            bool        valid;              // Latest attempt read back with a good checksum; values held otherwise
+        };
+
+        // PUBLIC - Class Functions
+        HumidityHeater(Adafruit_Si7021 &sensor, uint32_t samplePeriodMs, float triggerRh, uint32_t triggerHoldMs, uint32_t heatMs, uint32_t settleMs, uint8_t heatLevel);
+        ~HumidityHeater();
+        void begin(void);
+        void process(void);
+        void addSample(float humidity, uint32_t timeMs);
+        bool takeReading(struct reading &sample);
+        bool masked(void) const;
+        uint32_t takeCycles(void);
+
+    private:
+        // PRIVATE - Class Variables
+        enum state { IDLE, CONVERTING, HEATING, SETTLING };
+
+        Adafruit_Si7021 &sensor;
+        uint32_t    samplePeriodMs;
+        float       triggerRh;
+        uint32_t    triggerHoldMs;
+        uint32_t    heatMs;
+        uint32_t    settleMs;
+        uint8_t     heatLevel;
+
+        enum state  current;
+        uint32_t    stateMs;                // millis() entering HEATING / SETTLING
+        uint32_t    lastSampleMs;
+        bool        saturated;
+        uint32_t    saturatedSinceMs;
+        uint32_t    cycles;                 // Heater cycles since takeCycles()
+
+        struct reading  latest;
+        bool            fresh;
+
+        // PRIVATE - Class Functions
+        void collectSample(void);
+
+};
+
+#endif
@@ -116,11 +116,15 @@ void JsonBuffer::nullTerminate() {
 
 //
 
-JsonParser::JsonParser() : JsonBuffer(), tokens(0), tokensEnd(0), maxTokens(0) {
+JsonParser::JsonParser() : JsonBuffer(), tokens(0), tokensEnd(0), maxTokens(0),
+		keyIndex(0), keyIndexSlots(0), keyIndexEnabled(false), keyIndexStaticSlots(false), keyIndexBuilt(false), keyIndexPartial(false), keyIndexFailed(false),
+		siblingIndex(0), siblingIndexEntries(0), siblingIndexEnabled(false), siblingIndexStatic(false), siblingIndexBuilt(false) {
 }
 
 JsonParser::JsonParser(char *buffer, size_t bufferLen, JsonParserGeneratorRK::jsmntok_t *tokens, size_t maxTokens) :
-		JsonBuffer(buffer, bufferLen), tokens(tokens), maxTokens(maxTokens) {
+		JsonBuffer(buffer, bufferLen), tokens(tokens), maxTokens(maxTokens),
+		keyIndex(0), keyIndexSlots(0), keyIndexEnabled(false), keyIndexStaticSlots(false), keyIndexBuilt(false), keyIndexPartial(false), keyIndexFailed(false),
+		siblingIndex(0), siblingIndexEntries(0), siblingIndexEnabled(false), siblingIndexStatic(false), siblingIndexBuilt(false) {
 
 }
 
@@ -129,25 +133,35 @@ JsonParser::~JsonParser() {
 	if (!staticBuffers && tokens) {
 		free(tokens);
 	}
+	if (!keyIndexStaticSlots && keyIndex) {
+		free(keyIndex);
+	}
+	if (!siblingIndexStatic && siblingIndex) {
+		free(siblingIndex);
+	}
 }
 
 bool JsonParser::allocateTokens(size_t maxTokens) {
 	if (!staticBuffers) {
-		JsonParserGeneratorRK::jsmntok_t *newTokens;
-		if (tokens) {
-			newTokens = (JsonParserGeneratorRK::jsmntok_t *)realloc(buffer, sizeof(JsonParserGeneratorRK::jsmntok_t) * maxTokens);
-		}
-		else {
-			newTokens = (JsonParserGeneratorRK::jsmntok_t *)malloc(sizeof(JsonParserGeneratorRK::jsmntok_t) * maxTokens);
-		}
-		if (newTokens) {
-			tokens = newTokens;
-			this->maxTokens = maxTokens;
-			return true;
-		}
-		else {
-			return false;
-		}
+		return growTokens(maxTokens);
+	}
+	else {
+		return false;
+	}
+}
+
+bool JsonParser::growTokens(size_t maxTokens) {
+	JsonParserGeneratorRK::jsmntok_t *newTokens;
+	if (tokens) {
+		newTokens = (JsonParserGeneratorRK::jsmntok_t *)realloc(tokens, sizeof(JsonParserGeneratorRK::jsmntok_t) * maxTokens);
+	}
+	else {
+		newTokens = (JsonParserGeneratorRK::jsmntok_t *)malloc(sizeof(JsonParserGeneratorRK::jsmntok_t) * maxTokens);
+	}
+	if (newTokens) {
+		tokens = newTokens;
+		this->maxTokens = maxTokens;
+		return true;
 	}
 	else {
 		return false;
@@ -155,24 +169,48 @@ bool JsonParser::allocateTokens(size_t maxTokens) {
 }
 
 bool JsonParser::parse() {
+	keyIndexBuilt = false;
+	keyIndexFailed = false;
+	siblingIndexBuilt = false;
+
 	if (offset == 0) {
 		// If addString or addData is not called, or called with an empty string,
 		// do not return true, see issue #7.
 		return false;
 	}
 
-	if (tokens) {
-		// Try to use the existing token buffer if possible
+	if (staticBuffers && tokens) {
+		// Static token pool: one pass, and if there is not enough space, fail. Never mallocs.
 		JsonParserGeneratorRK::jsmn_init(&parser);
+		int result = JsonParserGeneratorRK::jsmn_parse(&parser, buffer, offset, tokens, maxTokens);
+		if (result < 0) {
+			// Failed to parse: JSMN_ERROR_NOMEM, JSMN_ERROR_INVAL or JSMN_ERROR_PART
+			return false;
+		}
+		tokensEnd = &tokens[result];
+		if (siblingIndexEnabled) {
+			buildSiblingIndex();
+		}
+		return true;
+	}
+
+	// Growable token arena: one pass over the data. jsmn leaves the parser state intact when it
+	// runs out of tokens (JSMN_ERROR_NOMEM), so the arena is doubled and parsing resumes from
+	// where it stopped instead of counting tokens first and parsing everything again.
+	if (!tokens || maxTokens == 0) {
+		// Rough guess of one token per 8 bytes of JSON; it only needs to be in the right ballpark.
+		if (!growTokens((offset / 8) + 8)) {
+			return false;
+		}
+	}
+
+	JsonParserGeneratorRK::jsmn_init(&parser);
+	for(;;) {
 		int result = JsonParserGeneratorRK::jsmn_parse(&parser, buffer, offset, tokens, maxTokens);
 		if (result == JsonParserGeneratorRK::JSMN_ERROR_NOMEM) {
-			if (staticBuffers) {
-				// If using static buffers and there is not enough space, fail
+			if (!growTokens(maxTokens * 2)) {
 				return false;
 			}
-			free(tokens);
-			tokens = 0;
-			maxTokens = 0;
 		}
 		else
 		if (result < 0) {
@@ -181,32 +219,12 @@ bool JsonParser::parse() {
 		}
 		else {
 			tokensEnd = &tokens[result];
-			return true;
+			break;
 		}
 	}
 
-	// Pass 1: determine now many tokens we need
-	JsonParserGeneratorRK::jsmn_init(&parser);
-	int result = JsonParserGeneratorRK::jsmn_parse(&parser, buffer, offset, 0, 0);
-	if (result < 0) {
-		// Failed to parse: JSMN_ERROR_INVAL or JSMN_ERROR_PART
-		return false;
-	}
-
-	// If we get here, tokens will always be == 0; it would have been freed if it was
-	// too small, and this code is never executed for staticBuffers == true
-
-	maxTokens = (size_t) result;
-	if (maxTokens > 0) {
-		tokens = (JsonParserGeneratorRK::jsmntok_t *)malloc(sizeof(JsonParserGeneratorRK::jsmntok_t) * maxTokens);
-
-		JsonParserGeneratorRK::jsmn_init(&parser);
-		int result = JsonParserGeneratorRK::jsmn_parse(&parser, buffer, offset, tokens, maxTokens);
-
-		tokensEnd = &tokens[result];
-	}
-	else {
-		tokensEnd = tokens;
+	if (siblingIndexEnabled) {
+		buildSiblingIndex();
 	}
 
 	/*
@@ -274,9 +292,14 @@ const JsonParserGeneratorRK::jsmntok_t *JsonParser::getOuterToken() const {
 
 
 bool JsonParser::skipObject(const JsonParserGeneratorRK::jsmntok_t *container, const JsonParserGeneratorRK::jsmntok_t *&obj) const {
-	int curObjectEnd = obj->end;
+	if (siblingIndexBuilt) {
+		obj = &tokens[siblingIndex[obj - tokens]];
+	}
+	else {
+		int curObjectEnd = obj->end;
 
-	while(++obj < tokensEnd && obj->end < container->end && obj->end <= curObjectEnd) {
+		while(++obj < tokensEnd && obj->end < container->end && obj->end <= curObjectEnd) {
+		}
 	}
 
 	if (obj >= tokensEnd || obj->end > container->end) {
@@ -286,6 +309,62 @@ bool JsonParser::skipObject(const JsonParserGeneratorRK::jsmntok_t *container, c
 	return true;
 }
 
+void JsonParser::enableSiblingIndex(uint16_t *nextSibling, size_t numEntries) {
+	if (nextSibling) {
+		if (!siblingIndexStatic && siblingIndex) {
+			free(siblingIndex);
+		}
+		siblingIndex = nextSibling;
+		siblingIndexEntries = numEntries;
+		siblingIndexStatic = true;
+	}
+	siblingIndexEnabled = true;
+	siblingIndexBuilt = false;
+}
+
+bool JsonParser::buildSiblingIndex() {
+	size_t numTokens = tokensEnd - tokens;
+
+	if (numTokens >= 0xffff) {
+		return false;
+	}
+	if (siblingIndexEntries < numTokens) {
+		if (siblingIndexStatic) {
+			return false;
+		}
+		uint16_t *newIndex = (uint16_t *) realloc(siblingIndex, sizeof(uint16_t) * numTokens);
+		if (!newIndex) {
+			return false;
+		}
+		siblingIndex = newIndex;
+		siblingIndexEntries = numTokens;
+	}
+
+	// The next sibling of a token is the first later token that ends after it does (the same rule
+	// skipObject() walks). One pass with a stack of tokens still waiting for theirs; the stack is
+	// threaded through the pending entries of siblingIndex itself so no extra memory is needed.
+	const uint16_t stackEmpty = 0xffff;
+	uint16_t stackTop = stackEmpty;
+
+	for(size_t ii = 0; ii < numTokens; ii++) {
+		while(stackTop != stackEmpty && tokens[stackTop].end < tokens[ii].end) {
+			uint16_t below = siblingIndex[stackTop];
+			siblingIndex[stackTop] = (uint16_t) ii;
+			stackTop = below;
+		}
+		siblingIndex[ii] = stackTop;
+		stackTop = (uint16_t) ii;
+	}
+	while(stackTop != stackEmpty) {
+		uint16_t below = siblingIndex[stackTop];
+		siblingIndex[stackTop] = (uint16_t) numTokens;
+		stackTop = below;
+	}
+
+	siblingIndexBuilt = true;
+	return true;
+}
+
 bool JsonParser::getKeyValueTokenByIndex(const JsonParserGeneratorRK::jsmntok_t *container, const JsonParserGeneratorRK::jsmntok_t *&key, const JsonParserGeneratorRK::jsmntok_t *&value, size_t desiredIndex) const {
 
 	size_t index = 0;
@@ -310,17 +389,172 @@ bool JsonParser::getKeyValueTokenByIndex(const JsonParserGeneratorRK::jsmntok_t
 
 bool JsonParser::getValueTokenByKey(const JsonParserGeneratorRK::jsmntok_t *container, const char *name, const JsonParserGeneratorRK::jsmntok_t *&value) const {
 
-	const JsonParserGeneratorRK::jsmntok_t *key;
-	String keyName;
+	size_t nameLen = strlen(name);
+
+	if (keyIndexEnabled && !keyIndexBuilt && !keyIndexFailed) {
+		// Built once per parse(); if it can't be, every lookup until the next parse() goes straight to the scan
+		keyIndexFailed = !buildKeyIndex();
+	}
+
+	if (keyIndexBuilt && !keyIndexPartial) {
+		size_t containerIndex = container - tokens;
+		size_t mask = keyIndexSlots - 1;
+
+		for(size_t slot = keyHash(containerIndex, name, nameLen) & mask; keyIndex[slot].key != 0; slot = (slot + 1) & mask) {
+			if (keyIndex[slot].container == containerIndex && keyEquals(&tokens[keyIndex[slot].key], name, nameLen)) {
+				value = &tokens[keyIndex[slot].key + 1];
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Linear scan, one walk over the object
+	const JsonParserGeneratorRK::jsmntok_t *key = container + 1;
 
-	for(size_t ii = 0; getKeyValueTokenByIndex(container, key, value, ii); ii++) {
-		if (getTokenValue(key, keyName) && keyName == name) {
+	while(key < tokensEnd && key->end < container->end) {
+		const JsonParserGeneratorRK::jsmntok_t *keyValue = key;
+		if (!skipObject(container, keyValue)) {
+			break;
+		}
+		if (keyEquals(key, name, nameLen)) {
+			value = keyValue;
 			return true;
 		}
+		key = keyValue;
+		if (!skipObject(container, key)) {
+			break;
+		}
 	}
 	return false;
 }
 
+void JsonParser::enableKeyIndex(JsonParserKeySlot *slots, size_t numSlots) {
+	if (slots) {
+		if (!keyIndexStaticSlots && keyIndex) {
+			free(keyIndex);
+		}
+		keyIndex = slots;
+		keyIndexSlots = numSlots;
+		keyIndexStaticSlots = true;
+	}
+	keyIndexEnabled = true;
+	keyIndexBuilt = false;
+	keyIndexFailed = false;
+}
+
+bool JsonParser::buildKeyIndex() const {
+	size_t numTokens = tokensEnd - tokens;
+	size_t numKeys = 0;
+
+	if (numTokens == 0 || numTokens > 0xffff) {
+		return false;
+	}
+
+	for(const JsonParserGeneratorRK::jsmntok_t *token = tokens; token < tokensEnd; token++) {
+		if (token->type == JsonParserGeneratorRK::JSMN_OBJECT) {
+			numKeys += token->size;
+		}
+	}
+
+	// Keep the load factor at or under 1/2 so probe sequences stay short
+	size_t slotsNeeded = 8;
+	while(slotsNeeded < numKeys * 2) {
+		slotsNeeded *= 2;
+	}
+
+	if (keyIndexStaticSlots) {
+		if (keyIndexSlots < slotsNeeded || (keyIndexSlots & (keyIndexSlots - 1)) != 0) {
+			return false;
+		}
+	}
+	else
+	if (keyIndexSlots < slotsNeeded) {
+		JsonParserKeySlot *newIndex = (JsonParserKeySlot *) realloc(keyIndex, sizeof(JsonParserKeySlot) * slotsNeeded);
+		if (!newIndex) {
+			return false;
+		}
+		keyIndex = newIndex;
+		keyIndexSlots = slotsNeeded;
+	}
+
+	memset(keyIndex, 0, sizeof(JsonParserKeySlot) * keyIndexSlots);
+	keyIndexPartial = false;
+
+	for(size_t tokenIndex = 0; tokenIndex < numTokens; ) {
+		tokenIndex = indexKeys(tokenIndex);
+	}
+
+	keyIndexBuilt = true;
+	return true;
+}
+
+size_t JsonParser::indexKeys(size_t tokenIndex) const {
+	size_t numTokens = tokensEnd - tokens;
+	const JsonParserGeneratorRK::jsmntok_t *container = &tokens[tokenIndex];
+	size_t next = tokenIndex + 1;
+
+	if (container->type == JsonParserGeneratorRK::JSMN_OBJECT) {
+		size_t mask = keyIndexSlots - 1;
+
+		for(int ii = 0; ii < container->size && next < numTokens; ii++) {
+			const JsonParserGeneratorRK::jsmntok_t *key = &tokens[next];
+			const char *keyStart = &buffer[key->start];
+			size_t keyLen = key->end - key->start;
+
+			if (memchr(keyStart, '\\', keyLen) == 0) {
+				// Linear probing; duplicate keys keep their document order so the first one wins, as with a scan
+				size_t slot = keyHash(tokenIndex, keyStart, keyLen) & mask;
+				while(keyIndex[slot].key != 0) {
+					slot = (slot + 1) & mask;
+				}
+				keyIndex[slot].container = (uint16_t) tokenIndex;
+				keyIndex[slot].key = (uint16_t) next;
+			}
+			else {
+				keyIndexPartial = true;
+			}
+
+			next++;
+			if (key->size > 0 && next < numTokens) {
+				next = indexKeys(next);
+			}
+		}
+	}
+	else
+	if (container->type == JsonParserGeneratorRK::JSMN_ARRAY) {
+		for(int ii = 0; ii < container->size && next < numTokens; ii++) {
+			next = indexKeys(next);
+		}
+	}
+
+	return next;
+}
+
+bool JsonParser::keyEquals(const JsonParserGeneratorRK::jsmntok_t *key, const char *name, size_t nameLen) const {
+	const char *keyStart = &buffer[key->start];
+	size_t keyLen = key->end - key->start;
+
+	if (memchr(keyStart, '\\', keyLen) == 0) {
+		// No escapes, so the raw bytes are the key
+		return keyLen == nameLen && memcmp(keyStart, name, nameLen) == 0;
+	}
+
+	String keyName;
+	return getTokenValue(key, keyName) && keyName == name;
+}
+
+uint32_t JsonParser::keyHash(size_t container, const char *name, size_t nameLen) {
+	uint32_t hash = 2166136261UL;
+
+	hash = (hash ^ (container & 0xff)) * 16777619UL;
+	hash = (hash ^ ((container >> 8) & 0xff)) * 16777619UL;
+	for(size_t ii = 0; ii < nameLen; ii++) {
+		hash = (hash ^ (uint8_t) name[ii]) * 16777619UL;
+	}
+	return hash;
+}
+
 bool JsonParser::getValueTokenByIndex(const JsonParserGeneratorRK::jsmntok_t *container, size_t desiredIndex, const JsonParserGeneratorRK::jsmntok_t *&value) const {
 	size_t index = 0;
 	const JsonParserGeneratorRK::jsmntok_t *token = container + 1;
@@ -691,7 +925,7 @@ void JsonParserString::append(const char *str, size_t len) {
 //
 //
 //
-JsonWriter::JsonWriter() : JsonBuffer(), floatPlaces(-1) {
+JsonWriter::JsonWriter() : JsonBuffer(), floatPlaces(-1), sink(0) {
 	init();
 }
 
@@ -699,7 +933,7 @@ JsonWriter::~JsonWriter() {
 
 }
 
-JsonWriter::JsonWriter(char *buffer, size_t bufferLen) : JsonBuffer(buffer, bufferLen), floatPlaces(-1) {
+JsonWriter::JsonWriter(char *buffer, size_t bufferLen) : JsonBuffer(buffer, bufferLen), floatPlaces(-1), sink(0) {
 	init();
 }
 
@@ -731,6 +965,21 @@ bool JsonWriter::startObjectOrArray(char startChar, char endChar) {
 }
 
 
+bool JsonWriter::flush() {
+	if (!sink) {
+		return true;
+	}
+	if (offset > 0 && !truncated) {
+		// There's a byte reserved past bufferLen for this terminator
+		buffer[offset] = 0;
+		if (!sink->write(buffer, offset)) {
+			truncated = true;
+		}
+	}
+	offset = 0;
+	return !truncated;
+}
+
 void JsonWriter::finishObjectOrArray() {
 	if (contextIndex > 0) {
 		if (context[contextIndex].terminator != 0) {
@@ -738,23 +987,30 @@ void JsonWriter::finishObjectOrArray() {
 		}
 		contextIndex--;
 	}
+	if (sink) {
+		// Finishing the outermost object or array completes the output
+		if (contextIndex == 0) {
+			flush();
+		}
+		return;
+	}
 	// Make sure buffer is null terminated
 	if (offset < bufferLen) {
 		buffer[offset] = 0;
 	}
-	else {
+	else
+	if (bufferLen > 0) {
 		buffer[bufferLen - 1] = 0;
 	}
 }
 
 
 void JsonWriter::insertChar(char ch) {
-	if (offset < bufferLen) {
-		buffer[offset++] = ch;
-	}
-	else {
+	if (offset >= bufferLen && (!sink || !flush())) {
 		truncated = true;
+		return;
 	}
+	buffer[offset++] = ch;
 }
 
 void JsonWriter::insertJson(const char *json) {
@@ -764,6 +1020,43 @@ void JsonWriter::insertJson(const char *json) {
 }
 
 
+void JsonWriter::insertData(const char *data, size_t dataLen) {
+	size_t spaceAvailable = bufferLen - offset;
+
+	// Streaming: fill the window completely before each flush so chunks are always full size
+	while(sink && dataLen > spaceAvailable) {
+		memcpy(&buffer[offset], data, spaceAvailable);
+		offset += spaceAvailable;
+		data += spaceAvailable;
+		dataLen -= spaceAvailable;
+		if (!flush()) {
+			return;
+		}
+		spaceAvailable = bufferLen;
+	}
+
+	if (dataLen > spaceAvailable) {
+		dataLen = spaceAvailable;
+		truncated = true;
+	}
+	memcpy(&buffer[offset], data, dataLen);
+	offset += dataLen;
+}
+
+void JsonWriter::insertUnicodeEscape(uint16_t utf16) {
+	static const char hexDigits[] = "0123456789ABCDEF";
+	char escape[6];
+
+	escape[0] = '\\';
+	escape[1] = 'u';
+	escape[2] = hexDigits[(utf16 >> 12) & 0xf];
+	escape[3] = hexDigits[(utf16 >> 8) & 0xf];
+	escape[4] = hexDigits[(utf16 >> 4) & 0xf];
+	escape[5] = hexDigits[utf16 & 0xf];
+
+	insertData(escape, sizeof(escape));
+}
+
 void JsonWriter::insertString(const char *s, bool quoted) {
 	// 0x00000000 - 0x0000007F:
 
@@ -773,56 +1066,87 @@ void JsonWriter::insertString(const char *s, bool quoted) {
 	// 0x00000800 - 0x0000FFFF:
 	// 1110xxxx 10xxxxxx 10xxxxxx
 
+	// 0x00010000 - 0x0010FFFF:
+	// 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+
 	if (quoted) {
 		insertChar('"');
 	}
 
-	for(size_t ii = 0; s[ii] && offset < bufferLen; ii++) {
+	size_t ii = 0;
+	while(s[ii] && (offset < bufferLen || sink)) {
+		// Copy the run of printable ASCII that needs no escaping in one go
+		size_t runStart = ii;
+		while((uint8_t)s[ii] >= 0x20 && (uint8_t)s[ii] < 0x80 && s[ii] != '"' && s[ii] != '\\') {
+			ii++;
+		}
+		if (ii > runStart) {
+			size_t runLen = ii - runStart;
+			if (runLen <= bufferLen - offset) {
+				// Fits: skip insertData()'s sink & truncation handling
+				memcpy(&buffer[offset], &s[runStart], runLen);
+				offset += runLen;
+			}
+			else {
+				insertData(&s[runStart], runLen);
+			}
+			continue;
+		}
+
 		if (s[ii] & 0x80) {
 			// High bit set: convert UTF-8 to JSON Unicode escape
+			uint32_t unicode = 0;
+			if (((s[ii] & 0b11111000) == 0b11110000) && ((s[ii+1] & 0b11000000) == 0b10000000) && ((s[ii+2] & 0b11000000) == 0b10000000) && ((s[ii+3] & 0b11000000) == 0b10000000)) {
+				unicode = ((uint32_t)(s[ii] & 0b111) << 18) | ((uint32_t)(s[ii+1] & 0b111111) << 12) | ((s[ii+2] & 0b111111) << 6) | (s[ii+3] & 0b111111);
+			}
+
+			if (unicode >= 0x10000 && unicode <= 0x10FFFF) {
+				// 4-byte, outside the BMP: UTF-16 surrogate pair.  (Overlong or past U+10FFFF is not valid unicode.)
+				unicode -= 0x10000;
+				insertUnicodeEscape(0xD800 | ((unicode >> 10) & 0x3ff));
+				insertUnicodeEscape(0xDC00 | (unicode & 0x3ff));
+				ii += 4;
+			}
+			else
 			if (((s[ii] & 0b11110000) == 0b11100000) && ((s[ii+1] & 0b11000000) == 0b10000000) && ((s[ii+2] & 0b11000000) == 0b10000000)) {
 				// 3-byte
 				uint16_t utf16 = ((s[ii] & 0b1111) << 12) | ((s[ii+1] & 0b111111) << 6) | (s[ii+2] & 0b111111);
-				insertsprintf("\\u%04X", utf16);
-				ii += 2; // plus one more in loop increment
+				insertUnicodeEscape(utf16);
+				ii += 3;
 			}
 			else
 			if (((s[ii] & 0b11100000) == 0b11000000) && ((s[ii+1] & 0b11000000) == 0b10000000)) {
 				// 2-byte
 				uint16_t utf16 = ((s[ii] & 0b11111) << 6) | (s[ii+1] & 0b111111);
-				insertsprintf("\\u%04X", utf16);
-				ii++; // plus one more in loop increment
+				insertUnicodeEscape(utf16);
+				ii += 2;
 			}
 			else {
 				// Not valid unicode, just pass characters through
 				insertChar(s[ii]);
+				ii++;
 			}
 		}
 		else {
 			switch(s[ii]) {
 			case '\b':
-				insertChar('\\');
-				insertChar('b');
+				insertData("\\b", 2);
 				break;
 
 			case '\f':
-				insertChar('\\');
-				insertChar('f');
+				insertData("\\f", 2);
 				break;
 
 			case '\n':
-				insertChar('\\');
-				insertChar('n');
+				insertData("\\n", 2);
 				break;
 
 			case '\r':
-				insertChar('\\');
-				insertChar('r');
+				insertData("\\r", 2);
 				break;
 
 			case '\t':
-				insertChar('\\');
-				insertChar('t');
+				insertData("\\t", 2);
 				break;
 
 			case '"':
@@ -832,9 +1156,11 @@ void JsonWriter::insertString(const char *s, bool quoted) {
 				break;
 
 			default:
-				insertChar(s[ii]);
+				// Other control characters aren't allowed raw in a JSON string
+				insertUnicodeEscape((uint8_t)s[ii]);
 				break;
 			}
+			ii++;
 		}
 	}
 	if (quoted) {
@@ -855,15 +1181,33 @@ void JsonWriter::insertsprintf(const char *fmt, ...) {
 void JsonWriter::insertvsprintf(const char *fmt, va_list ap) {
 	size_t spaceAvailable = bufferLen - offset;
 
+	va_list apCopy1, apCopy2;
+	va_copy(apCopy1, ap);
+	va_copy(apCopy2, ap);
 	size_t count = vsnprintf(&buffer[offset], spaceAvailable, fmt, ap);
-	if (count <= spaceAvailable) {
+	if (count < spaceAvailable) {
 		offset += count;
 	}
+	else
+	if (sink && count <= bufferLen) {
+		// Doesn't fit in what's left of the window. Format again to fill the window exactly (the
+		// terminator goes in the reserved byte), flush it, then format once more at the start of
+		// the window and keep only the part that didn't fit, so chunks stay full size.
+		vsnprintf(&buffer[offset], spaceAvailable + 1, fmt, apCopy1);
+		offset = bufferLen;
+		if (flush()) {
+			vsnprintf(buffer, bufferLen + 1, fmt, apCopy2);
+			memmove(buffer, &buffer[spaceAvailable], count - spaceAvailable);
+			offset = count - spaceAvailable;
+		}
+	}
 	else {
 		// Truncated, no more space left
 		offset = bufferLen;
 		truncated = true;
 	}
+	va_end(apCopy1);
+	va_end(apCopy2);
 }
 
 void JsonWriter::insertCheckSeparator() {
@@ -885,14 +1229,14 @@ void JsonWriter::insertValue(bool value) {
 }
 
 void JsonWriter::insertValue(float value) {
-	if (floatPlaces >= 0) {
-		insertsprintf("%.*f", floatPlaces, value);
-	}
-	else {
-		insertsprintf("%f", value);
-	}
+	insertValue((double) value);
 }
 void JsonWriter::insertValue(double value) {
+	// %f is 6 places
+	if (insertFixedValue(value, (floatPlaces >= 0) ? floatPlaces : 6)) {
+		return;
+	}
+
 	if (floatPlaces >= 0) {
 		insertsprintf("%.*lf", floatPlaces, value);
 	}
@@ -901,6 +1245,176 @@ void JsonWriter::insertValue(double value) {
 	}
 }
 
+void JsonWriter::insertSignedValue(long value) {
+	if (value < 0) {
+		// Negate as unsigned so LONG_MIN works
+		insertUnsignedValue(0UL - (unsigned long) value, true);
+	}
+	else {
+		insertUnsignedValue((unsigned long) value, false);
+	}
+}
+
+static const char digitPairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+// Writes value right-aligned ending at end, returns a pointer to the first digit
+static char *formatDigits(uint64_t value, char *end) {
+	// 64-bit divides are costly on 32-bit parts, so only use them while the value needs it
+	while(value > 0xffffffffULL) {
+		unsigned pair = (unsigned)(value % 100);
+		value /= 100;
+		end -= 2;
+		memcpy(end, &digitPairs[pair * 2], 2);
+	}
+
+	uint32_t value32 = (uint32_t) value;
+	while(value32 >= 100) {
+		unsigned pair = value32 % 100;
+		value32 /= 100;
+		end -= 2;
+		memcpy(end, &digitPairs[pair * 2], 2);
+	}
+	if (value32 >= 10) {
+		end -= 2;
+		memcpy(end, &digitPairs[value32 * 2], 2);
+	}
+	else {
+		*--end = (char)('0' + value32);
+	}
+	return end;
+}
+
+void JsonWriter::insertUnsignedValue(unsigned long value, bool negative) {
+	char digits[24];
+	char *end = &digits[sizeof(digits)];
+	char *start = formatDigits(value, end);
+
+	if (negative) {
+		*--start = '-';
+	}
+	insertData(start, end - start);
+}
+
+bool JsonWriter::insertFixedValue(double value, int places) {
+	static const uint32_t powersOf10[10] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+	if (places > 9) {
+		return false;
+	}
+
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	bool negative = (bits >> 63) != 0;
+	int exponent = (int)((bits >> 52) & 0x7ff);
+	uint64_t mantissa = bits & 0xfffffffffffffULL;
+
+	if (exponent == 0x7ff) {
+		// inf or nan
+		return false;
+	}
+	if (exponent == 0) {
+		// Subnormal
+		exponent = -1074;
+	}
+	else {
+		mantissa |= (1ULL << 52);
+		exponent -= 1075;
+	}
+	// value is exactly mantissa * 2^exponent
+
+	// scaled = mantissa * 10^places, up to 83 bits, as scaledHi:scaledLo
+	uint32_t scale = powersOf10[places];
+	uint64_t partHi = (mantissa >> 32) * scale;
+	uint64_t partLo = (mantissa & 0xffffffffULL) * scale;
+	uint64_t scaledLo = (partHi << 32) + partLo;
+	uint64_t scaledHi = (partHi >> 32) + ((scaledLo < partLo) ? 1 : 0);
+
+	// result = round(scaled * 2^exponent), ties to even
+	uint64_t result;
+	if (exponent >= 0) {
+		// Exact, as long as it fits
+		if (scaledHi != 0 || exponent >= 64 || (exponent > 0 && (scaledLo >> (64 - exponent)) != 0)) {
+			return false;
+		}
+		result = scaledLo << exponent;
+	}
+	else {
+		int shift = -exponent;
+		bool roundUp;
+
+		if (shift >= 128) {
+			// scaled < 2^83, so the value is less than half of the last place
+			result = 0;
+			roundUp = false;
+		}
+		else
+		if (shift >= 64) {
+			result = scaledHi >> (shift - 64);
+			// Compare remainder to half (bit shift - 1)
+			uint64_t remHi = (shift == 64) ? 0 : (scaledHi & ((1ULL << (shift - 64)) - 1));
+			uint64_t halfHi = (shift == 64) ? 0 : (1ULL << (shift - 65));
+			if (shift == 64) {
+				// half is bit 63 of lo, remainder is all of lo
+				roundUp = scaledLo > (1ULL << 63) || (scaledLo == (1ULL << 63) && (result & 1));
+			}
+			else {
+				roundUp = remHi > halfHi || (remHi == halfHi && (scaledLo != 0 || (result & 1)));
+			}
+		}
+		else {
+			if ((scaledHi >> shift) != 0) {
+				return false;
+			}
+			result = (scaledHi << (64 - shift)) | (scaledLo >> shift);
+			uint64_t rem = scaledLo & ((1ULL << shift) - 1);
+			uint64_t half = 1ULL << (shift - 1);
+			roundUp = rem > half || (rem == half && (result & 1));
+		}
+		if (roundUp) {
+			if (++result == 0) {
+				return false;
+			}
+		}
+	}
+
+	// Integer part, then places digits of fraction
+	char digits[32];
+	char *end = &digits[sizeof(digits)];
+	char *start;
+
+	if (places > 0) {
+		uint64_t intPart = result / scale;
+		uint32_t fracPart = (uint32_t)(result - intPart * scale);
+
+		for(int ii = 0; ii < places; ii++) {
+			*--end = (char)('0' + fracPart % 10);
+			fracPart /= 10;
+		}
+		*--end = '.';
+		start = formatDigits(intPart, end);
+		end = &digits[sizeof(digits)];
+	}
+	else {
+		start = formatDigits(result, end);
+	}
+	if (negative) {
+		*--start = '-';
+	}
+	insertData(start, end - start);
+	return true;
+}
+
 
 void JsonWriter::insertKeyObject(const char *key) {
 	insertCheckSeparator();
@@ -932,6 +1446,54 @@ void JsonWriter::setIsFirst(bool isFirst /* = true */) {
 }
 
 
+bool JsonWriterPrintSink::write(const char *data, size_t dataLen) {
+	return print.write((const uint8_t *)data, dataLen) == dataLen;
+}
+
+bool JsonWriterPublishSink::write(const char *data, size_t dataLen) {
+	char name[64];
+	char chunk[MAX_CHUNK_SIZE + 1];
+
+	if (dataLen > MAX_CHUNK_SIZE) {
+		// The cloud would cut it off; use a smaller window
+		return false;
+	}
+
+	refillCredit();
+	if (creditMs < PUBLISH_PERIOD_MS) {
+		uint32_t waitMs = PUBLISH_PERIOD_MS - creditMs;
+		if (waitMs > maxWaitMs) {
+			// Over the rate limit: fail now rather than have this and later chunks dropped
+			return false;
+		}
+		delay(waitMs);
+		refillCredit();
+	}
+	creditMs -= PUBLISH_PERIOD_MS;
+
+	// Bounded copy, so the chunk never depends on what follows data in the window
+	memcpy(chunk, data, dataLen);
+	chunk[dataLen] = 0;
+
+	snprintf(name, sizeof(name), "%s/%u", eventName, (unsigned) chunkIndex++);
+
+	return Particle.publish(name, chunk);
+}
+
+size_t JsonWriterPublishSink::getChunksAvailable() {
+	refillCredit();
+	return creditMs / PUBLISH_PERIOD_MS;
+}
+
+void JsonWriterPublishSink::refillCredit() {
+	const uint32_t fullMs = PUBLISH_PERIOD_MS * PUBLISH_BURST;
+	uint32_t now = millis();
+	uint32_t elapsed = now - creditAtMs;
+
+	creditMs = (elapsed >= (fullMs - creditMs)) ? fullMs : (creditMs + elapsed);
+	creditAtMs = now;
+}
+
 
 JsonModifier::JsonModifier(JsonParser &jp) : jp(jp) {
 
@@ -959,6 +1521,11 @@ bool JsonModifier::removeKeyValue(const JsonParserGeneratorRK::jsmntok_t *contai
 	const JsonParserGeneratorRK::jsmntok_t expandedKeyToken = tokenWithQuotes(keyToken);
 	const JsonParserGeneratorRK::jsmntok_t expandedValueToken = tokenWithQuotes(valueToken);
 
+	if (batchSplices) {
+		// Commas are sorted out by applySplices() once all of the edits are known
+		return addSplice(expandedKeyToken.start, expandedValueToken.end, 0, 0);
+	}
+
 	int left = findLeftComma(keyToken);
 	int right = findRightComma(valueToken);
 
@@ -1005,6 +1572,10 @@ bool JsonModifier::removeArrayIndex(const JsonParserGeneratorRK::jsmntok_t *cont
 
 	const JsonParserGeneratorRK::jsmntok_t expandedToken = tokenWithQuotes(tok);
 
+	if (batchSplices) {
+		return addSplice(expandedToken.start, expandedToken.end, 0, 0);
+	}
+
 	int left = findLeftComma(tok);
 	int right = findRightComma(tok);
 
@@ -1041,7 +1612,7 @@ bool JsonModifier::removeArrayIndex(const JsonParserGeneratorRK::jsmntok_t *cont
 	return true;
 }
 bool JsonModifier::startModify(const JsonParserGeneratorRK::jsmntok_t *token) {
-	if (start != -1) {
+	if (start != -1 || batchSplices) {
 		// Modification or insertion already in progress
 		return false;
 	}
@@ -1068,6 +1639,14 @@ bool JsonModifier::startAppend(const JsonParserGeneratorRK::jsmntok_t *arrayOrOb
 	}
 
 	start = arrayOrObjectToken->end - 1; // Before the closing ] or }
+
+	if (batchSplices) {
+		// Write the new value into scratch; the separator is added by applySplices()
+		setBuffer(batchScratch + batchScratchUsed, batchScratchLen - batchScratchUsed);
+		init();
+		return true;
+	}
+
 	origAfter = jp.getOffset() - start;
 	saveLoc = jp.getBufferLen() - origAfter;
 
@@ -1089,6 +1668,17 @@ void JsonModifier::finish() {
 	if (start == -1) {
 		return;
 	}
+	if (batchSplices) {
+		if (truncated) {
+			batchError = true;
+		}
+		else
+		if (getOffset() > 0 && addSplice(start, start, batchScratchUsed, getOffset())) {
+			batchScratchUsed += getOffset();
+		}
+		start = -1;
+		return;
+	}
 	//printf("finishing offset=%d\n", getOffset());
 
 	if (origAfter > 0) {
@@ -1099,6 +1689,201 @@ void JsonModifier::finish() {
 	start = -1;
 }
 
+bool JsonModifier::startBatch(char *scratch, size_t scratchLen, JsonModifierSplice *splices, size_t maxSplices) {
+	if (start != -1 || batchSplices) {
+		return false;
+	}
+	batchScratch = scratch;
+	batchScratchLen = scratchLen;
+	batchScratchUsed = 0;
+	batchSplices = splices;
+	batchMaxSplices = maxSplices;
+	batchNumSplices = 0;
+	batchError = false;
+	return true;
+}
+
+bool JsonModifier::finishBatch() {
+	if (!batchSplices) {
+		return false;
+	}
+
+	bool result = !batchError && applySplices();
+
+	batchSplices = 0;
+	if (result) {
+		jp.parse();
+	}
+	return result;
+}
+
+bool JsonModifier::addSplice(int start, int end, size_t dataOffset, size_t dataLen) {
+	if (batchNumSplices >= batchMaxSplices) {
+		batchError = true;
+		return false;
+	}
+
+	if (dataLen > 0 && batchScratch[dataOffset] == '"') {
+		// A key/value pair: an earlier update of the same key in the same object is superseded
+		const char *data = &batchScratch[dataOffset];
+		size_t keyLen = 1;
+		while(keyLen < dataLen && data[keyLen] != '"') {
+			keyLen += (data[keyLen] == '\\') ? 2 : 1;
+		}
+		keyLen += 2; // Closing quote and colon
+		if (keyLen <= dataLen && data[keyLen - 1] == ':') {
+			for(size_t ii = 0; ii < batchNumSplices; ii++) {
+				JsonModifierSplice *splice = &batchSplices[ii];
+				if (splice->start == start && splice->end == start && splice->dataLen >= keyLen &&
+					memcmp(&batchScratch[splice->dataOffset], data, keyLen) == 0) {
+					splice->start = -1;
+				}
+			}
+		}
+	}
+
+	JsonModifierSplice *splice = &batchSplices[batchNumSplices++];
+	splice->start = start;
+	splice->end = end;
+	splice->dataOffset = dataOffset;
+	splice->dataLen = dataLen;
+	return true;
+}
+
+static bool isJsonWhitespace(char ch) {
+	return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+bool JsonModifier::applySplices() {
+	char *buf = jp.getBuffer();
+	int docLen = (int) jp.getOffset();
+
+	// Stable sort by position, so appends to the same container stay in order
+	for(size_t ii = 1; ii < batchNumSplices; ii++) {
+		JsonModifierSplice splice = batchSplices[ii];
+		size_t jj = ii;
+		while(jj > 0 && batchSplices[jj - 1].start > splice.start) {
+			batchSplices[jj] = batchSplices[jj - 1];
+			jj--;
+		}
+		batchSplices[jj] = splice;
+	}
+
+	// Make sure the worst case (no separators removed, one added per insertion) fits before
+	// changing anything. Removals have no data; insertions always have some.
+	int covered = 0;
+	size_t finalLen = docLen;
+	for(size_t ii = 0; ii < batchNumSplices; ii++) {
+		const JsonModifierSplice *splice = &batchSplices[ii];
+		if (splice->start < 0) {
+			continue;
+		}
+		if (splice->dataLen == 0) {
+			// Removals can overlap when an element and something inside it are both removed
+			int removeStart = (splice->start > covered) ? splice->start : covered;
+			if (splice->end > removeStart) {
+				finalLen -= splice->end - removeStart;
+				covered = splice->end;
+			}
+		}
+		else
+		if (splice->start >= covered) {
+			finalLen += splice->dataLen + 1;
+		}
+	}
+	if (finalLen > jp.getBufferLen()) {
+		return false;
+	}
+
+	// Pass 1, left to right: drop the removed ranges and any separators they leave dangling,
+	// and work out where each insertion goes in the compacted document. For insertions, start
+	// becomes the offset in the compacted document and end is 1 if a comma is needed before it.
+	int readPos = 0;
+	int writePos = 0;
+	int lastInsertPos = -1;
+	for(size_t ii = 0; ii < batchNumSplices; ii++) {
+		JsonModifierSplice *splice = &batchSplices[ii];
+		if (splice->start < 0) {
+			continue;
+		}
+		if (splice->start < readPos) {
+			// Inside something that was removed
+			if (splice->dataLen > 0 || splice->end <= readPos) {
+				splice->start = -1;
+				continue;
+			}
+			splice->start = readPos;
+		}
+
+		memmove(&buf[writePos], &buf[readPos], splice->start - readPos);
+		writePos += splice->start - readPos;
+		readPos = splice->start;
+
+		int outLast = writePos - 1;
+		while(outLast >= 0 && isJsonWhitespace(buf[outLast])) {
+			outLast--;
+		}
+		char outCh = (outLast >= 0) ? buf[outLast] : 0;
+
+		if (splice->dataLen == 0) {
+			readPos = splice->end;
+
+			int inNext = readPos;
+			while(inNext < docLen && isJsonWhitespace(buf[inNext])) {
+				inNext++;
+			}
+			char inCh = (inNext < docLen) ? buf[inNext] : 0;
+
+			if (inCh == ',' && (outCh == ',' || outCh == '{' || outCh == '[')) {
+				// Removed the first or a middle element: drop the comma after it
+				readPos = inNext + 1;
+			}
+			else
+			if ((inCh == '}' || inCh == ']') && outCh == ',') {
+				// Removed the last element: drop the comma before it
+				writePos = outLast;
+			}
+		}
+		else {
+			bool needComma = (writePos == lastInsertPos) || !(outCh == '{' || outCh == '[' || outCh == ',');
+			lastInsertPos = writePos;
+			splice->start = writePos;
+			splice->end = needComma ? 1 : 0;
+		}
+	}
+	memmove(&buf[writePos], &buf[readPos], docLen - readPos);
+	int srcEnd = writePos + (docLen - readPos);
+
+	// Pass 2, right to left: open up a gap at each insertion and copy in its data
+	int dstEnd = srcEnd;
+	for(size_t ii = 0; ii < batchNumSplices; ii++) {
+		const JsonModifierSplice *splice = &batchSplices[ii];
+		if (splice->start >= 0 && splice->dataLen > 0) {
+			dstEnd += splice->dataLen + splice->end;
+		}
+	}
+	jp.setOffset(dstEnd);
+
+	for(size_t ii = batchNumSplices; ii-- > 0; ) {
+		const JsonModifierSplice *splice = &batchSplices[ii];
+		if (splice->start < 0 || splice->dataLen == 0) {
+			continue;
+		}
+		int tailLen = srcEnd - splice->start;
+		dstEnd -= tailLen;
+		memmove(&buf[dstEnd], &buf[splice->start], tailLen);
+		srcEnd = splice->start;
+
+		dstEnd -= splice->dataLen;
+		memcpy(&buf[dstEnd], &batchScratch[splice->dataOffset], splice->dataLen);
+		if (splice->end) {
+			buf[--dstEnd] = ',';
+		}
+	}
+
+	return true;
+}
+
 
 JsonParserGeneratorRK::jsmntok_t JsonModifier::tokenWithQuotes(const JsonParserGeneratorRK::jsmntok_t *tok) const {
 	JsonParserGeneratorRK::jsmntok_t expandedToken = *tok;
@@ -1146,6 +1931,487 @@ int JsonModifier::findRightComma(const JsonParserGeneratorRK::jsmntok_t *tok) co
 }
 
 
+JsonStreamParser::JsonStreamParser(char *pathBuffer, size_t pathBufferLen, char *valueBuffer, size_t valueBufferLen, JsonStreamChunkSlot *slots, char *slotData, size_t numSlots, size_t chunkSize) :
+	pathBuffer(pathBuffer), pathBufferLen(pathBufferLen), valueBuffer(valueBuffer), valueBufferLen(valueBufferLen),
+	slots(slots), slotData(slotData), numSlots(numSlots), chunkSize(chunkSize), numSubscriptions(0) {
+	reset();
+}
+
+JsonStreamParser::~JsonStreamParser() {
+
+}
+
+bool JsonStreamParser::subscribe(const char *path, Callback callback) {
+	if (numSubscriptions >= MAX_SUBSCRIPTIONS) {
+		return false;
+	}
+	subscriptions[numSubscriptions].path = path;
+	subscriptions[numSubscriptions].callback = callback;
+	numSubscriptions++;
+	return true;
+}
+
+void JsonStreamParser::reset() {
+	pathLen = 0;
+	pathBuffer[0] = 0;
+	pathOverflow = false;
+	valueLen = 0;
+	valueOverflow = false;
+	depth = 0;
+	state = STATE_VALUE;
+	stringIsKey = false;
+	matchMask = 0;
+	highSurrogate = 0;
+	truncated = false;
+
+	nextChunk = 0;
+	for(size_t ii = 0; ii < numSlots; ii++) {
+		slots[ii].chunkIndex = -1;
+	}
+}
+
+bool JsonStreamParser::addData(const char *data, size_t dataLen) {
+	for(size_t ii = 0; ii < dataLen && state != STATE_ERROR; ii++) {
+		processChar(data[ii]);
+	}
+	return state != STATE_ERROR;
+}
+
+bool JsonStreamParser::addChunkedData(const char *event, const char *data) {
+	// Multipart hook-response events end in /0, /1, ...
+	int chunkIndex = 0;
+	const char *slashOffset = strrchr(event, '/');
+	if (slashOffset) {
+		chunkIndex = atoi(slashOffset + 1);
+	}
+
+	size_t len = strlen(data);
+
+	if (chunkIndex < nextChunk) {
+		// Already parsed this one
+		return !hasError();
+	}
+
+	if (chunkIndex > nextChunk) {
+		// Early: hold it until the chunks before it have arrived
+		JsonStreamChunkSlot *freeSlot = 0;
+		for(size_t ii = 0; ii < numSlots; ii++) {
+			if (slots[ii].chunkIndex == chunkIndex) {
+				// Duplicate
+				return !hasError();
+			}
+			if (slots[ii].chunkIndex < 0 && !freeSlot) {
+				freeSlot = &slots[ii];
+			}
+		}
+		if (!freeSlot || len > chunkSize) {
+			state = STATE_ERROR;
+			return false;
+		}
+		freeSlot->chunkIndex = chunkIndex;
+		freeSlot->dataLen = len;
+		memcpy(&slotData[(freeSlot - slots) * chunkSize], data, len);
+		return !hasError();
+	}
+
+	addData(data, len);
+	nextChunk++;
+
+	// Parse any held chunks that are now in order
+	for(size_t ii = 0; ii < numSlots; ) {
+		if (slots[ii].chunkIndex == nextChunk) {
+			addData(&slotData[ii * chunkSize], slots[ii].dataLen);
+			slots[ii].chunkIndex = -1;
+			nextChunk++;
+			ii = 0;
+		}
+		else {
+			ii++;
+		}
+	}
+	return !hasError();
+}
+
+void JsonStreamParser::processChar(char ch) {
+	bool isWhitespace = (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n');
+
+	switch(state) {
+	case STATE_VALUE:
+		if (!isWhitespace) {
+			startValue(ch);
+		}
+		break;
+
+	case STATE_ARRAY_FIRST:
+		if (ch == ']') {
+			depth--;
+			pathLen = levels[depth].pathLen;
+			pathBuffer[pathLen] = 0;
+			pathOverflow = levels[depth].overflow;
+			finishValue();
+		}
+		else
+		if (!isWhitespace) {
+			startValue(ch);
+		}
+		break;
+
+	case STATE_OBJECT_FIRST:
+	case STATE_KEY:
+		if (ch == '"') {
+			// The key replaces the last path segment
+			pathLen = levels[depth - 1].pathLen;
+			pathOverflow = levels[depth - 1].overflow;
+			stringIsKey = true;
+			if (pathLen > 0) {
+				appendChar('/');
+			}
+			state = STATE_STRING;
+		}
+		else
+		if (ch == '}' && state == STATE_OBJECT_FIRST) {
+			depth--;
+			pathLen = levels[depth].pathLen;
+			pathBuffer[pathLen] = 0;
+			pathOverflow = levels[depth].overflow;
+			finishValue();
+		}
+		else
+		if (!isWhitespace) {
+			state = STATE_ERROR;
+		}
+		break;
+
+	case STATE_COLON:
+		if (ch == ':') {
+			state = STATE_VALUE;
+		}
+		else
+		if (!isWhitespace) {
+			state = STATE_ERROR;
+		}
+		break;
+
+	case STATE_STRING:
+		if (ch != '\\') {
+			// Only another \u escape can complete a pending high surrogate
+			flushSurrogate();
+		}
+		if (ch == '"') {
+			if (stringIsKey) {
+				pathBuffer[pathLen] = 0;
+				stringIsKey = false;
+				state = STATE_COLON;
+			}
+			else {
+				callSubscribers(JsonParserGeneratorRK::JSMN_STRING);
+				finishValue();
+			}
+		}
+		else
+		if (ch == '\\') {
+			state = STATE_STRING_ESCAPE;
+		}
+		else {
+			appendChar(ch);
+		}
+		break;
+
+	case STATE_STRING_ESCAPE:
+		state = STATE_STRING;
+		if (ch != 'u') {
+			flushSurrogate();
+		}
+		switch(ch) {
+		case 'b':
+			appendChar('\b');
+			break;
+		case 'f':
+			appendChar('\f');
+			break;
+		case 'n':
+			appendChar('\n');
+			break;
+		case 'r':
+			appendChar('\r');
+			break;
+		case 't':
+			appendChar('\t');
+			break;
+		case '"':
+		case '\\':
+		case '/':
+			appendChar(ch);
+			break;
+		case 'u':
+			unicodeDigits = 0;
+			unicodeValue = 0;
+			state = STATE_STRING_UNICODE;
+			break;
+		default:
+			state = STATE_ERROR;
+			break;
+		}
+		break;
+
+	case STATE_STRING_UNICODE:
+		if (ch >= '0' && ch <= '9') {
+			unicodeValue = (unicodeValue << 4) | (ch - '0');
+		}
+		else
+		if ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f') {
+			unicodeValue = (unicodeValue << 4) | ((ch | 0x20) - 'a' + 10);
+		}
+		else {
+			state = STATE_ERROR;
+			break;
+		}
+		if (++unicodeDigits == 4) {
+			state = STATE_STRING;
+			if (unicodeValue >= 0xD800 && unicodeValue <= 0xDBFF) {
+				// First half of a surrogate pair, wait for the second
+				flushSurrogate();
+				highSurrogate = unicodeValue;
+			}
+			else
+			if (unicodeValue >= 0xDC00 && unicodeValue <= 0xDFFF) {
+				if (highSurrogate) {
+					appendUnicode(0x10000 + (((uint32_t)(highSurrogate - 0xD800) << 10) | (unicodeValue - 0xDC00)));
+					highSurrogate = 0;
+				}
+				else {
+					// Lone second half
+					appendUnicode(0xFFFD);
+				}
+			}
+			else {
+				flushSurrogate();
+				appendUnicode(unicodeValue);
+			}
+		}
+		break;
+
+	case STATE_PRIMITIVE:
+		if (isWhitespace || ch == ',' || ch == '}' || ch == ']') {
+			callSubscribers(JsonParserGeneratorRK::JSMN_PRIMITIVE);
+			finishValue();
+
+			// The delimiter belongs to the enclosing object or array
+			processChar(ch);
+		}
+		else {
+			appendChar(ch);
+		}
+		break;
+
+	case STATE_AFTER_VALUE:
+		if (isWhitespace) {
+			break;
+		}
+		if (ch == ',') {
+			if (levels[depth - 1].isArray) {
+				levels[depth - 1].index++;
+				setIndexSegment();
+				state = STATE_VALUE;
+			}
+			else {
+				state = STATE_KEY;
+			}
+		}
+		else
+		if (ch == (levels[depth - 1].isArray ? ']' : '}')) {
+			depth--;
+			pathLen = levels[depth].pathLen;
+			pathBuffer[pathLen] = 0;
+			pathOverflow = levels[depth].overflow;
+			finishValue();
+		}
+		else {
+			state = STATE_ERROR;
+		}
+		break;
+
+	case STATE_DONE:
+		if (!isWhitespace) {
+			state = STATE_ERROR;
+		}
+		break;
+
+	case STATE_ERROR:
+		break;
+	}
+}
+
+void JsonStreamParser::startValue(char ch) {
+	// The path is known at the start of the value, so only values that are subscribed to are copied
+	matchMask = 0;
+	if (!pathOverflow) {
+		for(size_t ii = 0; ii < numSubscriptions; ii++) {
+			if (pathMatches(subscriptions[ii].path, pathBuffer)) {
+				matchMask |= (1 << ii);
+			}
+		}
+	}
+	valueLen = 0;
+	valueOverflow = false;
+	highSurrogate = 0;
+
+	if (depth == 0 && ch != '{' && ch != '[') {
+		// A primitive at the top level has no delimiter to end it
+		state = STATE_ERROR;
+		return;
+	}
+
+	if (ch == '{' || ch == '[') {
+		if (depth >= MAX_DEPTH) {
+			state = STATE_ERROR;
+			return;
+		}
+		levels[depth].pathLen = (uint16_t) pathLen;
+		levels[depth].index = 0;
+		levels[depth].isArray = (ch == '[');
+		levels[depth].overflow = pathOverflow;
+		depth++;
+
+		if (ch == '[') {
+			setIndexSegment();
+			state = STATE_ARRAY_FIRST;
+		}
+		else {
+			state = STATE_OBJECT_FIRST;
+		}
+	}
+	else
+	if (ch == '"') {
+		state = STATE_STRING;
+	}
+	else
+	if (ch == '-' || (ch >= '0' && ch <= '9') || ch == 't' || ch == 'f' || ch == 'n') {
+		appendChar(ch);
+		state = STATE_PRIMITIVE;
+	}
+	else {
+		state = STATE_ERROR;
+	}
+}
+
+void JsonStreamParser::finishValue() {
+	state = (depth == 0) ? STATE_DONE : STATE_AFTER_VALUE;
+}
+
+void JsonStreamParser::callSubscribers(JsonParserGeneratorRK::jsmntype_t type) {
+	if (!matchMask) {
+		return;
+	}
+	if (valueOverflow) {
+		truncated = true;
+		return;
+	}
+	valueBuffer[valueLen] = 0;
+	for(size_t ii = 0; ii < numSubscriptions; ii++) {
+		if (matchMask & (1 << ii)) {
+			subscriptions[ii].callback(pathBuffer, valueBuffer, type);
+		}
+	}
+}
+
+void JsonStreamParser::setIndexSegment() {
+	char index[8];
+	snprintf(index, sizeof(index), (levels[depth - 1].pathLen > 0) ? "/%u" : "%u", levels[depth - 1].index);
+
+	pathLen = levels[depth - 1].pathLen;
+	pathOverflow = levels[depth - 1].overflow;
+
+	size_t indexLen = strlen(index);
+	if (pathLen + indexLen < pathBufferLen) {
+		memcpy(&pathBuffer[pathLen], index, indexLen);
+		pathLen += indexLen;
+	}
+	else {
+		pathOverflow = true;
+	}
+	pathBuffer[pathLen] = 0;
+}
+
+void JsonStreamParser::appendChar(char ch) {
+	if (stringIsKey) {
+		if (pathLen < pathBufferLen - 1) {
+			pathBuffer[pathLen++] = ch;
+		}
+		else {
+			pathOverflow = true;
+		}
+	}
+	else
+	if (matchMask) {
+		if (valueLen < valueBufferLen - 1) {
+			valueBuffer[valueLen++] = ch;
+		}
+		else {
+			valueOverflow = true;
+		}
+	}
+}
+
+void JsonStreamParser::appendUnicode(uint32_t unicode) {
+	if (unicode < 0x80) {
+		appendChar((char) unicode);
+	}
+	else
+	if (unicode < 0x800) {
+		appendChar((char)(0b11000000 | (unicode >> 6)));
+		appendChar((char)(0b10000000 | (unicode & 0b111111)));
+	}
+	else
+	if (unicode < 0x10000) {
+		appendChar((char)(0b11100000 | (unicode >> 12)));
+		appendChar((char)(0b10000000 | ((unicode >> 6) & 0b111111)));
+		appendChar((char)(0b10000000 | (unicode & 0b111111)));
+	}
+	else {
+		appendChar((char)(0b11110000 | (unicode >> 18)));
+		appendChar((char)(0b10000000 | ((unicode >> 12) & 0b111111)));
+		appendChar((char)(0b10000000 | ((unicode >> 6) & 0b111111)));
+		appendChar((char)(0b10000000 | (unicode & 0b111111)));
+	}
+}
+
+void JsonStreamParser::flushSurrogate() {
+	if (highSurrogate) {
+		// First half of a surrogate pair that was never completed
+		appendUnicode(0xFFFD);
+		highSurrogate = 0;
+	}
+}
+
+// [static]
+bool JsonStreamParser::pathMatches(const char *pattern, const char *path) {
+	while(true) {
+		if (pattern[0] == '*' && (pattern[1] == '/' || pattern[1] == 0)) {
+			// Wildcard segment
+			pattern++;
+			while(*path && *path != '/') {
+				path++;
+			}
+		}
+		else {
+			while(*pattern && *pattern != '/' && *pattern == *path) {
+				pattern++;
+				path++;
+			}
+		}
+		// Both must be at the end of a segment, and the same one of / or the end
+		if (*pattern != *path || (*pattern && *pattern != '/')) {
+			return false;
+		}
+		if (!*pattern) {
+			return true;
+		}
+		pattern++;
+		path++;
+	}
+}
+
 
 // begin jsmn.cpp
 // https://github.com/zserge/jsmn
@@ -4,6 +4,7 @@
 
 #include "Particle.h"
 
+#include <functional>
 #include <vector>
 
 // You can mostly ignore the stuff in this namespace block. It's part of the jsmn library
@@ -272,6 +273,14 @@ protected:
 
 class JsonReference;
 
+/**
+ * @brief One slot of the optional key index (see JsonParser::enableKeyIndex())
+ */
+typedef struct {
+	uint16_t container;	//!< Token index of the object that owns the key
+	uint16_t key;		//!< Token index of the key, 0 = empty slot
+} JsonParserKeySlot;
+
 
 /**
  * @brief API to the JsonParser
@@ -317,6 +326,10 @@ public:
 	 * When parsing data split into multiple chunks as a webhook response you can call addString()
 	 * in your webhook subscription handler and call parse after each chunk. Only on the last chunk
 	 * will parse return true, and you'll know the entire reponse has been received.
+	 *
+	 * With static buffers (JsonParserStatic) the data is tokenized in a single pass into the fixed
+	 * token pool and parse fails if the pool is too small; it never falls back to malloc. Otherwise
+	 * the token storage grows geometrically as needed, still in a single pass over the data.
 	 */
 	bool parse();
 
@@ -553,6 +566,37 @@ public:
 	 */
 	bool getValueTokenByKey(const JsonParserGeneratorRK::jsmntok_t *container, const char *key, const JsonParserGeneratorRK::jsmntok_t *&value) const;
 
+	/**
+	 * @brief Enables a hashed index of object keys for getValueTokenByKey() (and everything built on it,
+	 * including JsonReference::key()).
+	 *
+	 * @param slots Optional static storage for the index. If NULL the index is allocated with malloc.
+	 *
+	 * @param numSlots Number of slots in slots. Must be a power of 2 and at least twice the total number of
+	 * keys in the document, otherwise lookups quietly fall back to a linear scan (until the next parse()).
+	 *
+	 * The index covers every object in the document and is built lazily on the first key lookup after
+	 * each parse(), so repeated lookups into wide or deeply nested objects are close to O(1) instead
+	 * of rescanning the object each time. A document with backslash escapes in any key is not
+	 * indexed and uses the linear scan, since the raw key bytes don't match the decoded key.
+	 */
+	void enableKeyIndex(JsonParserKeySlot *slots = 0, size_t numSlots = 0);
+
+	/**
+	 * @brief Enables a post-parse pass that records the next sibling of every token.
+	 *
+	 * @param nextSibling Optional static storage, one entry per token. If NULL it's allocated with malloc.
+	 *
+	 * @param numEntries Number of entries in nextSibling. If the document has more tokens than this,
+	 * the index is not built and skipObject() walks the tokens as usual.
+	 *
+	 * skipObject() normally walks every token of a nested object or array to step over it. With the
+	 * index it's a single jump, so getValueTokenByIndex(), getValueTokenByColRow(), getArraySize()
+	 * and getTokenByIndex() hop element to element regardless of how large each element is. Takes
+	 * effect on the next parse().
+	 */
+	void enableSiblingIndex(uint16_t *nextSibling = 0, size_t numEntries = 0);
+
 	/**
 	 * @brief Given an array token in container, gets the token value with the specified index.
 	 *
@@ -773,6 +817,52 @@ protected:
 	size_t	maxTokens; //!< Number of tokens that can be stored in tokens.
 	JsonParserGeneratorRK::jsmn_parser parser;//!< The JSMN parser object.
 
+	mutable JsonParserKeySlot *keyIndex; //!< Hashed key index, see enableKeyIndex()
+	mutable size_t keyIndexSlots; //!< Number of slots in keyIndex (power of 2)
+	bool keyIndexEnabled; //!< enableKeyIndex() has been called
+	bool keyIndexStaticSlots; //!< keyIndex was passed in and must not be freed or resized
+	mutable bool keyIndexBuilt; //!< keyIndex matches the current tokens
+	mutable bool keyIndexPartial; //!< Some keys were not indexed (escaped), so lookups must use a scan
+	mutable bool keyIndexFailed; //!< keyIndex could not be built for the current tokens, so lookups must use a scan
+
+	uint16_t *siblingIndex; //!< Token index of the next sibling of each token, see enableSiblingIndex()
+	size_t siblingIndexEntries; //!< Number of entries in siblingIndex
+	bool siblingIndexEnabled; //!< enableSiblingIndex() has been called
+	bool siblingIndexStatic; //!< siblingIndex was passed in and must not be freed or resized
+	bool siblingIndexBuilt; //!< siblingIndex matches the current tokens
+
+	/**
+	 * @brief Builds siblingIndex from the current tokens; called at the end of a successful parse()
+	 */
+	bool buildSiblingIndex();
+
+	/**
+	 * @brief Builds keyIndex from the current tokens
+	 */
+	bool buildKeyIndex() const;
+
+	/**
+	 * @brief Adds the keys of the object or array at tokenIndex (recursively) to keyIndex
+	 *
+	 * @return The token index after the whole value
+	 */
+	size_t indexKeys(size_t tokenIndex) const;
+
+	/**
+	 * @brief Compares a key token to a c-string, decoding escapes only if the key has any
+	 */
+	bool keyEquals(const JsonParserGeneratorRK::jsmntok_t *key, const char *name, size_t nameLen) const;
+
+	/**
+	 * @brief FNV-1a hash of a key, seeded with the token index of its object
+	 */
+	static uint32_t keyHash(size_t container, const char *name, size_t nameLen);
+
+	/**
+	 * @brief Grows (or initially allocates) the token storage to maxTokens, keeping existing tokens
+	 */
+	bool growTokens(size_t maxTokens);
+
 	friend class JsonModifier; // To access the tokens for modifying a JSON object in place
 };
 
@@ -924,6 +1014,30 @@ typedef struct {
 	char terminator;	//!< The character that will terminate the object or array when ended
 } JsonWriterContext;
 
+/**
+ * @brief Destination for a streaming JsonWriter
+ *
+ * When a sink is set with JsonWriter::setSink() the writer's buffer becomes a window. Each time the
+ * window fills it's handed to write() and reused, so arbitrarily large JSON can be generated in
+ * bounded RAM. Every chunk except the last is exactly the window size.
+ */
+class JsonWriterSink {
+public:
+	virtual ~JsonWriterSink() {};
+
+	/**
+	 * @brief Called with each full window, and with the partial window on flush()
+	 *
+	 * @param data Pointer to the data. It is null-terminated (data[dataLen] == 0).
+	 *
+	 * @param dataLen Number of bytes of data, not including the null terminator.
+	 *
+	 * @return true on success. Return false if the data could not be written; the writer then sets
+	 * its truncated flag and discards the rest of the output.
+	 */
+	virtual bool write(const char *data, size_t dataLen) = 0;
+};
+
 /**
  * @brief Class for building a JSON string
  */
@@ -967,6 +1081,37 @@ public:
 	 */
 	void init();
 
+	/**
+	 * @brief Stream output to a sink instead of accumulating it in the buffer
+	 *
+	 * @param sink The sink to write to, or NULL to go back to buffered mode. The sink is not copied
+	 * and must remain valid while the writer is used.
+	 *
+	 * In streaming mode the buffer is a window: when it fills, it's passed to the sink and reused.
+	 * The sink is passed a null-terminated chunk, so the buffer must have one byte past bufferLen
+	 * for the terminator. JsonWriterStreaming takes care of this for you.
+	 *
+	 * The remaining partial window is flushed automatically when the outermost object or array is
+	 * finished. Call flush() yourself if you write something else at the top level.
+	 *
+	 * The output of a single insertsprintf() can't be larger than the window, so keep the window at
+	 * least 64 bytes.
+	 */
+	void setSink(JsonWriterSink *sink) { this->sink = sink; }
+
+	/**
+	 * @brief Returns the current sink, or NULL if not streaming
+	 */
+	JsonWriterSink *getSink() const { return sink; }
+
+	/**
+	 * @brief Pass any data in the window to the sink and empty the window
+	 *
+	 * @return true on success, or if not streaming. false if the sink failed, in which case the
+	 * truncated flag is also set.
+	 */
+	bool flush();
+
 	/**
 	 * @brief Start a new JSON object. Make sure you finish it with finishObjectOrArray()
 	 */
@@ -996,7 +1141,7 @@ public:
 	 * You would normally use insertKeyValue() or insertArrayValue() instead of calling this directly
 	 * as those functions take care of inserting the separators between items.
 	 */
-	void insertValue(int value) { insertsprintf("%d", value); }
+	void insertValue(int value) { insertSignedValue(value); }
 
 	/**
 	 * @brief Inserts an unsigned integer value.
@@ -1004,7 +1149,7 @@ public:
 	 * You would normally use insertKeyValue() or insertArrayValue() instead of calling this directly
 	 * as those functions take care of inserting the separators between items.
 	 */
-	void insertValue(unsigned int value) { insertsprintf("%u", value); }
+	void insertValue(unsigned int value) { insertUnsignedValue(value, false); }
 
 	/**
 	 * @brief Inserts a long integer value.
@@ -1012,7 +1157,7 @@ public:
 	 * You would normally use insertKeyValue() or insertArrayValue() instead of calling this directly
 	 * as those functions take care of inserting the separators between items.
 	 */
-	void insertValue(long value) { insertsprintf("%ld", value); }
+	void insertValue(long value) { insertSignedValue(value); }
 
 	/**
 	 * @brief Inserts an unsigned long integer value.
@@ -1020,7 +1165,7 @@ public:
 	 * You would normally use insertKeyValue() or insertArrayValue() instead of calling this directly
 	 * as those functions take care of inserting the separators between items.
 	 */
-	void insertValue(unsigned long value) { insertsprintf("%lu", value); }
+	void insertValue(unsigned long value) { insertUnsignedValue(value, false); }
 
 	/**
 	 * @brief Inserts a floating point value.
@@ -1199,6 +1344,41 @@ public:
 	 */
 	void insertChar(char ch);
 
+	/**
+	 * @brief Used internally to insert a run of bytes as-is
+	 *
+	 * Copies as much as fits and sets the truncated flag if it doesn't all fit. When streaming, the
+	 * window is flushed to the sink as it fills instead.
+	 */
+	void insertData(const char *data, size_t dataLen);
+
+	/**
+	 * @brief Used internally to insert a \\uXXXX escape for a UTF-16 code unit
+	 */
+	void insertUnicodeEscape(uint16_t utf16);
+
+	/**
+	 * @brief Used internally to insert a signed integer without printf. Same output as %ld.
+	 */
+	void insertSignedValue(long value);
+
+	/**
+	 * @brief Used internally to insert an unsigned integer without printf, two digits at a time from
+	 * a digit-pair table. Same output as %lu, with a leading - if negative is set.
+	 */
+	void insertUnsignedValue(unsigned long value, bool negative);
+
+	/**
+	 * @brief Used internally to insert a double with a fixed number of decimal places without printf.
+	 *
+	 * @return true if inserted, false if the value is outside what can be formatted exactly here (not
+	 * finite, more than 9 places, or integer part 2^64 or more) and the caller must use printf.
+	 *
+	 * Works from the exact binary value of the double, not value * 10^places in floating point, so
+	 * it rounds the same way as %.*f (to nearest, ties to even) and the output is byte-identical.
+	 */
+	bool insertFixedValue(double value, int places);
+
 	/**
 	 * @brief Used to insert a string of existing JSON (typically a preformatted object or array) into a writer
 	 *
@@ -1210,6 +1390,9 @@ public:
 	 * @brief Used internally to insert a string, quoted or not.
 	 *
 	 * Used internally. You should use insertKeyValue() or insertArrayValue() with a string instead.
+	 *
+	 * Runs of bytes that need no escaping are copied in bulk. UTF-8 is converted to \\uXXXX escapes,
+	 * with characters outside the Basic Multilingual Plane (4-byte UTF-8) written as a surrogate pair.
 	 */
 	void insertString(const char *s, bool quoted = false);
 
@@ -1251,6 +1434,7 @@ protected:
 	JsonWriterContext context[MAX_NESTED_CONTEXT]; 	//!< Structure for managing nested objects
 	bool truncated; 								//!< true if data was added that didn't fit and was truncated
 	int floatPlaces; 								//!< default number of places to display for floating point numbers (default is -1, the default for sprintf)
+	JsonWriterSink *sink;							//!< When not NULL, the buffer is a window that's flushed to this sink
 };
 
 
@@ -1280,6 +1464,127 @@ private:
 	char staticBuffer[BUFFER_SIZE]; //!< static buffer to write to
 };
 
+/**
+ * @brief Creates a JsonWriter that streams to a sink through a statically allocated window.
+ *
+ * Example:
+ *
+ * ```
+ * JsonWriterPublishSink sink("RCCM_Report");
+ * JsonWriterStreaming<512> jw(sink);
+ * {
+ *     JsonWriterAutoObject obj(&jw);
+ *     // insertKeyValue() as usual; the output is published in 512 byte chunks
+ * }
+ * ```
+ *
+ * The output size is limited only by the sink, and isTruncated() is only set if the sink fails
+ * or a single insertsprintf() doesn't fit in the window.
+ *
+ * @param WINDOW_SIZE The size of each chunk passed to the sink. One more byte is reserved for the
+ * null terminator.
+ */
+template <size_t WINDOW_SIZE>
+class JsonWriterStreaming : public JsonWriter {
+public:
+	explicit JsonWriterStreaming(JsonWriterSink &sink) : JsonWriter(staticBuffer, WINDOW_SIZE) {
+		setSink(&sink);
+	};
+
+private:
+	char staticBuffer[WINDOW_SIZE + 1]; //!< window, plus the null terminator passed to the sink
+};
+
+/**
+ * @brief JsonWriterSink that writes to a Print, such as Serial, Serial1 or a file on a log device
+ */
+class JsonWriterPrintSink : public JsonWriterSink {
+public:
+	/**
+	 * @brief Construct a sink that writes to print
+	 *
+	 * @param print The Print object to write to. It is not copied and must remain valid.
+	 */
+	explicit JsonWriterPrintSink(Print &print) : print(print) {};
+
+	virtual bool write(const char *data, size_t dataLen);
+
+protected:
+	Print &print; //!< Where the data goes
+};
+
+/**
+ * @brief JsonWriterSink that publishes each chunk as an event
+ *
+ * The events are named eventName/0, eventName/1, ... the same way multipart hook-response events
+ * are, so a device subscribed to eventName can put the report back together with
+ * JsonBuffer::addChunkedData() (use a 512 byte window, the addChunkedData default chunk size).
+ *
+ * Each chunk is a separate publish and counts against the publish rate limit (a burst of 4, then
+ * 1 per second). The sink keeps its own count of that budget: by default a chunk that would go
+ * over it is not published and write() fails, so the writer sets its truncated flag and stops
+ * early instead of the cloud silently dropping later parts. Pass maxWaitMs to have the sink pace
+ * itself with delay() instead. Publishes made elsewhere share the same device-wide limit but are
+ * not counted here.
+ */
+class JsonWriterPublishSink : public JsonWriterSink {
+public:
+	static const size_t MAX_CHUNK_SIZE = 622;			//!< Largest event data Particle.publish() accepts
+	static const uint32_t PUBLISH_PERIOD_MS = 1000;	//!< Sustained publish rate
+	static const uint32_t PUBLISH_BURST = 4;			//!< Publishes allowed back to back
+
+	/**
+	 * @brief Construct a sink that publishes chunks
+	 *
+	 * @param eventName The event name prefix. It is not copied and must remain valid. Maximum of 56
+	 * characters so the /N suffix fits.
+	 *
+	 * @param maxWaitMs Longest the sink will block in delay() waiting for the rate limit before a
+	 * chunk. 0 (the default) never waits; up to PUBLISH_BURST chunks go out back to back and the
+	 * next one fails. PUBLISH_PERIOD_MS or more paces any number of chunks at 1 per second.
+	 */
+	explicit JsonWriterPublishSink(const char *eventName, uint32_t maxWaitMs = 0) : eventName(eventName), chunkIndex(0), maxWaitMs(maxWaitMs), creditMs(PUBLISH_PERIOD_MS * PUBLISH_BURST), creditAtMs(0) {};
+
+	/**
+	 * @brief Publishes data as the next chunk
+	 *
+	 * Fails without publishing if dataLen is over MAX_CHUNK_SIZE or the chunk would exceed the
+	 * rate limit (see maxWaitMs). data does not need to be null-terminated.
+	 */
+	virtual bool write(const char *data, size_t dataLen);
+
+	/**
+	 * @brief Start numbering chunks from /0 again. Call before writing another report.
+	 *
+	 * The rate limit budget is not reset; it refills with time.
+	 */
+	void reset() { chunkIndex = 0; }
+
+	/**
+	 * @brief Returns the number of chunks published since construction or reset()
+	 */
+	size_t getChunkCount() const { return chunkIndex; }
+
+	/**
+	 * @brief Returns the number of chunks that can be published right now without waiting
+	 *
+	 * Check before starting a report to fail before anything is published.
+	 */
+	size_t getChunksAvailable();
+
+protected:
+	/**
+	 * @brief Brings creditMs up to date
+	 */
+	void refillCredit();
+
+	const char *eventName;	//!< Event name prefix
+	size_t chunkIndex;		//!< Number of the next chunk
+	uint32_t maxWaitMs;		//!< Longest write() blocks for the rate limit
+	uint32_t creditMs;		//!< Rate limit budget; each publish costs PUBLISH_PERIOD_MS, refilled 1 ms per ms
+	uint32_t creditAtMs;	//!< millis() when creditMs was last refilled
+};
+
 /**
  * @brief Class for creating a JSON object with JsonWriter
  *
@@ -1338,6 +1643,19 @@ protected:
 	JsonWriter *jw; //!< JsonWriter to write to
 };
 
+/**
+ * @brief One recorded edit in a JsonModifier batch. Used internally.
+ *
+ * A removal has end > start and no data. An insertion has start == end and dataLen bytes of
+ * data in the scratch buffer.
+ */
+typedef struct {
+	int start;			//!< Offset in the document the edit starts at, or -1 if it was superseded
+	int end;			//!< Offset in the document the edit ends at (exclusive)
+	size_t dataOffset;	//!< Offset of the inserted data in the scratch buffer
+	size_t dataLen;		//!< Length of the inserted data in bytes
+} JsonModifierSplice;
+
 /**
  * @brief Class for modifying a JSON object in place, without needing to make a copy of it
  *
@@ -1405,6 +1723,7 @@ public:
 	 *
 	 * Note: This method call jp.parse() so any jsmntok_t may be changed by this method. If you've
 	 * fetched one, such as by using getValueTokenByKey() be sure to fetch it again to be safe.
+	 * During a batch the removal is only recorded; see startBatch().
 	 */
 	bool removeKeyValue(const JsonParserGeneratorRK::jsmntok_t *container, const char *key);
 
@@ -1413,6 +1732,7 @@ public:
 	 *
 	 * Note: This method call jp.parse() so any jsmntok_t may be changed by this method. If you've
 	 * fetched one, such as by using getValueTokenByKey() be sure to fetch it again to be safe.
+	 * During a batch the removal is only recorded; see startBatch().
 	 */
 	bool removeArrayIndex(const JsonParserGeneratorRK::jsmntok_t *container, size_t index);
 
@@ -1454,6 +1774,47 @@ public:
 	 */
 	void finish();
 
+	/**
+	 * @brief Start recording edits so they can be applied all at once
+	 *
+	 * @param scratch Buffer to hold the data for inserted or updated values until finishBatch()
+	 *
+	 * @param scratchLen Length of scratch in bytes
+	 *
+	 * @param splices Array to hold the recorded edits
+	 *
+	 * @param maxSplices Number of entries in splices. Each removal or append takes one, and
+	 * insertOrUpdateKeyValue() takes two.
+	 *
+	 * Normally every edit moves the rest of the document and calls jp.parse(), so k edits cost
+	 * O(n·k). Between startBatch() and finishBatch(), insertOrUpdateKeyValue(), appendArrayValue(),
+	 * removeKeyValue() and removeArrayIndex() only record what to do. The document, and so any
+	 * jsmntok_t you have, is not changed until finishBatch(), which makes one pass over the document
+	 * and parses it once.
+	 *
+	 * All edits in a batch refer to the document as it was at startBatch(), so you can't remove a
+	 * key that was added in the same batch. Updating the same key more than once keeps the last
+	 * value. startModify() can't be used during a batch.
+	 *
+	 * @return false if a batch or another modification is already in progress
+	 */
+	bool startBatch(char *scratch, size_t scratchLen, JsonModifierSplice *splices, size_t maxSplices);
+
+	/**
+	 * @brief Apply the edits recorded since startBatch()
+	 *
+	 * Note: This method calls jp.parse() so any jsmntok_t may be changed by this method.
+	 *
+	 * @return false if the scratch buffer or splices ran out, or if the result might not fit in the
+	 * parser buffer. In that case the document is left unchanged.
+	 */
+	bool finishBatch();
+
+	/**
+	 * @brief Returns true between startBatch() and finishBatch()
+	 */
+	bool isBatchInProgress() const { return batchSplices != 0; }
+
 
 	/**
 	 * @brief Return a copy of tok, but moving so start and end include the double quotes for strings
@@ -1483,8 +1844,337 @@ protected:
 	int origAfter = 0;			//!< Number of bytes after the insertion position, saved at saveLoc when start is in progress.
 	int saveLoc = 0;			//!< Location where data is temporarily saved until finish() is called
 	//bool addSeparator = false;	//!< Set by startAppend() and used by insertCheckSeparator()
+
+	/**
+	 * @brief Record an edit during a batch. Used internally.
+	 */
+	bool addSplice(int start, int end, size_t dataOffset, size_t dataLen);
+
+	/**
+	 * @brief Apply the recorded edits in one pass. Used internally by finishBatch().
+	 */
+	bool applySplices();
+
+	JsonModifierSplice *batchSplices = 0;	//!< Recorded edits, or NULL if a batch is not in progress
+	size_t batchMaxSplices = 0;				//!< Number of entries in batchSplices
+	size_t batchNumSplices = 0;				//!< Number of entries in batchSplices in use
+	char *batchScratch = 0;					//!< Data for the inserted values
+	size_t batchScratchLen = 0;				//!< Length of batchScratch
+	size_t batchScratchUsed = 0;			//!< Bytes of batchScratch in use
+	bool batchError = false;				//!< Set if the batch ran out of splices or scratch
 };
 
+/**
+ * @brief JsonModifier with statically allocated space for batched edits
+ *
+ * Example:
+ *
+ * ```
+ * JsonModifierBatch<128, 8> mod(jp);
+ * mod.startBatch();
+ * mod.insertOrUpdateKeyValue(jp.getOuterObject(), "tempLow", 38);
+ * mod.insertOrUpdateKeyValue(jp.getOuterObject(), "tempHigh", 90);
+ * mod.removeKeyValue(jp.getOuterObject(), "battLow");
+ * mod.finishBatch();
+ * ```
+ *
+ * @param SCRATCH_SIZE Bytes of inserted data the batch can hold
+ *
+ * @param MAX_SPLICES Number of edits the batch can hold
+ */
+template <size_t SCRATCH_SIZE, size_t MAX_SPLICES>
+class JsonModifierBatch : public JsonModifier {
+public:
+	explicit JsonModifierBatch(JsonParser &jp) : JsonModifier(jp) {};
+
+	using JsonModifier::startBatch;
+
+	/**
+	 * @brief Start a batch using the static buffers
+	 */
+	bool startBatch() { return startBatch(staticScratch, SCRATCH_SIZE, staticSplices, MAX_SPLICES); }
+
+private:
+	char staticScratch[SCRATCH_SIZE];					//!< static scratch buffer
+	JsonModifierSplice staticSplices[MAX_SPLICES];		//!< static splice array
+};
+
+
+/**
+ * @brief Used internally by JsonStreamParser to hold an out-of-order chunk
+ */
+typedef struct {
+	int chunkIndex;		//!< The /N number of the chunk in this slot, or -1 if the slot is free
+	size_t dataLen;		//!< Number of bytes of data in the slot
+} JsonStreamChunkSlot;
+
+/**
+ * @brief Used internally by JsonStreamParser for each open object or array
+ */
+typedef struct {
+	uint16_t pathLen;	//!< Length of the path to this object or array
+	uint16_t index;		//!< Array index of the current element (arrays only)
+	bool isArray;		//!< true for an array, false for an object
+	bool overflow;		//!< true if the path to this object or array didn't fit in the path buffer
+} JsonStreamLevel;
+
+/// @brief Incremental JSON parser that calls back with values as the data arrives
+///
+/// Unlike JsonParser, the document is never stored, and there are no tokens. Data is consumed as
+/// it arrives and only the values you subscribe to are copied out, so a large hook-response can
+/// be handled in a fixed amount of RAM.
+///
+/// Paths are keys and array indexes separated by /, for example "forecast/0/temp". A path
+/// segment of * matches any key or index, so "forecast/*/temp" calls back once per element.
+/// Callbacks are made for strings (unescaped, UTF-8; a lone surrogate escape becomes U+FFFD)
+/// and primitives (numbers, true, false, null, as in the data). Objects and arrays are not
+/// passed to callbacks. The document must be an object or array at the top level.
+///
+/// You normally use JsonStreamParserStatic, which allocates the buffers for you.
+class JsonStreamParser {
+public:
+	/**
+	 * @brief Callback function type
+	 *
+	 * @param path The path of the value, such as "forecast/0/temp"
+	 *
+	 * @param value The value as a c-string. Strings are unescaped.
+	 *
+	 * @param type JSMN_STRING or JSMN_PRIMITIVE
+	 */
+	typedef std::function<void(const char *path, const char *value, JsonParserGeneratorRK::jsmntype_t type)> Callback;
+
+	/**
+	 * @brief Construct a parser using the specified buffers
+	 *
+	 * @param pathBuffer Buffer to hold the path of the current value
+	 *
+	 * @param pathBufferLen Length of pathBuffer, including the null terminator
+	 *
+	 * @param valueBuffer Buffer to hold a subscribed value
+	 *
+	 * @param valueBufferLen Length of valueBuffer, including the null terminator
+	 *
+	 * @param slots Slots for chunks that arrive out of order. Can be NULL if numSlots is 0.
+	 *
+	 * @param slotData numSlots * chunkSize bytes of storage for out-of-order chunks
+	 *
+	 * @param numSlots Number of out-of-order chunks that can be held
+	 *
+	 * @param chunkSize The size of all chunks except the last one (512 for hook-responses)
+	 */
+	JsonStreamParser(char *pathBuffer, size_t pathBufferLen, char *valueBuffer, size_t valueBufferLen, JsonStreamChunkSlot *slots, char *slotData, size_t numSlots, size_t chunkSize);
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~JsonStreamParser();
+
+	/**
+	 * @brief Call a function for each value whose path matches
+	 *
+	 * @param path The path to match. It is not copied and must remain valid.
+	 *
+	 * @param callback The function to call
+	 *
+	 * @return false if MAX_SUBSCRIPTIONS are already in use
+	 *
+	 * Subscriptions are kept when reset() is called.
+	 */
+	bool subscribe(const char *path, Callback callback);
+
+	/**
+	 * @brief Reset the parser to start a new document
+	 */
+	void reset();
+
+	/**
+	 * @brief Parse data that arrives in order
+	 *
+	 * @param data Pointer to the data. Does not need to be null-terminated.
+	 *
+	 * @param dataLen Length of the data in bytes
+	 *
+	 * @return false if the data is not valid JSON
+	 */
+	bool addData(const char *data, size_t dataLen);
+
+	/**
+	 * @brief Parse chunked multipart data, typically from an event subscription handler
+	 *
+	 * @param event The event name. Used to find the multipart segment number at the end
+	 *
+	 * @param data The event data (c-string)
+	 *
+	 * @return false if the data is not valid JSON, or a chunk arrived too far out of order to be
+	 * held in a slot.
+	 *
+	 * Like JsonBuffer::addChunkedData() but chunks are parsed as soon as all of the chunks before
+	 * them have arrived. Chunks that arrive early are held in a slot until then. Call reset() once
+	 * isDone() or hasError() is true, before the next response arrives.
+	 */
+	bool addChunkedData(const char *event, const char *data);
+
+	/**
+	 * @brief Returns true when the top-level object or array has been completely parsed
+	 */
+	bool isDone() const { return state == STATE_DONE; }
+
+	/**
+	 * @brief Returns true if the data was not valid JSON
+	 */
+	bool hasError() const { return state == STATE_ERROR; }
+
+	/**
+	 * @brief Returns true if a subscribed value was skipped because it didn't fit in the value buffer
+	 */
+	bool isTruncated() const { return truncated; }
+
+	/**
+	 * @brief Maximum number of subscriptions
+	 */
+	static const size_t MAX_SUBSCRIPTIONS = 8;
+
+	/**
+	 * @brief Maximum nesting of objects and arrays
+	 */
+	static const size_t MAX_DEPTH = 16;
+
+protected:
+	/**
+	 * @brief Parser states, used internally
+	 */
+	enum State {
+		STATE_VALUE,			//!< Expecting a value
+		STATE_OBJECT_FIRST,		//!< After {, expecting a key or }
+		STATE_ARRAY_FIRST,		//!< After [, expecting a value or ]
+		STATE_KEY,				//!< After , in an object, expecting a key
+		STATE_COLON,			//!< After a key, expecting :
+		STATE_STRING,			//!< In a string
+		STATE_STRING_ESCAPE,	//!< After a \ in a string
+		STATE_STRING_UNICODE,	//!< In the hex digits of a \u escape
+		STATE_PRIMITIVE,		//!< In a number, true, false or null
+		STATE_AFTER_VALUE,		//!< After a value, expecting , or the end of the object or array
+		STATE_DONE,				//!< The top-level value is complete
+		STATE_ERROR				//!< Invalid JSON
+	};
+
+	/**
+	 * @brief Process one character of the document
+	 */
+	void processChar(char ch);
+
+	/**
+	 * @brief Start a value with its first character; the path has already been set
+	 */
+	void startValue(char ch);
+
+	/**
+	 * @brief Called after a value or a whole object or array is complete
+	 */
+	void finishValue();
+
+	/**
+	 * @brief Pass the value buffer to the callbacks that match the current path
+	 */
+	void callSubscribers(JsonParserGeneratorRK::jsmntype_t type);
+
+	/**
+	 * @brief Set the last path segment to the current array index
+	 */
+	void setIndexSegment();
+
+	/**
+	 * @brief Add a character to the key (in the path buffer) or the value buffer
+	 */
+	void appendChar(char ch);
+
+	/**
+	 * @brief Add a Unicode code point as UTF-8
+	 */
+	void appendUnicode(uint32_t unicode);
+
+	/**
+	 * @brief Appends U+FFFD for a pending high surrogate that wasn't followed by a low surrogate
+	 */
+	void flushSurrogate();
+
+	/**
+	 * @brief Returns true if path matches a subscription pattern, with * matching any one segment
+	 */
+	static bool pathMatches(const char *pattern, const char *path);
+
+	char *pathBuffer;						//!< Path of the current value
+	size_t pathBufferLen;					//!< Length of pathBuffer
+	size_t pathLen;							//!< Length of the path in pathBuffer
+	bool pathOverflow;						//!< true if the current path didn't fit; nothing under it matches
+	char *valueBuffer;						//!< Value being copied for subscribers
+	size_t valueBufferLen;					//!< Length of valueBuffer
+	size_t valueLen;						//!< Length of the value in valueBuffer
+	bool valueOverflow;						//!< true if the current value didn't fit in valueBuffer
+	JsonStreamChunkSlot *slots;				//!< Slots for out-of-order chunks
+	char *slotData;							//!< Storage for out-of-order chunks, chunkSize bytes per slot
+	size_t numSlots;						//!< Number of slots
+	size_t chunkSize;						//!< Size of all chunks but the last
+	int nextChunk;							//!< The chunk number expected next by addChunkedData()
+
+	struct {
+		const char *path;
+		Callback callback;
+	} subscriptions[MAX_SUBSCRIPTIONS];		//!< Paths subscribed to and their callbacks
+	size_t numSubscriptions;				//!< Number of entries in subscriptions in use
+
+	JsonStreamLevel levels[MAX_DEPTH];		//!< Open objects and arrays
+	size_t depth;							//!< Number of entries in levels in use
+	State state;							//!< Parser state
+	bool stringIsKey;						//!< true if the string being parsed is an object key
+	uint8_t matchMask;						//!< Bit per subscription that matches the current value
+	uint8_t unicodeDigits;					//!< Number of hex digits of a \u escape read so far
+	uint16_t unicodeValue;					//!< Value of the \u escape so far
+	uint16_t highSurrogate;					//!< First half of a surrogate pair, or 0
+	bool truncated;							//!< true if a subscribed value didn't fit in valueBuffer
+};
+
+/// @brief Creates a JsonStreamParser with statically allocated buffers
+///
+/// Example:
+///
+/// ```
+/// JsonStreamParserStatic<64, 32> parser;
+///
+/// void setup() {
+///     parser.subscribe("forecast/*/temp", [](const char *path, const char *value, JsonParserGeneratorRK::jsmntype_t type) {
+///         Log.info("%s = %s", path, value);
+///     });
+///     Particle.subscribe(System.deviceID() + "/hook-response/forecast/", hookHandler);
+/// }
+///
+/// void hookHandler(const char *event, const char *data) {
+///     parser.addChunkedData(event, data);
+///     if (parser.isDone() || parser.hasError()) {
+///         parser.reset();
+///     }
+/// }
+/// ```
+///
+/// @param PATH_SIZE Size of the path buffer. Must be longer than the longest path you want to match.
+///
+/// @param VALUE_SIZE Size of the value buffer. Must be longer than the longest value you subscribe to.
+///
+/// @param REORDER_SLOTS Number of out-of-order chunks that can be held (default: 2)
+///
+/// @param CHUNK_SIZE The size of all chunks except the last one (default: 512, for hook-responses)
+template <size_t PATH_SIZE, size_t VALUE_SIZE, size_t REORDER_SLOTS = 2, size_t CHUNK_SIZE = 512>
+class JsonStreamParserStatic : public JsonStreamParser {
+public:
+	explicit JsonStreamParserStatic() : JsonStreamParser(staticPath, PATH_SIZE, staticValue, VALUE_SIZE, staticSlots, staticSlotData, REORDER_SLOTS, CHUNK_SIZE) {};
+
+private:
+	char staticPath[PATH_SIZE];												//!< static path buffer
+	char staticValue[VALUE_SIZE];											//!< static value buffer
+	JsonStreamChunkSlot staticSlots[REORDER_SLOTS ? REORDER_SLOTS : 1];		//!< static out-of-order chunk slots
+	char staticSlotData[(REORDER_SLOTS ? REORDER_SLOTS : 1) * CHUNK_SIZE];	//!< static out-of-order chunk data
+};
 
 
 #endif /* __JSONPARSERGENERATORRK_H */
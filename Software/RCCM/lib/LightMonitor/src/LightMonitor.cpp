@@ -0,0 +1,100 @@
+
+// INCLUDEs
+#include "LightMonitor.h"
+
+
+
+
+// CONSTRUCTOR
+LightMonitor::LightMonitor(uint16_t pin, uint32_t samplePeriodMs, int32_t stepThreshold, int32_t lightsOnLevel, uint32_t lightsOnHoldMs) :
+    pin(pin), samplePeriodMs(samplePeriodMs), stepThreshold(stepThreshold), lightsOnLevel(lightsOnLevel), lightsOnHoldMs(lightsOnHoldMs),
+    lastSampleMs(0), lastValue(0), lastValueValid(false), litSinceMs(0), lit(false) {
+
+    resetStatistics();
+}
+
+
+// DESTRUCTOR
+LightMonitor::~LightMonitor() {
+
+}
+
+
+// Call from loop(); takes one sample when the sample period has elapsed.
+void LightMonitor::process(void) {
+    uint32_t now = millis();
+
+    if ((lastValueValid == true) && ((now - lastSampleMs) < samplePeriodMs)) {
+        return;
+    }
+
+    addSample(analogRead(pin), now);
+}
+
+
+// 
+void LightMonitor::addSample(int32_t value, uint32_t timeMs) {
+    // Running Statistics (Welford)
+    count++;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+
+    if (value < min) {
+        min = value;
+    }
+    if (value > max) {
+        max = value;
+    }
+
+    // DOOR_OPEN - Step up out of a dark cabin.
+    if ((lastValueValid == true) && (lastValue < lightsOnLevel) && ((value - lastValue) >= stepThreshold)) {
+        doorEvents++;
+    }
+
+    // LIGHTS_ON - Level held high for the hold period.
+    if (value >= lightsOnLevel) {
+        if (lit == false) {
+            lit = true;
+            litSinceMs = timeMs;
+        }
+        if ((timeMs - litSinceMs) >= lightsOnHoldMs) {
+            lightsOn = true;
+        }
+    }
+    else
+    {
+        lit = false;
+    }
+
+    lastValue = value;
+    lastValueValid = true;
+    lastSampleMs = timeMs;
+}
+
+
+// Copy out the interval summary & start a new interval.  The lit/unlit state carries over so a
+// light left on across several intervals keeps reporting.
+void LightMonitor::takeInterval(struct intervalSummary &summary) {
+    summary.samples     = count;
+    summary.min         = (count > 0) ? min : 0;
+    summary.max         = (count > 0) ? max : 0;
+    summary.mean        = mean;
+    summary.stdDev      = (count > 1) ? sqrt(m2 / (count - 1)) : 0.0;
+    summary.doorEvents  = doorEvents;
+    summary.lightsOn    = lightsOn;
+
+    resetStatistics();
+}
+
+
+// 
+void LightMonitor::resetStatistics(void) {
+    count       = 0;
+    min         = INT32_MAX;
+    max         = INT32_MIN;
+    mean        = 0.0;
+    m2          = 0.0;
+    doorEvents  = 0;
+    lightsOn    = false;
+}
@@ -0,0 +1,57 @@
+#ifndef LightMonitor_h
+#define LightMonitor_h
+
+// 
+#include <Particle.h>
+
+
+// Streaming light level statistics.  Samples are folded into running min/max/mean/variance (Welford)
+// as they arrive and then discarded, so memory use is fixed regardless of sample rate.
+class LightMonitor {
+    public:
+        // PUBLIC - Class Variables
+        struct intervalSummary {
+            uint32_t    samples;
+            int32_t     min;
+            int32_t     max;
+            double      mean;
+            double      stdDev;
+            uint32_t    doorEvents;         // Upward steps from a dark cabin
+            bool        lightsOn;           // Level held above lightsOnLevel for at least lightsOnHoldMs
+        };
+
+        // PUBLIC - Class Functions
+        LightMonitor(uint16_t pin, uint32_t samplePeriodMs, int32_t stepThreshold, int32_t lightsOnLevel, uint32_t lightsOnHoldMs);
+        ~LightMonitor();
+        void process(void);
+        void addSample(int32_t value, uint32_t timeMs);
+        void takeInterval(struct intervalSummary &summary);
+
+    private:
+        // PRIVATE - Class Variables
+        uint16_t    pin;
+        uint32_t    samplePeriodMs;
+        int32_t     stepThreshold;
+        int32_t     lightsOnLevel;
+        uint32_t    lightsOnHoldMs;
+
+        uint32_t    lastSampleMs;
+        int32_t     lastValue;
+        bool        lastValueValid;
+        uint32_t    litSinceMs;
+        bool        lit;
+
+        uint32_t    count;
+        int32_t     min;
+        int32_t     max;
+        double      mean;
+        double      m2;
+        uint32_t    doorEvents;
+        bool        lightsOn;
+
+        // PRIVATE - Class Functions
+        void resetStatistics(void);
+
+};
+
+#endif
@@ -2,53 +2,10 @@
 
 LocalTime *LocalTime::_instance;
 
-LocalTimeHMS::LocalTimeHMS() {
-}
-
-LocalTimeHMS::~LocalTimeHMS() {
-}
-
-LocalTimeHMS::LocalTimeHMS(const char *str) {
-    parse(str);
-}
-
-void LocalTimeHMS::clear() {
-    hour = minute = second = 0;
-}
-
-void LocalTimeHMS::parse(const char *str) {
-    clear();
-
-    int values[3];
-    if (sscanf(str, "%d:%d:%d", &values[0], &values[1], &values[2]) == 3) {
-        hour = (int8_t) values[0];    
-        minute = (int8_t) values[1];    
-        second = (int8_t) values[2];    
-    }
-    else
-    if (sscanf(str, "%d:%d", &values[0], &values[1]) == 2) {
-        hour = (int8_t) values[0];    
-        minute = (int8_t) values[1];    
-    }
-    else
-    if (sscanf(str, "%d", &values[0]) == 1) {
-        hour = (int8_t) values[0];    
-    }
-}
-
 String LocalTimeHMS::toString() const {
     return String::format("%d:%02d:%02d", (int)hour, (int)minute, (int)second);
 }
 
-int LocalTimeHMS::toSeconds() const {
-    if (hour < 0) {
-        return - (((int)hour) * -3600 + ((int)minute) * 60 + (int) second);
-    }
-    else {
-        return ((int)hour) * 3600 + ((int)minute) * 60 + (int) second;
-    }
-}
-
 void LocalTimeHMS::fromTimeInfo(const struct tm *pTimeInfo) {
     hour = (int8_t) pTimeInfo->tm_hour;
     minute = (int8_t) pTimeInfo->tm_min;
@@ -83,49 +40,6 @@ void LocalTimeHMS::adjustTimeInfo(struct tm *pTimeInfo) const {
 //
 // LocalTimeChange
 //
-LocalTimeChange::LocalTimeChange() {
-}
-LocalTimeChange::~LocalTimeChange() {
-}
-
-LocalTimeChange::LocalTimeChange(const char *str) {
-    parse(str);
-}
-
-void LocalTimeChange::clear() {
-    month = week = dayOfWeek = valid = 0;
-    hms.clear();
-}
-
-
-void LocalTimeChange::parse(const char *str) {
-    // M3.2.0/2:00:00
-    if (!str || str[0] != 'M') {
-        clear();
-        return;
-    }
-
-    int values[3];
-    if (sscanf(str, "M%d.%d.%d", &values[0], &values[1], &values[2]) == 3) {
-        month = (int8_t) values[0];
-        week = (int8_t) values[1];
-        dayOfWeek = (int8_t) values[2];
-
-        const char *cp = strchr(str, '/');
-        if (cp) {
-            cp++;
-            hms.parse(cp);
-        }
-        else {
-            hms.clear();
-        }
-        valid = true;
-    }
-    else {
-        clear();
-    }
-}
-
 String LocalTimeChange::toString() const {
     if (valid) {
         return String::format("M%d.%d.%d/%d:%02d:%02d", (int)month, (int)week, (int)dayOfWeek, (int)hms.hour, (int)hms.minute, (int)hms.second);
@@ -137,38 +51,37 @@ String LocalTimeChange::toString() const {
 
 
 time_t LocalTimeChange::calculate(struct tm *pTimeInfo, LocalTimeHMS tzAdjust) const {
-    // Start with the first of the month
-    pTimeInfo->tm_mday = 1;
-    pTimeInfo->tm_mon = month - 1; // tm_mon is zero-based!
-    pTimeInfo->tm_hour = pTimeInfo->tm_min = pTimeInfo->tm_sec = 0;
-    LocalTime::tmToTime(pTimeInfo);
+    int year = pTimeInfo->tm_year + 1900;
+
+    // Day of week of the first of the month, then forward to the first dayOfWeek
+    int32_t firstOfMonth = LocalTime::daysFromCivil(year, month, 1);
+    int dayOfMonth = 1 + (dayOfWeek - LocalTime::dayOfWeekFromDays(firstOfMonth) + 7) % 7;
 
-    while(pTimeInfo->tm_wday != dayOfWeek) {
-        pTimeInfo->tm_mday++;
-        LocalTime::tmToTime(pTimeInfo);
-    }
     if (week != 1) {
-        pTimeInfo->tm_mday += (week - 1) * 7;
-        if (pTimeInfo->tm_mday > LocalTime::lastDayOfMonth(pTimeInfo->tm_year + 1900, month)) {
+        dayOfMonth += (week - 1) * 7;
+        if (dayOfMonth > LocalTime::lastDayOfMonth(year, month)) {
             // 5 means the last week of the month, even if there is no 5th week
-            pTimeInfo->tm_mday -= 7;
+            dayOfMonth -= 7;
         }
-
-        LocalTime::tmToTime(pTimeInfo);        
     }
 
     // We now know the date of time change in local time
+    time_t result = (time_t)(firstOfMonth + dayOfMonth - 1) * 86400;
 
     // Set the time of the time change in local time (for example, 2:00:00 in the United States)
-    hms.toTimeInfo(pTimeInfo);
+    if (!hms.ignore) {
+        result += hms.hour * 3600 + hms.minute * 60 + hms.second;
+    }
 
     // Handle timezone conversion (also DST if necessary)
     // The tzAdjust values are positive in the US, so to convert local time to UTC we need to add
     // to the hour values
-    tzAdjust.adjustTimeInfo(pTimeInfo);
-
+    if (!tzAdjust.ignore) {
+        result += tzAdjust.toSeconds();
+    }
 
-    return LocalTime::tmToTime(pTimeInfo);
+    LocalTime::timeToTm(result, pTimeInfo);
+    return result;
 }
 
 
@@ -176,97 +89,29 @@ time_t LocalTimeChange::calculate(struct tm *pTimeInfo, LocalTimeHMS tzAdjust) c
 // LocalTimePosixTimezone
 //
 
-LocalTimePosixTimezone::LocalTimePosixTimezone() {
-}
-LocalTimePosixTimezone::~LocalTimePosixTimezone() {
-}
-
-LocalTimePosixTimezone::LocalTimePosixTimezone(const char *str) {
-    parse(str);
-}
-
-void LocalTimePosixTimezone::clear() {
-    dstStart.clear();
-    dstName = "";
-    dstHMS.clear();
-    standardStart.clear();
-    standardName = "";
-    standardHMS.clear();
-}
+const LocalTimeTransitions &LocalTimePosixTimezone::getTransitions(time_t time) const {
+    if (time >= transitions.yearStart && time < transitions.yearEnd) {
+        return transitions;
+    }
 
-bool LocalTimePosixTimezone::parse(const char *str) {
-    char *mutableCopy = strdup(str);
+    struct tm timeInfo;
+    LocalTime::timeToTm(time, &timeInfo);
 
-    char *token, *save = mutableCopy;
-    size_t ii = 0;
-    while((token = strtok_r(save, ",", &save)) != 0) {
-        switch(ii++) {
-            case 0: {
-                // Timezone specifier
-                char *cp = token, *start = token, save2;
-                while(*cp >= 'A') {
-                    cp++;
-                }
-                save2 = *cp;
-                *cp = 0;
-                standardName = start;
-                *cp = save2;
-                valid = true;
-
-                if (*cp) {
-                    start = cp;
-                    while(*cp && *cp < 'A') {
-                        cp++;
-                    }
-                    save2 = *cp;
-                    *cp = 0;
-                    standardHMS.parse(start);
-                    *cp = save2;
-
-                    if (*cp) {
-                        start = cp;
-                        while(*cp && *cp >= 'A') {
-                            cp++;
-                        }
-                        save2 = *cp;
-                        *cp = 0;
-                        dstName = start;
-                        *cp = save2;
-
-                        if (*cp) {
-                            start = cp;
-                            dstHMS.parse(start);
-                        }
-                        else {
-                            // Default dst is 1 hour later
-                            dstHMS = standardHMS;
-                            dstHMS.hour--;
-                        }
-                    }
-                }
-                break;
-            }
-            case 1: {
-                dstStart.parse(token);
-                break;
-            }
-            case 2: {
-                standardStart.parse(token);
-                break;
-            }
-        }
-    }
+    transitions.dstStartTimeInfo = transitions.standardStartTimeInfo = timeInfo;
 
-    if (dstStart.valid && !standardStart.valid) {
-        // If DST start is specified, standard start must also be specified
-        dstStart.clear();
-        valid = false;
-    }
+    // Calculate start of DST. Note that the second parameter is standardHMS because when you enter DST at 
+    // a local standard time; you have not yet entered DST.
+    transitions.dstStart = dstStart.calculate(&transitions.dstStartTimeInfo, standardHMS);
 
+    // Calculate start of standard time. Same for the second parameter here, when entering standard time
+    // you are leaving DST. For example you leave DST at 2 AM EDT (-0400) so that's the adjustment to UTC.
+    transitions.standardStart = standardStart.calculate(&transitions.standardStartTimeInfo, dstHMS);
 
-    free(mutableCopy);
+    // The rules are per UTC year, so the result is good for any time in the same UTC year
+    transitions.yearStart = (time_t)LocalTime::daysFromCivil(timeInfo.tm_year + 1900, 1, 1) * 86400;
+    transitions.yearEnd = (time_t)LocalTime::daysFromCivil(timeInfo.tm_year + 1901, 1, 1) * 86400;
 
-    return valid;
+    return transitions;
 }
 
 //
@@ -301,7 +146,7 @@ void LocalTimeValue::setHMS(LocalTimeHMS hms) {
 }
 
 
-time_t LocalTimeValue::toUTC(LocalTimePosixTimezone config) const {
+time_t LocalTimeValue::toUTC(const LocalTimePosixTimezone &config) const {
     struct tm mutableTimeInfo = *this;
     time_t standardTime, dstTime;
     
@@ -326,13 +171,7 @@ void LocalTimeValue::fromString(const char *str) {
 }
 
 int LocalTimeValue::ordinal() const {
-    int ordinal = 1;
-    int tempDayOfMonth = tm_mday;
-    while((tempDayOfMonth - 7) >= 1) {
-        ordinal++;
-        tempDayOfMonth -= 7;
-    }
-    return ordinal;
+    return (tm_mday - 1) / 7 + 1;
 }
 
 
@@ -345,21 +184,17 @@ int LocalTimeValue::ordinal() const {
 void LocalTimeConvert::convert() {
     if (!config.isValid()) {
         config = LocalTime::instance().getConfig();
-        //printf("get global config dstName=%s hasDST=%d\n", config.dstName.c_str(), config.hasDST());
+        //printf("get global config dstName=%s hasDST=%d\n", config.dstName, config.hasDST());
     }
 
     if (config.hasDST()) {
-        // We need to worry about daylight saving time
-        LocalTime::timeToTm(time, &dstStartTimeInfo);
-        standardStartTimeInfo = dstStartTimeInfo;
-
-        // Calculate start of DST. Note that the second parameter is standardHMS because when you enter DST at 
-        // a local standard time; you have not yet entered DST.
-        dstStart = config.dstStart.calculate(&dstStartTimeInfo, config.standardHMS);
-
-        // Calculate start of standard time. Same for the second parameter here, when entering standard time
-        // you are leaving DST. For example you leave DST at 2 AM EDT (-0400) so that's the adjustment to UTC.
-        standardStart = config.standardStart.calculate(&standardStartTimeInfo, config.dstHMS);
+        // We need to worry about daylight saving time. The time changes only depend on the
+        // year, so they come from the config's cache unless the year changed.
+        const LocalTimeTransitions &transitions = config.getTransitions(time);
+        dstStart = transitions.dstStart;
+        dstStartTimeInfo = transitions.dstStartTimeInfo;
+        standardStart = transitions.standardStart;
+        standardStartTimeInfo = transitions.standardStartTimeInfo;
 
         if (dstStart < standardStart) {
             // Northern Hemisphere, DST is in summer
@@ -500,9 +335,12 @@ void LocalTimeConvert::nextLocalTime(LocalTimeHMS hms) {
     time_t origTime = time;
     localTimeValue.setHMS(hms);
     time = localTimeValue.toUTC(config);
-    if (time <= origTime) {
-        // Need to move to tomorrow
-        time += 86400;
+    while (time <= origTime) {
+        // Need to move to tomorrow. Step the local date rather than adding 86400
+        // seconds so the local time is kept across a DST change. (A time in the
+        // spring forward gap can map back before origTime; try the day after.)
+        localTimeValue.tm_mday++;
+        time = localTimeValue.toUTC(config);
     }
     convert();
 }
@@ -517,10 +355,10 @@ void LocalTimeConvert::atLocalTime(LocalTimeHMS hms) {
 }
 
 String LocalTimeConvert::timeStr() {
+    static const LocalTimeFormat asctimeFormat(TIME_FORMAT_DEFAULT);
+
     char ascstr[26];
-    asctime_r(&localTimeValue, ascstr);
-    int len = strlen(ascstr);
-    ascstr[len-1] = 0; // remove final newline
+    format(asctimeFormat, ascstr, sizeof(ascstr));
     return String(ascstr);
 }
 
@@ -530,6 +368,15 @@ String LocalTimeConvert::format(const char* format_spec) {
         return timeStr();
     }
 
+    char buf[50] = {};
+
+    LocalTimeFormat fmt;
+    if (fmt.compile(format_spec)) {
+        format(fmt, buf, sizeof(buf));
+        return String(buf);
+    }
+
+    // Conversions LocalTimeFormat does not support go through strftime.
     // This implementation is from spark_wiring_time.cpp
 
     char format_str[64];
@@ -539,7 +386,8 @@ String LocalTimeConvert::format(const char* format_spec) {
     size_t len = strlen(format_str); // Flawfinder: ignore (ch42318)
 
     // while we are not using stdlib for managing the timezone, we have to do this manually
-    const char *time_zone_name = zoneName().c_str();
+    String zoneNameStr = zoneName();
+    const char *time_zone_name = zoneNameStr.c_str();
 
     char time_zone_str[16];
     if (config.isZ()) {
@@ -571,11 +419,176 @@ String LocalTimeConvert::format(const char* format_spec) {
         }
     }
 
-    char buf[50] = {};
     strftime(buf, sizeof(buf), format_str, &localTimeValue);
     return String(buf);    
 }
 
+size_t LocalTimeConvert::format(const LocalTimeFormat &fmt, char *buf, size_t bufSize) const {
+    const char *zoneNamePtr;
+    if (config.isZ()) {
+        zoneNamePtr = "Z";
+    }
+    else
+    if (isDST()) {
+        zoneNamePtr = config.dstName;
+    }
+    else {
+        zoneNamePtr = config.standardName;
+    }
+
+    return fmt.format(localTimeValue, utcOffset(), config.isZ(), zoneNamePtr, buf, bufSize);
+}
+
+void LocalTimeConvert::convertBatch(const time_t *times, size_t count, LocalTimeValue *localTimeValues) {
+    bool dst[BATCH_SIZE];
+
+    while(count > 0) {
+        size_t converted = convertBlock(times, count, localTimeValues, dst);
+        times += converted;
+        localTimeValues += converted;
+        count -= converted;
+    }
+}
+
+void LocalTimeConvert::formatBatch(const time_t *times, size_t count, const LocalTimeFormat &fmt, char *buf, size_t stride) {
+    LocalTimeValue localTimeValues[BATCH_SIZE];
+    bool dst[BATCH_SIZE];
+
+    while(count > 0) {
+        size_t converted = convertBlock(times, count, localTimeValues, dst);
+
+        for(size_t ii = 0; ii < converted; ii++) {
+            const char *zoneNamePtr = config.isZ() ? "Z" : (dst[ii] ? config.dstName : config.standardName);
+            int offset = -(dst[ii] ? config.dstHMS.toSeconds() : config.standardHMS.toSeconds());
+
+            fmt.format(localTimeValues[ii], offset, config.isZ(), zoneNamePtr, buf, stride);
+            buf += stride;
+        }
+        times += converted;
+        count -= converted;
+    }
+}
+
+size_t LocalTimeConvert::convertBlock(const time_t *times, size_t count, LocalTimeValue *localTimeValues, bool *dst) {
+    if (count == 0) {
+        return 0;
+    }
+    if (!config.isValid()) {
+        config = LocalTime::instance().getConfig();
+    }
+
+    // Everything below is relative to base, the start of the UTC year, so the per
+    // time arithmetic fits in int32_t (and is unsigned where that is cheaper)
+    time_t base, end;
+    int32_t dstStartRel = 0, standardStartRel = 0;
+    bool southern = false;
+    int32_t standardOffset = -config.standardHMS.toSeconds();
+    int32_t dstOffset = -config.dstHMS.toSeconds();
+
+    if (config.hasDST()) {
+        const LocalTimeTransitions &transitions = config.getTransitions(times[0]);
+        base = transitions.yearStart;
+        end = transitions.yearEnd;
+        dstStartRel = (int32_t)(transitions.dstStart - base);
+        standardStartRel = (int32_t)(transitions.standardStart - base);
+        southern = (transitions.dstStart >= transitions.standardStart);
+    }
+    else {
+        // No time changes. dstStartRel == standardStartRel means never DST.
+        struct tm timeInfo;
+        LocalTime::timeToTm(times[0], &timeInfo);
+        base = (time_t)LocalTime::daysFromCivil(timeInfo.tm_year + 1900, 1, 1) * 86400;
+        end = (time_t)LocalTime::daysFromCivil(timeInfo.tm_year + 1901, 1, 1) * 86400;
+    }
+
+    // The run of times in the same year, up to BATCH_SIZE
+    int32_t rel[BATCH_SIZE];
+    size_t num = (count < BATCH_SIZE) ? count : BATCH_SIZE;
+    for(size_t ii = 0; ii < num; ii++) {
+        if (times[ii] < base || times[ii] >= end) {
+            num = ii;
+            break;
+        }
+        rel[ii] = (int32_t)(times[ii] - base);
+    }
+    for(size_t ii = num; ii < BATCH_SIZE; ii++) {
+        // Unused, but the loop below always does a whole block (a constant trip count vectorizes best)
+        rel[ii] = 0;
+    }
+
+    // Offsets are at most about a day, so the local date is in this year or within a
+    // day or two of it. Only the month needs calculating, not the year.
+    int32_t baseDays = (int32_t)(base / 86400);
+    int baseYear, baseMonth, baseDay;
+    LocalTime::civilFromDays(baseDays, baseYear, baseMonth, baseDay);
+
+    int32_t leap = LocalTime::isLeapYear(baseYear);
+    int32_t prevLeap = LocalTime::isLeapYear(baseYear - 1);
+    int32_t nextLeap = LocalTime::isLeapYear(baseYear + 1);
+    int32_t baseDayOfWeek = LocalTime::dayOfWeekFromDays(baseDays);
+    int32_t southernMask = southern ? -1 : 0;
+    int32_t dstAdjust = dstOffset - standardOffset;
+
+    // DST, offset from UTC, and the local time of day, with no branches. The tests
+    // are masks (all ones or zero) so this loop is plain integer operations.
+    // Same DST tests as convert(): northern hemisphere is DST in [dstStart, standardStart),
+    // southern hemisphere is DST before standardStart or from dstStart on.
+    int32_t dstMask[BATCH_SIZE], dayOfBaseYear[BATCH_SIZE], hour[BATCH_SIZE], minute[BATCH_SIZE], second[BATCH_SIZE];
+    for(size_t ii = 0; ii < BATCH_SIZE; ii++) {
+        int32_t afterDstStart = (rel[ii] >= dstStartRel) ? -1 : 0;
+        int32_t beforeStandardStart = (rel[ii] < standardStartRel) ? -1 : 0;
+        int32_t inDST = (afterDstStart & beforeStandardStart) | (southernMask & (afterDstStart | beforeStandardStart));
+
+        // Local seconds since base, plus two days so the divisions are non-negative
+        uint32_t local = (uint32_t)(rel[ii] + standardOffset + (inDST & dstAdjust) + 2 * 86400);
+        uint32_t secondOfDay = local % 86400;
+
+        dstMask[ii] = inDST;
+        dayOfBaseYear[ii] = (int32_t)(local / 86400) - 2;
+        hour[ii] = secondOfDay / 3600;
+        minute[ii] = (secondOfDay / 60) % 60;
+        second[ii] = secondOfDay % 60;
+    }
+
+    // Local date, also with no branches
+    int32_t year[BATCH_SIZE], month[BATCH_SIZE], day[BATCH_SIZE], dayOfWeek[BATCH_SIZE], dayOfYear[BATCH_SIZE];
+    for(size_t ii = 0; ii < BATCH_SIZE; ii++) {
+        // Move into the previous or next year if necessary
+        bool before = (dayOfBaseYear[ii] < 0);
+        bool after = (dayOfBaseYear[ii] >= 365 + leap);
+        int32_t yearLeap = before ? prevLeap : (after ? nextLeap : leap);
+        int32_t yday = dayOfBaseYear[ii] + (before ? (365 + prevLeap) : 0) - (after ? (365 + leap) : 0);
+
+        // Month and day of month, counting from March 1 as in LocalTime::civilFromDays()
+        int32_t fromMarch = yday - (59 + yearLeap);
+        uint32_t dayFromMarch = (uint32_t)(fromMarch + ((fromMarch < 0) ? (365 + yearLeap) : 0));
+        uint32_t mp = (5 * dayFromMarch + 2) / 153;
+
+        year[ii] = baseYear + (after ? 1 : 0) - (before ? 1 : 0);
+        month[ii] = (mp < 10) ? mp + 3 : mp - 9;
+        day[ii] = dayFromMarch - (153 * mp + 2) / 5 + 1;
+        dayOfWeek[ii] = (uint32_t)(dayOfBaseYear[ii] + baseDayOfWeek + 7) % 7;
+        dayOfYear[ii] = yday;
+    }
+
+    for(size_t ii = 0; ii < num; ii++) {
+        struct tm *pTimeInfo = &localTimeValues[ii];
+        pTimeInfo->tm_sec = second[ii];
+        pTimeInfo->tm_min = minute[ii];
+        pTimeInfo->tm_hour = hour[ii];
+        pTimeInfo->tm_mday = day[ii];
+        pTimeInfo->tm_mon = month[ii] - 1;
+        pTimeInfo->tm_year = year[ii] - 1900;
+        pTimeInfo->tm_wday = dayOfWeek[ii];
+        pTimeInfo->tm_yday = dayOfYear[ii];
+        pTimeInfo->tm_isdst = 0;
+
+        dst[ii] = (dstMask[ii] != 0);
+    }
+
+    return num;
+}
+
 String LocalTimeConvert::zoneName() const { 
     if (config.isZ()) {
         return "Z";
@@ -594,6 +607,245 @@ int LocalTimeConvert::lastDayOfMonth() const {
 }
 
 
+//
+// LocalTimeFormat
+//
+
+static const char * const localTimeWeekdayNames[7] = {
+    "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
+};
+
+static const char * const localTimeMonthNames[12] = {
+    "January", "February", "March", "April", "May", "June",
+    "July", "August", "September", "October", "November", "December"
+};
+
+// Copies as much of str as fits, leaving room for the null terminator. Returns the new offset.
+static size_t localTimeAppend(char *buf, size_t bufSize, size_t offset, const char *str, size_t len) {
+    for(size_t ii = 0; ii < len && offset + 1 < bufSize; ii++) {
+        buf[offset++] = str[ii];
+    }
+    return offset;
+}
+
+// Writes value in decimal, at least width digits, padded on the left with pad
+static size_t localTimeAppendNumber(char *buf, size_t bufSize, size_t offset, unsigned int value, int width, char pad) {
+    if (width == 2 && value < 100 && offset + 2 < bufSize) {
+        // Almost every field
+        buf[offset++] = (value >= 10) ? (char)('0' + value / 10) : pad;
+        buf[offset++] = (char)('0' + value % 10);
+        return offset;
+    }
+
+    char digits[10];
+    int numDigits = 0;
+    do {
+        digits[sizeof(digits) - 1 - numDigits++] = (char)('0' + value % 10);
+        value /= 10;
+    } while(value && numDigits < (int)sizeof(digits));
+
+    while(numDigits < width && numDigits < (int)sizeof(digits)) {
+        digits[sizeof(digits) - 1 - numDigits++] = pad;
+    }
+    return localTimeAppend(buf, bufSize, offset, &digits[sizeof(digits) - numDigits], numDigits);
+}
+
+bool LocalTimeFormat::compile(const char *formatSpec) {
+    numSteps = 0;
+    literalLen = 0;
+    valid = false;
+
+    if (!formatSpec) {
+        return false;
+    }
+    if (!strcmp(formatSpec, TIME_FORMAT_DEFAULT)) {
+        // asctime layout, as used by Time.timeStr(): "Fri Jan  1 18:45:56 2021"
+        formatSpec = "%a %b %e %H:%M:%S %Y";
+    }
+
+    for(const char *cp = formatSpec; *cp; cp++) {
+        if (*cp != '%') {
+            const char *start = cp;
+            while(cp[1] && cp[1] != '%') {
+                cp++;
+            }
+            if (!addLiteral(start, cp - start + 1)) {
+                return false;
+            }
+            continue;
+        }
+
+        bool ok;
+        switch(*++cp) {
+            case 'Y': ok = addStep(Op::YEAR); break;
+            case 'y': ok = addStep(Op::YEAR_2); break;
+            case 'm': ok = addStep(Op::MONTH); break;
+            case 'b': ok = addStep(Op::MONTH_ABBR); break;
+            case 'B': ok = addStep(Op::MONTH_FULL); break;
+            case 'd': ok = addStep(Op::DAY); break;
+            case 'e': ok = addStep(Op::DAY_SPACE); break;
+            case 'j': ok = addStep(Op::DAY_OF_YEAR); break;
+            case 'a': ok = addStep(Op::WEEKDAY_ABBR); break;
+            case 'A': ok = addStep(Op::WEEKDAY_FULL); break;
+            case 'H': ok = addStep(Op::HOUR); break;
+            case 'I': ok = addStep(Op::HOUR_12); break;
+            case 'p': ok = addStep(Op::AM_PM); break;
+            case 'M': ok = addStep(Op::MINUTE); break;
+            case 'S': ok = addStep(Op::SECOND); break;
+            case 'z': ok = addStep(Op::UTC_OFFSET); break;
+            case 'Z': ok = addStep(Op::ZONE_NAME); break;
+            case '%': ok = addLiteral("%", 1); break;
+
+            case 'T': 
+                // %H:%M:%S
+                ok = addStep(Op::HOUR) && addLiteral(":", 1) && addStep(Op::MINUTE) && addLiteral(":", 1) && addStep(Op::SECOND); 
+                break;
+
+            case 'F': 
+                // %Y-%m-%d
+                ok = addStep(Op::YEAR) && addLiteral("-", 1) && addStep(Op::MONTH) && addLiteral("-", 1) && addStep(Op::DAY); 
+                break;
+
+            default:
+                // Unsupported conversion, or % at the end of the string
+                return false;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+
+    valid = true;
+    return true;
+}
+
+size_t LocalTimeFormat::format(const struct tm &timeInfo, int utcOffset, bool zulu, const char *zoneName, char *buf, size_t bufSize) const {
+    if (bufSize == 0) {
+        return 0;
+    }
+
+    size_t offset = 0;
+    for(size_t ii = 0; valid && ii < numSteps; ii++) {
+        const Step &step = steps[ii];
+        switch(step.op) {
+            case Op::LITERAL:
+                offset = localTimeAppend(buf, bufSize, offset, &literal[step.arg], step.len);
+                break;
+
+            case Op::YEAR:
+                offset = localTimeAppendNumber(buf, bufSize, offset, timeInfo.tm_year + 1900, 4, '0');
+                break;
+
+            case Op::YEAR_2:
+                offset = localTimeAppendNumber(buf, bufSize, offset, (timeInfo.tm_year + 1900) % 100, 2, '0');
+                break;
+
+            case Op::MONTH:
+                offset = localTimeAppendNumber(buf, bufSize, offset, timeInfo.tm_mon + 1, 2, '0');
+                break;
+
+            case Op::MONTH_ABBR:
+            case Op::MONTH_FULL: {
+                const char *name = localTimeMonthNames[timeInfo.tm_mon % 12];
+                offset = localTimeAppend(buf, bufSize, offset, name, (step.op == Op::MONTH_ABBR) ? 3 : strlen(name));
+                break;
+            }
+
+            case Op::DAY:
+                offset = localTimeAppendNumber(buf, bufSize, offset, timeInfo.tm_mday, 2, '0');
+                break;
+
+            case Op::DAY_SPACE:
+                offset = localTimeAppendNumber(buf, bufSize, offset, timeInfo.tm_mday, 2, ' ');
+                break;
+
+            case Op::DAY_OF_YEAR:
+                offset = localTimeAppendNumber(buf, bufSize, offset, timeInfo.tm_yday + 1, 3, '0');
+                break;
+
+            case Op::WEEKDAY_ABBR:
+            case Op::WEEKDAY_FULL: {
+                const char *name = localTimeWeekdayNames[timeInfo.tm_wday % 7];
+                offset = localTimeAppend(buf, bufSize, offset, name, (step.op == Op::WEEKDAY_ABBR) ? 3 : strlen(name));
+                break;
+            }
+
+            case Op::HOUR:
+                offset = localTimeAppendNumber(buf, bufSize, offset, timeInfo.tm_hour, 2, '0');
+                break;
+
+            case Op::HOUR_12:
+                offset = localTimeAppendNumber(buf, bufSize, offset, (timeInfo.tm_hour % 12) ? (timeInfo.tm_hour % 12) : 12, 2, '0');
+                break;
+
+            case Op::AM_PM:
+                offset = localTimeAppend(buf, bufSize, offset, (timeInfo.tm_hour < 12) ? "AM" : "PM", 2);
+                break;
+
+            case Op::MINUTE:
+                offset = localTimeAppendNumber(buf, bufSize, offset, timeInfo.tm_min, 2, '0');
+                break;
+
+            case Op::SECOND:
+                offset = localTimeAppendNumber(buf, bufSize, offset, timeInfo.tm_sec, 2, '0');
+                break;
+
+            case Op::UTC_OFFSET:
+                if (zulu) {
+                    offset = localTimeAppend(buf, bufSize, offset, "Z", 1);
+                }
+                else {
+                    // "-04:00" (matches Time.format, not the strftime "-0400")
+                    unsigned int absOffset = (utcOffset < 0) ? -utcOffset : utcOffset;
+                    offset = localTimeAppend(buf, bufSize, offset, (utcOffset < 0) ? "-" : "+", 1);
+                    offset = localTimeAppendNumber(buf, bufSize, offset, absOffset / 3600, 2, '0');
+                    offset = localTimeAppend(buf, bufSize, offset, ":", 1);
+                    offset = localTimeAppendNumber(buf, bufSize, offset, (absOffset / 60) % 60, 2, '0');
+                }
+                break;
+
+            case Op::ZONE_NAME:
+                if (zoneName) {
+                    offset = localTimeAppend(buf, bufSize, offset, zoneName, strlen(zoneName));
+                }
+                break;
+        }
+    }
+    buf[offset] = 0;
+
+    return offset;
+}
+
+bool LocalTimeFormat::addStep(Op op, uint8_t arg, uint8_t len) {
+    if (numSteps >= MAX_OPS) {
+        return false;
+    }
+    steps[numSteps].op = op;
+    steps[numSteps].arg = arg;
+    steps[numSteps].len = len;
+    numSteps++;
+    return true;
+}
+
+bool LocalTimeFormat::addLiteral(const char *str, size_t len) {
+    if (literalLen + len > MAX_LITERAL) {
+        return false;
+    }
+    memcpy(&literal[literalLen], str, len);
+
+    if (numSteps > 0 && steps[numSteps - 1].op == Op::LITERAL) {
+        // Adjacent to the previous literal in both the steps and the literal buffer
+        steps[numSteps - 1].len += (uint8_t) len;
+    }
+    else
+    if (!addStep(Op::LITERAL, literalLen, (uint8_t) len)) {
+        return false;
+    }
+    literalLen += (uint8_t) len;
+    return true;
+}
+
+
 //
 // LocalTime
 //
@@ -606,24 +858,44 @@ LocalTime &LocalTime::instance() {
 
 // [static]
 void LocalTime::timeToTm(time_t time, struct tm *pTimeInfo) {
-#ifndef UNITTEST
-    // Particle C standard library does not implement gmtime_r, however the C
-    // library is always set to UTC, so this works
-    localtime_r(&time, pTimeInfo);
-#else
-    gmtime_r(&time, pTimeInfo);     
-#endif
+    // Split into days and seconds of the day, rounding toward negative infinity
+    time_t days = time / 86400;
+    int secondOfDay = (int)(time - days * 86400);
+    if (secondOfDay < 0) {
+        secondOfDay += 86400;
+        days--;
+    }
+
+    int year, month, day;
+    civilFromDays((int32_t)days, year, month, day);
+
+    pTimeInfo->tm_sec = secondOfDay % 60;
+    pTimeInfo->tm_min = (secondOfDay / 60) % 60;
+    pTimeInfo->tm_hour = secondOfDay / 3600;
+    pTimeInfo->tm_mday = day;
+    pTimeInfo->tm_mon = month - 1;
+    pTimeInfo->tm_year = year - 1900;
+    pTimeInfo->tm_wday = dayOfWeekFromDays((int32_t)days);
+    pTimeInfo->tm_yday = (int)(days - daysFromCivil(year, 1, 1));
+    pTimeInfo->tm_isdst = 0;
 }
 
 // [static]
 time_t LocalTime::tmToTime(struct tm *pTimeInfo) {
-#ifndef UNITTEST
-    // Particle C standard library does not implement timegm, however the C
-    // library is always set to UTC, so this works
-    return mktime(pTimeInfo);
-#else
-    return timegm(pTimeInfo);        
-#endif
+    // Carry months into years first; daysFromCivil handles out of range days itself
+    int year = pTimeInfo->tm_year + 1900 + pTimeInfo->tm_mon / 12;
+    int month = pTimeInfo->tm_mon % 12;
+    if (month < 0) {
+        month += 12;
+        year--;
+    }
+
+    time_t result = (time_t)daysFromCivil(year, month + 1, pTimeInfo->tm_mday) * 86400
+        + (time_t)pTimeInfo->tm_hour * 3600 + (time_t)pTimeInfo->tm_min * 60 + pTimeInfo->tm_sec;
+
+    // Normalize the fields and fill in tm_wday and tm_yday, like mktime
+    timeToTm(result, pTimeInfo);
+    return result;
 }
 
 // [static]
@@ -682,17 +954,7 @@ int LocalTime::lastDayOfMonth(int year, int month) {
             return 31;
 
         case 2:
-            if ((year % 4) == 0) {
-                if ((year % 100) == 0) {
-                    return 28;
-                }
-                else {
-                    return 29;
-                }
-            }
-            else {
-                return 28;
-            }
+            return isLeapYear(year) ? 29 : 28;
 
         case 4:
         case 6:
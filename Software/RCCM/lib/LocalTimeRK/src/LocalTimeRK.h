@@ -4,6 +4,7 @@
 #include "Particle.h"
 
 #include <time.h>
+#include <type_traits>
 
 /**
  * @brief Container for holding an hour minute second time value
@@ -13,12 +14,7 @@ public:
     /**
      * @brief Default constructor. Sets time to 00:00:00
      */
-    LocalTimeHMS();
-
-    /**
-     * @brief Destructor
-     */
-    virtual ~LocalTimeHMS();
+    constexpr LocalTimeHMS() {};
 
     /**
      * @brief Constructs the object from a time string
@@ -34,12 +30,12 @@ public:
      * and second are always positive (0-59). The hour could also be > 24 when used
      * as a timezone offset.
      */
-    LocalTimeHMS(const char *str);
+    constexpr LocalTimeHMS(const char *str) { parse(str); };
 
     /**
      * @brief Sets the hour, minute, and second to 0
      */
-    void clear();
+    constexpr void clear() { hour = minute = second = 0; };
 
     /**
      * @brief Parse a "H:MM:SS" string
@@ -53,8 +49,63 @@ public:
      * - H        (examples: "2")
      * 
      * Hours are always 0 - 23 (24-hour clock). Can also be a negative hour -1 to -23.
+     * 
+     * Parsing stops at the first character that does not fit the format, so the time
+     * can be followed by other text (for example "5EDT" or "2:00:00,M11.1.0").
      */
-    void parse(const char *str);
+    constexpr void parse(const char *str) {
+        clear();
+
+        int value = 0;
+        str = parseInt(str, value);
+        if (!str) {
+            return;
+        }
+        hour = (int8_t) value;
+
+        if (*str != ':' || (str = parseInt(str + 1, value)) == nullptr) {
+            return;
+        }
+        minute = (int8_t) value;
+
+        if (*str != ':' || (str = parseInt(str + 1, value)) == nullptr) {
+            return;
+        }
+        second = (int8_t) value;
+    }
+
+    /**
+     * @brief Parses a decimal integer, like the %d conversion of sscanf
+     * 
+     * @param str String to parse. Leading spaces and a + or - sign are allowed.
+     * 
+     * @param value Filled in with the value (unchanged on failure)
+     * 
+     * @returns A pointer to the first character after the number, or nullptr if there are no digits.
+     */
+    static constexpr const char *parseInt(const char *str, int &value) {
+        if (!str) {
+            return nullptr;
+        }
+        while(*str == ' ' || (*str >= '\t' && *str <= '\r')) {
+            str++;
+        }
+        bool negative = (*str == '-');
+        if (*str == '-' || *str == '+') {
+            str++;
+        }
+        if (*str < '0' || *str > '9') {
+            return nullptr;
+        }
+        int result = 0;
+        for(; *str >= '0' && *str <= '9'; str++) {
+            if (result < 100000) {
+                result = result * 10 + (*str - '0');
+            }
+        }
+        value = negative ? -result : result;
+        return str;
+    }
 
     /**
      * @brief Turns the parsed data into a normalized string of the form: "H:MM:SS" (24-hour clock)
@@ -64,7 +115,14 @@ public:
     /**
      * @brief Convert hour minute second into a number of seconds (simple multiplication and addition)
      */
-    int toSeconds() const;
+    constexpr int toSeconds() const {
+        if (hour < 0) {
+            return - (((int)hour) * -3600 + ((int)minute) * 60 + (int) second);
+        }
+        else {
+            return ((int)hour) * 3600 + ((int)minute) * 60 + (int) second;
+        }
+    }
 
     /**
      * @brief Sets the hour, minute, and second fields from a struct tm
@@ -103,7 +161,7 @@ public:
     /**
      * @brief Special version of LocalTimeHMS that does not set the HMS
      */
-    LocalTimeIgnoreHMS() {
+    constexpr LocalTimeIgnoreHMS() {
         ignore = true;
     }
 };
@@ -120,12 +178,7 @@ public:
     /**
      * @brief Default contructor
      */
-    LocalTimeChange();
-
-    /**
-     * @brief Destructor
-     */
-    virtual ~LocalTimeChange();
+    constexpr LocalTimeChange() {};
 
     /**
      * @brief Constructs a time change object with a string format (calls parse())
@@ -135,12 +188,15 @@ public:
      * The time change string is part of the POSIX timezone specification and looks something
      * like "M3.2.0/2:00:00". 
      */
-    LocalTimeChange(const char *str);
+    constexpr LocalTimeChange(const char *str) { parse(str); };
 
     /**
      * @brief Clears all values
      */
-    void clear();
+    constexpr void clear() {
+        month = week = dayOfWeek = valid = 0;
+        hms.clear();
+    }
 
     /**
      * @brief Parses a time change string
@@ -157,8 +213,35 @@ public:
      * 
      * Setting the week to 5 essentially means the last week of the month. If the month does
      * not have a fifth week for that day of the week, then the fourth is used instead.
-     */
-    void parse(const char *str);
+     * 
+     * The string ends at a null or a comma, so it can point into a full timezone string.
+     */
+    constexpr void parse(const char *str) {
+        clear();
+
+        // M3.2.0/2:00:00
+        if (!str || str[0] != 'M') {
+            return;
+        }
+
+        int values[3] = {};
+        const char *cp = LocalTimeHMS::parseInt(str + 1, values[0]);
+        if (!cp || *cp != '.' || (cp = LocalTimeHMS::parseInt(cp + 1, values[1])) == nullptr ||
+            *cp != '.' || (cp = LocalTimeHMS::parseInt(cp + 1, values[2])) == nullptr) {
+            return;
+        }
+        month = (int8_t) values[0];
+        week = (int8_t) values[1];
+        dayOfWeek = (int8_t) values[2];
+
+        while(*cp && *cp != ',' && *cp != '/') {
+            cp++;
+        }
+        if (*cp == '/') {
+            hms.parse(cp + 1);
+        }
+        valid = true;
+    }
 
     /**
      * @brief Turns the parsed data into a normalized string like "M3.2.0/2:00:00"
@@ -182,6 +265,21 @@ public:
     LocalTimeHMS hms;       //!< Local time when timezone change occurs
 };
 
+/**
+ * @brief The UTC time change instants for one year of a LocalTimePosixTimezone
+ * 
+ * Calculated by LocalTimePosixTimezone::getTransitions() the first time a time in that year
+ * is converted, then reused until a time in a different year is converted.
+ */
+struct LocalTimeTransitions {
+    time_t yearStart = 0;               //!< January 1 00:00:00 UTC of the cached year
+    time_t yearEnd = 0;                 //!< January 1 00:00:00 UTC of the following year. Equal to yearStart if nothing is cached.
+    time_t dstStart = 0;                //!< When DST starts in this year, Unix time, UTC
+    struct tm dstStartTimeInfo = {};    //!< The struct tm that corresponds to dstStart (UTC)
+    time_t standardStart = 0;           //!< When standard time starts in this year, Unix time, UTC
+    struct tm standardStartTimeInfo = {}; //!< The struct tm that corresponds to standardStart (UTC)
+};
+
 /**
  * @brief Parses a Posix timezone string into its component parts
  * 
@@ -207,26 +305,41 @@ public:
 class LocalTimePosixTimezone {
 public:
     /**
-     * @brief Default constructor (no timezone set)
+     * @brief Maximum timezone name length, including the null terminator
      */
-    LocalTimePosixTimezone();
+    static const size_t NAME_SIZE = 8;
 
     /**
-     * @brief Destructor
+     * @brief Default constructor (no timezone set)
      */
-    virtual ~LocalTimePosixTimezone();
+    constexpr LocalTimePosixTimezone() {};
 
     /**
      * @brief Constructs the object with a specified timezone configuration
      * 
-     * Calls parse() internally.
+     * Calls parse() internally. Since parse() is constexpr, a timezone that is known at 
+     * compile time can be checked at compile time:
+     * 
+     * ```
+     * static constexpr LocalTimePosixTimezone tz("EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00");
+     * static_assert(tz.isValid(), "bad timezone");
+     * ```
      */
-    LocalTimePosixTimezone(const char *str);
+    constexpr LocalTimePosixTimezone(const char *str) { parse(str); };
 
     /**
      * @brief Clears the timezone setting in this object
      */
-    void clear();
+    constexpr void clear() {
+        invalidateTransitions();
+        dstStart.clear();
+        dstName[0] = 0;
+        dstHMS.clear();
+        standardStart.clear();
+        standardName[0] = 0;
+        standardHMS.clear();
+        valid = false;
+    }
 
     /**
      * @brief Parses the timezone configuration string
@@ -236,33 +349,170 @@ public:
      * If the string is not valid this function returns false and the valid flag will
      * be clear. You can call isValid() to check the validity at any time (such as
      * if you are using the constructor with a string that does not return a boolean).
-     */
-    bool parse(const char *str);
+     * 
+     * Names can be alphabetic ("EST") or quoted ("<+0530>", stored without the brackets),
+     * and must be shorter than NAME_SIZE. The string is parsed in place; nothing is copied
+     * or allocated.
+     */
+    constexpr bool parse(const char *str) {
+        clear();
+        if (!str) {
+            return false;
+        }
+
+        const char *cp = str;
+        for(size_t ii = 0; ii < 3; ii++) {
+            // Empty fields are skipped, like strtok
+            while(*cp == ',') {
+                cp++;
+            }
+            if (!*cp) {
+                break;
+            }
+
+            switch(ii) {
+                case 0: {
+                    // Timezone specifier: std offset [dst [offset]]
+                    cp = parseName(cp, standardName);
+                    if (!cp) {
+                        clear();
+                        return false;
+                    }
+                    valid = true;
+
+                    if (*cp && *cp != ',') {
+                        standardHMS.parse(cp);
+                        while(*cp && *cp != ',' && *cp != '<' && *cp < 'A') {
+                            cp++;
+                        }
+
+                        if (*cp && *cp != ',') {
+                            cp = parseName(cp, dstName);
+                            if (!cp) {
+                                clear();
+                                return false;
+                            }
+
+                            if (*cp && *cp != ',') {
+                                dstHMS.parse(cp);
+                            }
+                            else {
+                                // Default dst is 1 hour later
+                                dstHMS = standardHMS;
+                                dstHMS.hour--;
+                            }
+                        }
+                    }
+                    break;
+                }
+                case 1: {
+                    dstStart.parse(cp);
+                    break;
+                }
+                case 2: {
+                    standardStart.parse(cp);
+                    break;
+                }
+            }
+
+            // Skip to the next field
+            while(*cp && *cp != ',') {
+                cp++;
+            }
+        }
+
+        if (dstStart.valid && !standardStart.valid) {
+            // If DST start is specified, standard start must also be specified
+            dstStart.clear();
+            valid = false;
+        }
+
+        return valid;
+    }
 
     /**
      * @brief Returns true if this timezone configuration has daylight saving
      */
-    bool hasDST() const { return dstStart.valid; };
+    constexpr bool hasDST() const { return dstStart.valid; };
 
     /**
      * @brief Returns true if this timezone configuration has been set and appears valid
      */
-    bool isValid() const { return valid; };
+    constexpr bool isValid() const { return valid; };
 
     /**
      * @brief Returns true if this timezone configuration is UTC
      */
-    bool isZ() const { return !valid || (!hasDST() && standardHMS.toSeconds() == 0); };
+    constexpr bool isZ() const { return !valid || (!hasDST() && standardHMS.toSeconds() == 0); };
+
+    /**
+     * @brief Returns when DST and standard time start in the year (UTC) that contains time
+     * 
+     * @param time The time (UTC) to look up
+     * 
+     * The result is cached, so only the first time in a given year runs LocalTimeChange::calculate().
+     * Only meaningful if hasDST() is true.
+     */
+    const LocalTimeTransitions &getTransitions(time_t time) const;
+
+    /**
+     * @brief Discards the cached time changes
+     * 
+     * parse() and clear() do this for you. Only needed if you modify the rules or offsets below directly.
+     */
+    constexpr void invalidateTransitions() const { transitions.yearStart = transitions.yearEnd = 0; };
 
-    String dstName; //!< Daylight saving timezone name (empty string if no DST)
+    char dstName[NAME_SIZE] = {}; //!< Daylight saving timezone name (empty string if no DST)
     LocalTimeHMS dstHMS; //!< Daylight saving time shift (relative to UTC)
-    String standardName; //!< Standard time timezone name
+    char standardName[NAME_SIZE] = {}; //!< Standard time timezone name
     LocalTimeHMS standardHMS; //!< Standard time shift (relative to UTC). Note that this is positive in the United States, which is kind of backwards.
     LocalTimeChange dstStart; //!< Rule for when DST starts
     LocalTimeChange standardStart; //!< Rule for when standard time starts. 
     bool valid = false; //!< true if the configuration looks valid
+
+protected:
+    /**
+     * @brief Copies a timezone name into name
+     * 
+     * @returns A pointer to the character after the name, or nullptr if the name is too long or a quoted name is not closed
+     * 
+     * An unquoted name runs until a character before 'A' (a digit, sign, comma, etc.). A quoted
+     * name like "<+0530>" runs until the closing '>'.
+     */
+    static constexpr const char *parseName(const char *cp, char (&name)[NAME_SIZE]) {
+        size_t len = 0;
+        if (*cp == '<') {
+            for(cp++; *cp != '>'; cp++) {
+                if (!*cp || len >= NAME_SIZE - 1) {
+                    return nullptr;
+                }
+                name[len++] = *cp;
+            }
+            cp++;
+        }
+        else {
+            for(; *cp >= 'A'; cp++) {
+                if (len >= NAME_SIZE - 1) {
+                    return nullptr;
+                }
+                name[len++] = *cp;
+            }
+        }
+        name[len] = 0;
+        return cp;
+    }
+
+    /**
+     * @brief Time changes for the most recently converted year (see getTransitions())
+     * 
+     * Copied along with the rest of the configuration, so a converter made from an already
+     * used configuration starts out with a warm cache.
+     */
+    mutable LocalTimeTransitions transitions;
 };
 
+static_assert(std::is_trivially_copyable<LocalTimePosixTimezone>::value, "LocalTimePosixTimezone is copied by value into every converter; keep it trivially copyable");
+
 /**
  * @brief Container for a local time value with accessors similar to the Wiring Time class
  * 
@@ -354,7 +604,7 @@ public:
      * time after falling back. The toUTC() function returns the second one
      * that occurs in standard time. 
      */
-    time_t toUTC(LocalTimePosixTimezone config) const;
+    time_t toUTC(const LocalTimePosixTimezone &config) const;
 
     /**
      * @brief Converts time from ISO-8601 format, ignoring the timezone 
@@ -386,6 +636,8 @@ public:
 
 };
 
+class LocalTimeFormat;
+
 /**
  * @brief Perform time conversions. This is the main class you will need.
  */
@@ -410,7 +662,7 @@ public:
      * If you do not use withConfig() the global default set in the LocalTime class is used.
      * If neither are set, the local time is UTC (with no DST).
      */
-    LocalTimeConvert &withConfig(LocalTimePosixTimezone config) { this->config = config; return *this; };
+    LocalTimeConvert &withConfig(const LocalTimePosixTimezone &config) { this->config = config; return *this; };
 
     /**
      * @brief Sets the UTC time to begin conversion from 
@@ -661,6 +913,71 @@ public:
      */
     String format(const char* formatSpec);
 
+    /**
+     * @brief Formats the local time into a buffer using a precompiled format, without using the heap
+     * 
+     * @param fmt The precompiled format (see LocalTimeFormat)
+     * 
+     * @param buf Buffer to write to. Always null terminated if bufSize > 0.
+     * 
+     * @param bufSize Size of buf in bytes. Output that does not fit is truncated.
+     * 
+     * @returns The number of characters written, not including the null terminator.
+     */
+    size_t format(const LocalTimeFormat &fmt, char *buf, size_t bufSize) const;
+
+    /**
+     * @brief Returns the current offset from UTC in seconds, positive east of UTC
+     * 
+     * For example, -14400 for EDT (-04:00). This is the opposite sign of the
+     * offsets in LocalTimePosixTimezone.
+     */
+    int utcOffset() const { return -(isDST() ? config.dstHMS.toSeconds() : config.standardHMS.toSeconds()); };
+
+    /**
+     * @brief Converts an array of UTC times to local time in one call
+     *
+     * @param times The times to convert, Unix time, UTC. They do not need to be sorted, but
+     * runs of times in the same year (a day of log records, for example) are the fast path.
+     *
+     * @param count The number of elements in times and localTimeValues
+     *
+     * @param localTimeValues Filled in with the local time for each element of times. These
+     * are the same values convert() would set in localTimeValue.
+     *
+     * The time changes are looked up once per run of times in the same year, and the offset
+     * and calendar arithmetic is done branch-free over blocks of BATCH_SIZE times so the
+     * compiler can vectorize it. Only config is used; time, localTimeValue, and the other
+     * members are not changed.
+     */
+    void convertBatch(const time_t *times, size_t count, LocalTimeValue *localTimeValues);
+
+    /**
+     * @brief Formats an array of UTC times as local time strings in one call
+     *
+     * @param times The times to convert, Unix time, UTC
+     *
+     * @param count The number of elements in times
+     *
+     * @param fmt The precompiled format (see LocalTimeFormat)
+     *
+     * @param buf count strings, each stride bytes after the previous one. Each is null terminated;
+     * output that does not fit in stride bytes is truncated.
+     *
+     * @param stride Size of each string in buf in bytes, for example 26 for TIME_FORMAT_ISO8601_FULL
+     *
+     * Same output as format(const LocalTimeFormat &, char *, size_t) after converting each time,
+     * with the conversion done as in convertBatch().
+     */
+    void formatBatch(const time_t *times, size_t count, const LocalTimeFormat &fmt, char *buf, size_t stride);
+
+    /**
+     * @brief Number of times convertBatch() and formatBatch() process per block
+     *
+     * The working arrays for a block are on the stack.
+     */
+    static const size_t BATCH_SIZE = 16;
+
     /**
      * @brief Returns the abbreviated time zone name for the current time
      * 
@@ -737,9 +1054,145 @@ public:
      * @brief The struct tm that corresponds to standardStart (UTC)
      */
     struct tm standardStartTimeInfo;
+
+protected:
+    /**
+     * @brief Converts up to BATCH_SIZE times from the start of times that are in the same year
+     *
+     * @param dst Set to whether each converted time is in daylight saving time
+     *
+     * @returns The number of times converted, at least 1 if count > 0
+     */
+    size_t convertBlock(const time_t *times, size_t count, LocalTimeValue *localTimeValues, bool *dst);
 };
 
 
+/**
+ * @brief A strftime-style format specification compiled into a list of operations
+ * 
+ * Compile a format once, typically as a global or static, and use it with 
+ * LocalTimeConvert::format(const LocalTimeFormat &, char *, size_t) to format
+ * times into a buffer with no strftime, no String, and no heap allocation.
+ * 
+ * ```
+ * static const LocalTimeFormat isoFormat(TIME_FORMAT_ISO8601_FULL);
+ * char buf[32];
+ * converter.format(isoFormat, buf, sizeof(buf));
+ * ```
+ * 
+ * Supported conversions (English only): %a %A %b %B %d %e %F %H %I %j %m %M %p %S %T %y %Y %z %Z %%
+ * 
+ * As with LocalTimeConvert::format(), %z outputs "-04:00" style offsets (or "Z" for UTC)
+ * and %Z outputs the timezone abbreviation such as "EDT". TIME_FORMAT_DEFAULT is 
+ * accepted and produces the asctime() layout used by Time.timeStr().
+ */
+class LocalTimeFormat {
+public:
+    /**
+     * @brief Maximum number of operations after compiling. %T and %F count as 3 and 5.
+     */
+    static const size_t MAX_OPS = 24;
+
+    /**
+     * @brief Maximum total length of the literal text in a format specification
+     */
+    static const size_t MAX_LITERAL = 24;
+
+    /**
+     * @brief Default constructor. The format is empty and isValid() is false until compile() is called.
+     */
+    LocalTimeFormat() {};
+
+    /**
+     * @brief Constructs the object and compiles formatSpec (see compile())
+     */
+    LocalTimeFormat(const char *formatSpec) { compile(formatSpec); };
+
+    /**
+     * @brief Compiles a format specification
+     * 
+     * @param formatSpec strftime-style format, TIME_FORMAT_DEFAULT, or TIME_FORMAT_ISO8601_FULL
+     * 
+     * @returns true on success. Returns false if the specification uses an unsupported
+     * conversion or does not fit in MAX_OPS / MAX_LITERAL.
+     */
+    bool compile(const char *formatSpec);
+
+    /**
+     * @brief Returns true if compile() succeeded
+     */
+    bool isValid() const { return valid; };
+
+    /**
+     * @brief Formats a broken-down time into a buffer
+     * 
+     * @param timeInfo The local time to format
+     * 
+     * @param utcOffset Offset from UTC in seconds, positive east of UTC, for %z
+     * 
+     * @param zulu If true, %z outputs "Z" instead of the offset
+     * 
+     * @param zoneName Timezone abbreviation for %Z (can be NULL)
+     * 
+     * @param buf Buffer to write to. Always null terminated if bufSize > 0.
+     * 
+     * @param bufSize Size of buf in bytes. Output that does not fit is truncated.
+     * 
+     * @returns The number of characters written, not including the null terminator.
+     */
+    size_t format(const struct tm &timeInfo, int utcOffset, bool zulu, const char *zoneName, char *buf, size_t bufSize) const;
+
+protected:
+    /**
+     * @brief Compiled operations
+     */
+    enum class Op : uint8_t {
+        LITERAL,        //!< arg is offset into literal, len is the length
+        YEAR,           //!< %Y
+        YEAR_2,         //!< %y
+        MONTH,          //!< %m
+        MONTH_ABBR,     //!< %b
+        MONTH_FULL,     //!< %B
+        DAY,            //!< %d
+        DAY_SPACE,      //!< %e
+        DAY_OF_YEAR,    //!< %j
+        WEEKDAY_ABBR,   //!< %a
+        WEEKDAY_FULL,   //!< %A
+        HOUR,           //!< %H
+        HOUR_12,        //!< %I
+        AM_PM,          //!< %p
+        MINUTE,         //!< %M
+        SECOND,         //!< %S
+        UTC_OFFSET,     //!< %z
+        ZONE_NAME,      //!< %Z
+    };
+
+    /**
+     * @brief One compiled operation
+     */
+    struct Step {
+        Op op;
+        uint8_t arg;
+        uint8_t len;
+    };
+
+    /**
+     * @brief Appends an operation. Returns false if there is no room.
+     */
+    bool addStep(Op op, uint8_t arg = 0, uint8_t len = 0);
+
+    /**
+     * @brief Appends literal text, merging with a preceding literal. Returns false if there is no room.
+     */
+    bool addLiteral(const char *str, size_t len);
+
+    Step steps[MAX_OPS];            //!< Compiled operations
+    uint8_t numSteps = 0;           //!< Number of valid entries in steps
+    char literal[MAX_LITERAL];      //!< Literal text referenced by LITERAL steps
+    uint8_t literalLen = 0;         //!< Bytes used in literal
+    bool valid = false;             //!< true if compile() succeeded
+};
+
 /**
  * @brief Global time settings
  */
@@ -753,7 +1206,7 @@ public:
     /**
      * @brief Sets the default global timezone configuration
      */
-    LocalTime &withConfig(LocalTimePosixTimezone config) { this->config = config; return *this; };
+    LocalTime &withConfig(const LocalTimePosixTimezone &config) { this->config = config; return *this; };
 
     /**
      * @brief Gets the default global timezone configuration
@@ -778,9 +1231,10 @@ public:
      * - tm_year year since 1900. Note: 2021 is 121, not 2021 or 21! Beware!
      * - tm_wday Day of week (Sunday = 0, Monday = 1, Tuesday = 2, ..., Saturday = 6)
      * - tm_yday Day of year (0 - 365). Note: zero-based, January 1 = 0
-     * - tm_isdst Daylight saving flag, always 0 on Particle devices
+     * - tm_isdst Daylight saving flag, always 0
      * 
-     * This basically a wrapper around localtime_r or gmtime_r.
+     * Equivalent to gmtime_r, but calculated directly with civilFromDays() so it does not depend
+     * on the C library timezone and never takes a lock.
      */
     static void timeToTm(time_t time, struct tm *pTimeInfo);
 
@@ -793,7 +1247,11 @@ public:
      * however tm_wday and tm_yday are filled in with the correct values based on
      * the date, which is why pTimeInfo is not const.
      * 
-     * This basically a wrapper around mktime or timegm.
+     * Out of range values (tm_mday = 32, tm_hour = -1, etc.) are normalized, the same as timegm,
+     * and pTimeInfo is updated with the normalized values.
+     * 
+     * Equivalent to timegm, but calculated directly with daysFromCivil() so it does not depend
+     * on the C library timezone and never takes a lock.
      */
     static time_t tmToTime(struct tm *pTimeInfo);
 
@@ -851,6 +1309,66 @@ public:
      */
     static int lastDayOfMonth(int year, int month);
 
+    /**
+     * @brief Returns true if year is a leap year in the Gregorian calendar
+     * 
+     * @param year The year (note, actual year like 2021, not the value of tm_year).
+     */
+    static constexpr bool isLeapYear(int year) {
+        return (year % 4) == 0 && ((year % 100) != 0 || (year % 400) == 0);
+    }
+
+    /**
+     * @brief Returns the number of days from January 1, 1970 to the specified date
+     * 
+     * @param year The year (note, actual year like 2021, not the value of tm_year).
+     * 
+     * @param month The month (1 - 12)
+     * 
+     * @param day The day of the month (1 - 31). Out of range values are fine and
+     * simply count forward or backward from the first of the month.
+     * 
+     * Dates before 1970 return a negative number. This is Howard Hinnant's days_from_civil
+     * algorithm: a handful of integer operations with no loops or tables.
+     */
+    static constexpr int32_t daysFromCivil(int year, int month, int day) {
+        year -= (month <= 2);
+        int32_t era = (year >= 0 ? year : year - 399) / 400;
+        int32_t yearOfEra = year - era * 400;                                           // 0 - 399
+        int32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1; // starting March 1
+        int32_t dayOfEra = yearOfEra * 365 + yearOfEra/4 - yearOfEra/100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;                                        // 0000-03-01 to 1970-01-01
+    }
+
+    /**
+     * @brief Converts a number of days from January 1, 1970 into a year, month (1 - 12), and day of month (1 - 31)
+     * 
+     * @param days Days from January 1, 1970. Can be negative.
+     * 
+     * This is the inverse of daysFromCivil().
+     */
+    static constexpr void civilFromDays(int32_t days, int &year, int &month, int &day) {
+        days += 719468;
+        int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+        int32_t dayOfEra = days - era * 146097;                                                     // 0 - 146096
+        int32_t yearOfEra = (dayOfEra - dayOfEra/1460 + dayOfEra/36524 - dayOfEra/146096) / 365;   // 0 - 399
+        int32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra/4 - yearOfEra/100);             // 0 - 365, starting March 1
+        int32_t mp = (5 * dayOfYear + 2) / 153;                                                     // 0 - 11, starting March
+
+        day = dayOfYear - (153 * mp + 2) / 5 + 1;
+        month = mp < 10 ? mp + 3 : mp - 9;
+        year = yearOfEra + era * 400 + (month <= 2);
+    }
+
+    /**
+     * @brief Returns the day of week (0 - 6, 0 = Sunday) for a number of days from January 1, 1970
+     * 
+     * January 1, 1970 was a Thursday.
+     */
+    static constexpr int dayOfWeekFromDays(int32_t days) {
+        return (days >= -4) ? ((days + 4) % 7) : ((days + 5) % 7 + 6);
+    }
+
 protected:
     /**
      * @brief This class is a singleton and should not be manually allocated
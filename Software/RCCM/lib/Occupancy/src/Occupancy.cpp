@@ -0,0 +1,55 @@
+
+// INCLUDEs
+#include "Occupancy.h"
+
+
+
+
+// CONSTRUCTOR
+Occupancy::Occupancy(uint16_t pin) : pin(pin), edgeCount(0), activeSeconds(0), firstEdgeTime(0), lastEdgeTime(0) {
+
+}
+
+
+// DESTRUCTOR
+Occupancy::~Occupancy() {
+    detachInterrupt(pin);
+}
+
+
+// 
+bool Occupancy::begin(void) {
+    return attachInterrupt(pin, &Occupancy::isrEdge, this, RISING);
+}
+
+
+// Snapshot & reset the counters.  Interrupts are held off only for the copy.
+void Occupancy::takeInterval(struct intervalSummary &summary) {
+    ATOMIC_BLOCK() {
+        summary.edgeCount       = edgeCount;
+        summary.activeSeconds   = activeSeconds;
+        summary.firstEdgeTime   = firstEdgeTime;
+        summary.lastEdgeTime    = lastEdgeTime;
+
+        edgeCount       = 0;
+        activeSeconds   = 0;
+        firstEdgeTime   = 0;
+        lastEdgeTime    = 0;
+    }
+}
+
+
+// ISR - O(1); no allocation, no publishing, no loops.
+void Occupancy::isrEdge(void) {
+    time_t now = Time.now();
+
+    if (edgeCount == 0) {
+        firstEdgeTime = now;
+    }
+    if (now != lastEdgeTime) {
+        activeSeconds++;
+    }
+
+    lastEdgeTime = now;
+    edgeCount++;
+}
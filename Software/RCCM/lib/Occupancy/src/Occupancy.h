@@ -0,0 +1,39 @@
+#ifndef Occupancy_h
+#define Occupancy_h
+
+// 
+#include <Particle.h>
+
+
+// PIR motion capture.  The ISR only increments a counter and stamps the edge time, so its cost is
+// constant no matter how hard the sensor chatters; all aggregation happens in takeInterval().
+class Occupancy {
+    public:
+        // PUBLIC - Class Variables
+        struct intervalSummary {
+            uint32_t    edgeCount;          // Rising edges seen during the interval
+            uint32_t    activeSeconds;      // Distinct seconds with at least one edge
+            time_t      firstEdgeTime;      // 0 if no edges
+            time_t      lastEdgeTime;       // 0 if no edges
+        };
+
+        // PUBLIC - Class Functions
+        Occupancy(uint16_t pin);
+        ~Occupancy();
+        bool begin(void);
+        void takeInterval(struct intervalSummary &summary);
+
+    private:
+        // PRIVATE - Class Variables
+        uint16_t            pin;
+        volatile uint32_t   edgeCount;
+        volatile uint32_t   activeSeconds;
+        volatile time_t     firstEdgeTime;
+        volatile time_t     lastEdgeTime;
+
+        // PRIVATE - Class Functions
+        void isrEdge(void);
+
+};
+
+#endif
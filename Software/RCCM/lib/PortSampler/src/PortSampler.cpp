@@ -0,0 +1,144 @@
+
+// INCLUDEs
+#include "PortSampler.h"
+
+
+
+
+// CONSTRUCTOR
+PortSampler::PortSampler(uint16_t pin, uint32_t samplePeriodUs, uint32_t blockPeriodMs, uint16_t threshold) :
+    pin(pin), samplePeriodUs(samplePeriodUs), blockPeriodMs(blockPeriodMs), threshold(threshold), lastBlockMs(0), captured(false), nextSampleUs(0), filled(0) {
+
+    resetInterval();
+}
+
+
+// DESTRUCTOR
+PortSampler::~PortSampler() {
+
+}
+
+
+// 
+void PortSampler::begin(void) {
+    // Analog input; the pull-up would bias the sensor reading.
+    pinMode(pin, INPUT);
+}
+
+
+// Call from loop(); takes at most one sample per call.  A block starts each block period and is reduced
+// on the call that fills it.
+void PortSampler::process(void) {
+    uint32_t now = micros();
+
+    if (filled == 0) {
+        if ((captured == true) && ((millis() - lastBlockMs) < blockPeriodMs)) {
+            return;
+        }
+        lastBlockMs = millis();
+        captured = true;
+        nextSampleUs = now;
+    }
+
+    if ((int32_t)(now - nextSampleUs) < 0) {
+        return;
+    }
+
+    block[filled++] = analogRead(pin);
+
+    // Next slot on the grid from the block start, so analogRead() & loop() jitter do not accumulate.
+    nextSampleUs += (((now - nextSampleUs) / samplePeriodUs) + 1) * samplePeriodUs;
+
+    if (filled == PORT_SAMPLER_BLOCK_SIZE) {
+        foldBlock();
+        filled = 0;
+    }
+}
+
+
+// Reduce the full block into the interval.
+void PortSampler::foldBlock(void) {
+    struct blockFeatures features;
+
+    reduceBlock(block, PORT_SAMPLER_BLOCK_SIZE, threshold, features);
+
+    interval.blocks++;
+    if (features.max > interval.peak) {
+        interval.peak = features.max;
+    }
+    if (features.rms > interval.rmsMax) {
+        interval.rmsMax = features.rms;
+    }
+    if (features.overRun > interval.overRunMax) {
+        interval.overRunMax = features.overRun;
+    }
+    interval.crossings      += features.crossings;
+    interval.overThreshold  += features.overThreshold;
+}
+
+
+// 
+void PortSampler::takeInterval(struct intervalSummary &summary) {
+    summary = interval;
+    resetInterval();
+}
+
+
+// Reduction kernel.  Straight-line loops over a flat array with no early exits or data dependent
+// branches, so the compiler is free to unroll / vectorize them.
+void PortSampler::reduceBlock(const uint16_t *samples, size_t count, uint16_t threshold, struct blockFeatures &features) {
+    uint32_t sum        = 0;
+    uint64_t sumSq      = 0;
+    uint16_t min        = UINT16_MAX;
+    uint16_t max        = 0;
+    uint32_t over       = 0;
+    uint32_t run        = 0;
+    uint32_t longestRun = 0;
+    uint32_t crossings  = 0;
+
+    if (count == 0) {
+        features = {};
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = samples[i];
+        sum     += v;
+        sumSq   += v * v;
+        min     = (samples[i] < min) ? samples[i] : min;
+        max     = (samples[i] > max) ? samples[i] : max;
+        over    += (samples[i] >= threshold);
+    }
+
+    for (size_t i = 1; i < count; i++) {
+        crossings += ((samples[i] >= threshold) != (samples[i - 1] >= threshold));
+    }
+
+    // Run length as a select, not a branch.
+    for (size_t i = 0; i < count; i++) {
+        run         = (samples[i] >= threshold) ? (run + 1) : 0;
+        longestRun  = (run > longestRun) ? run : longestRun;
+    }
+
+    double mean     = (double)sum / count;
+    double variance = ((double)sumSq / count) - (mean * mean);
+
+    features.min            = min;
+    features.max            = max;
+    features.mean           = mean;
+    features.rms            = (variance > 0.0) ? sqrt(variance) : 0.0;
+    features.crossings      = crossings;
+    features.overThreshold  = over;
+    features.overRun        = longestRun;
+}
+
+
+// 
+void PortSampler::resetInterval(void) {
+    interval.blocks         = 0;
+    interval.peak           = 0;
+    interval.rmsMax         = 0.0;
+    interval.crossings      = 0;
+    interval.overThreshold  = 0;
+    interval.overRunMax     = 0;
+}
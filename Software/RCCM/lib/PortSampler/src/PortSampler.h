@@ -0,0 +1,64 @@
+#ifndef PortSampler_h
+#define PortSampler_h
+
+// 
+#include <Particle.h>
+
+
+#define PORT_SAMPLER_BLOCK_SIZE     128     // Samples per captured block
+
+
+// Block capture for an external analog port.  A block is filled in the background, one sample per process()
+// call at a fixed sample period, into a static buffer; once full it is reduced to a handful of features and
+// only the features are kept.  Nothing waits: a sample slot missed while loop() was busy is skipped, not
+// caught up, so the sample period is a minimum.
+class PortSampler {
+    public:
+        // PUBLIC - Class Variables
+        struct blockFeatures {
+            uint16_t    min;
+            uint16_t    max;
+            double      mean;
+            double      rms;                // AC RMS about the block mean (ADC counts)
+            uint32_t    crossings;          // Transitions across the threshold level
+            uint32_t    overThreshold;      // Samples at or above the threshold level
+            uint32_t    overRun;            // Longest run of consecutive samples at or above the threshold level
+        };
+
+        struct intervalSummary {
+            uint32_t    blocks;
+            uint16_t    peak;               // Highest sample seen
+            double      rmsMax;             // Largest block RMS
+            uint32_t    crossings;
+            uint32_t    overThreshold;
+            uint32_t    overRunMax;         // Longest overRun of any block
+        };
+
+        // PUBLIC - Class Functions
+        PortSampler(uint16_t pin, uint32_t samplePeriodUs, uint32_t blockPeriodMs, uint16_t threshold);
+        ~PortSampler();
+        void begin(void);
+        void process(void);
+        void takeInterval(struct intervalSummary &summary);
+        static void reduceBlock(const uint16_t *samples, size_t count, uint16_t threshold, struct blockFeatures &features);
+
+    private:
+        // PRIVATE - Class Variables
+        uint16_t    pin;
+        uint32_t    samplePeriodUs;
+        uint32_t    blockPeriodMs;
+        uint16_t    threshold;
+        uint32_t    lastBlockMs;
+        bool        captured;
+        uint32_t    nextSampleUs;
+        size_t      filled;                 // Samples in block; 0 = waiting for the block period
+        uint16_t    block[PORT_SAMPLER_BLOCK_SIZE];
+        struct intervalSummary interval;
+
+        // PRIVATE - Class Functions
+        void foldBlock(void);
+        void resetInterval(void);
+
+};
+
+#endif
@@ -0,0 +1,530 @@
+
+// INCLUDEs
+#include "TempProbes.h"
+
+
+// 1-Wire ROM commands
+#define ONEWIRE_MATCH_ROM           0x55
+#define ONEWIRE_SKIP_ROM            0xCC
+
+// DS18B20 function commands
+#define DS18B20_CONVERT_T           0x44
+#define DS18B20_READ_SCRATCHPAD     0xBE
+#define DS18B20_WRITE_SCRATCHPAD    0x4E
+
+// TH/TL register range (°C)
+#define DS18B20_ALARM_MIN           -55
+#define DS18B20_ALARM_MAX           125
+
+// Family codes with the DS18B20 scratchpad layout
+#define FAMILY_DS18B20              0x28
+#define FAMILY_DS1822               0x22
+
+#define DISCOVER_SEARCH_MAX         (TEMP_PROBES_MAX * 4)   // Bounds search() on a noisy bus
+
+
+// Whole degrees, rounded down & clamped to the TH/TL register range.
+static int8_t alarm_register(float degreesC) {
+    float whole = floorf(degreesC);
+
+    if (whole < DS18B20_ALARM_MIN) {
+        return DS18B20_ALARM_MIN;
+    }
+    if (whole > DS18B20_ALARM_MAX) {
+        return DS18B20_ALARM_MAX;
+    }
+    return (int8_t)whole;
+}
+
+
+// CONSTRUCTOR
+TempProbes::TempProbes(OneWire &bus, uint32_t periodMs) :
+    bus(bus), periodMs(periodMs), eepromAddr(-1), started(false), converting(false), fresh(false), lastConvertMs(0),
+    fullReadPeriodMs(0), lastFullReadMs(0), fullReadDone(false), alarmsSet(false), alarmLowC(0), alarmHighC(0),
+    alarmBits(0), newAlarmBits(0), alarmPendingBits(0), count(0) {
+
+    memset(alarmTH, 0, sizeof(alarmTH));
+    memset(alarmTL, 0, sizeof(alarmTL));
+    invalidateReadings();
+}
+
+
+// DESTRUCTOR
+TempProbes::~TempProbes() {
+
+}
+
+
+// Restore the persisted channels from eepromAddr, then add any new probes found on the bus.
+void TempProbes::begin(int eepromAddr) {
+    this->eepromAddr = eepromAddr;
+
+    load();
+    discover();
+}
+
+
+// Search the bus.  Probes not yet mapped get the next free channel, named "probeN" until configured.
+// Channels whose probe is missing are kept (and read as not valid).  Returns the number of probes found.
+uint8_t TempProbes::discover(void) {
+    uint8_t rom[8];
+    uint8_t found = 0;
+    bool    added = false;
+
+    bus.reset_search();
+    for (uint8_t search = 0; (search < DISCOVER_SEARCH_MAX) && (bus.search(rom) == 1); search++) {
+        if ((OneWire::crc8(rom, 7) != rom[7]) || ((rom[0] != FAMILY_DS18B20) && (rom[0] != FAMILY_DS1822))) {
+            continue;
+        }
+        found++;
+
+        if ((findRom(rom) >= 0) || (count >= TEMP_PROBES_MAX)) {
+            continue;
+        }
+
+        struct channel &newChannel = channels[count];
+        memcpy(newChannel.rom, rom, sizeof(rom));
+        for (unsigned n = count + 1; ; n++) {
+            snprintf(newChannel.name, sizeof(newChannel.name), "probe%u", n);
+            if (nameInUse(newChannel.name) == false) {
+                break;
+            }
+        }
+        newChannel.offset   = 0;
+        newChannel.gain     = 1;
+        count++;
+        added = true;
+
+        if (alarmsSet == true) {
+            alarmPendingBits |= (1UL << (count - 1));
+        }
+    }
+
+    if (added == true) {
+        invalidateReadings();
+        save();
+    }
+
+    return found;
+}
+
+
+// Call from loop(); issues the broadcast convert every periodMs, then reads every channel once it completes.
+// Pending TH/TL writes go out one channel per call, between conversions.
+void TempProbes::process(void) {
+    if (converting == true) {
+        if ((millis() - lastConvertMs) >= TEMP_PROBES_CONVERT_MS) {
+            readChannels((alarmsSet == false) || (fullReadDone == false) || ((lastConvertMs - lastFullReadMs) >= fullReadPeriodMs));
+            converting = false;
+        }
+        return;
+    }
+
+    if (alarmPendingBits != 0) {
+        programPendingAlarm();
+        return;
+    }
+
+    if ((count == 0) || ((started == true) && ((millis() - lastConvertMs) < periodMs))) {
+        return;
+    }
+
+    startConversion();
+}
+
+
+// Latest complete cycle.  Returns true if it completed since the previous call.
+bool TempProbes::takeReadings(struct readings &cycle) {
+    bool wasFresh = fresh;
+
+    cycle = latest;
+    fresh = false;
+
+    return wasFresh;
+}
+
+
+// Latest complete cycle, without taking it; the next takeReadings() still sees it as fresh.
+const struct TempProbes::readings &TempProbes::getReadings(void) const {
+    return latest;
+}
+
+
+//
+uint8_t TempProbes::channelCount(void) const {
+    return count;
+}
+
+
+//
+const struct TempProbes::channel &TempProbes::getChannel(uint8_t index) const {
+    return channels[index];
+}
+
+
+// Channel index by name; -1 if there is none.
+int TempProbes::findChannel(const char *name) const {
+    for (uint8_t i = 0; i < count; i++) {
+        if (strncmp(channels[i].name, name, sizeof(channels[i].name)) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+// Rename (name may be 0 to keep it) & calibrate a channel, then persist.  Rejects a duplicate name or
+// an implausible calibration.  (Written as in-range tests so NaN fails them.)
+bool TempProbes::configureChannel(uint8_t index, const char *name, float offset, float gain) {
+    if (index >= count) {
+        return false;
+    }
+    if ((name != 0) && ((name[0] == 0) || (strlen(name) >= TEMP_PROBES_NAME_SIZE) || ((findChannel(name) >= 0) && (findChannel(name) != index)))) {
+        return false;
+    }
+    if (!((offset >= -10) && (offset <= 10) && (gain >= 0.5f) && (gain <= 2))) {
+        return false;
+    }
+
+    if (name != 0) {
+        strcpy(channels[index].name, name);
+    }
+    channels[index].offset  = offset;
+    channels[index].gain    = gain;
+    save();
+
+    // TH/TL are in raw °C, so they move with the calibration.
+    if (alarmsSet == true) {
+        alarmPendingBits |= (1UL << index);
+    }
+
+    // Re-derive the held reading, so it reflects the new calibration before the next cycle.
+    if (latest.valid[index] == true) {
+        latest.temperatureC[index] = ((latest.raw[index] / 16.0f) * gain) + offset;
+    }
+
+    return true;
+}
+
+
+// Alarm thresholds (calibrated °C) for every probe's TH/TL.  Only stored here; process() writes the registers
+// between conversions.  Returns false (and changes nothing) for unusable thresholds.  (In-range tests so NaN
+// fails them.)
+bool TempProbes::programAlarms(float lowC, float highC) {
+    if (!((lowC >= DS18B20_ALARM_MIN) && (highC <= DS18B20_ALARM_MAX) && (lowC < highC))) {
+        return false;
+    }
+    if ((alarmsSet == true) && (lowC == alarmLowC) && (highC == alarmHighC)) {
+        return true;
+    }
+
+    alarmLowC           = lowC;
+    alarmHighC          = highC;
+    alarmsSet           = true;
+    fullReadDone        = false;    // Alarm flags only follow TH/TL from the next conversion; read everything once.
+    alarmPendingBits    = (count < 32) ? ((1UL << count) - 1) : 0xFFFFFFFF;
+
+    return true;
+}
+
+
+// Alarm monitoring; how often every channel is read regardless of the alarm search.  0 reads every cycle.
+void TempProbes::setFullReadPeriod(uint32_t fullReadPeriodMs) {
+    this->fullReadPeriodMs = fullReadPeriodMs;
+}
+
+
+// Channel bits (bit i = channel i) that went out of range since the previous call.
+uint32_t TempProbes::takeNewAlarms(void) {
+    uint32_t bits = newAlarmBits;
+
+    newAlarmBits = 0;
+
+    return bits;
+}
+
+
+//
+void TempProbes::save(void) {
+    struct persistedChannels persisted = {};
+
+    if (eepromAddr < 0) {
+        return;
+    }
+
+    persisted.magic = TEMP_PROBES_MAGIC;
+    persisted.count = count;
+    memcpy(persisted.channels, channels, sizeof(channels[0]) * count);
+
+    EEPROM.put(eepromAddr, persisted);
+}
+
+
+// 16 upper case hex digits, family code first.  romString holds TEMP_PROBES_ROM_STRING bytes.
+void TempProbes::formatRom(const uint8_t rom[8], char *romString) {
+    for (uint8_t i = 0; i < 8; i++) {
+        snprintf(&romString[i * 2], 3, "%02X", rom[i]);
+    }
+}
+
+
+// Temperature from a 9 byte DS18B20 scratchpad; false if it fails the CRC.
+bool TempProbes::decodeScratchpad(uint8_t *scratchpad, int16_t &raw) {
+    // All zeros (bus held low) passes the CRC; all ones (nothing answered) does not.
+    bool blank = true;
+    for (uint8_t i = 0; i < 9; i++) {
+        if (scratchpad[i] != 0) {
+            blank = false;
+        }
+    }
+    if ((blank == true) || (OneWire::crc8(scratchpad, 8) != scratchpad[8])) {
+        return false;
+    }
+
+    raw = (int16_t)((scratchpad[1] << 8) | scratchpad[0]);
+
+    // Below 12 bit resolution the low bits are undefined.  (Configuration register bits 5-6.)
+    switch (scratchpad[4] & 0x60) {
+        case 0x00:  raw &= ~7;  break;      //  9 bit
+        case 0x20:  raw &= ~3;  break;      // 10 bit
+        case 0x40:  raw &= ~1;  break;      // 11 bit
+    }
+
+    return true;
+}
+
+
+//
+void TempProbes::load(void) {
+    struct persistedChannels persisted;
+
+    EEPROM.get(eepromAddr, persisted);
+    if ((persisted.magic != TEMP_PROBES_MAGIC) || (persisted.count > TEMP_PROBES_MAX)) {
+        return;
+    }
+
+    count = persisted.count;
+    memcpy(channels, persisted.channels, sizeof(channels[0]) * count);
+    for (uint8_t i = 0; i < count; i++) {
+        channels[i].name[TEMP_PROBES_NAME_SIZE - 1] = 0;
+    }
+
+    invalidateReadings();
+}
+
+
+// Convert T to every probe at once.
+void TempProbes::startConversion(void) {
+    started         = true;
+    lastConvertMs   = millis();
+
+    if (bus.reset() == 0) {
+        // No presence pulse; report the whole cycle as not valid.
+        invalidateReadings();
+        latest.convertMs    = lastConvertMs;
+        fresh               = true;
+        return;
+    }
+
+    // Strong pull-up held through the conversion for parasite powered probes; released by the next reset.
+    const uint8_t command[2] = { ONEWIRE_SKIP_ROM, DS18B20_CONVERT_T };
+    bus.write_block(command, sizeof(command), 1);
+    converting = true;
+}
+
+
+// Scratchpads into latest, in channel order.  A full read covers every channel; otherwise only the channels
+// the alarm search returned are read.
+void TempProbes::readChannels(bool fullRead) {
+    uint32_t searchBits = 0;
+    uint32_t bits = 0;
+
+    if (fullRead == false) {
+        searchBits = alarmSearch();
+    }
+    else
+    {
+        latest.convertMs    = lastConvertMs;
+        lastFullReadMs      = lastConvertMs;
+        fullReadDone        = true;
+    }
+    latest.count = count;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if ((fullRead == true) || (((searchBits | alarmBits) & (1UL << i)) != 0)) {
+            // Channels still in alarm are read too; only a reading shows them back past the hysteresis.
+            readChannel(i);
+        }
+        else
+        {
+            // Not in the alarm search, so inside TH/TL; inside the thresholds too.
+            latest.alarm[i] = false;
+        }
+
+        if (latest.alarm[i] == true) {
+            bits |= (1UL << i);
+        }
+    }
+
+    newAlarmBits    |= (bits & ~alarmBits);
+    alarmBits       = bits;
+    fresh           = true;
+}
+
+
+// One channel into latest, calibrated & compared against the alarm thresholds.
+void TempProbes::readChannel(uint8_t index) {
+    uint8_t scratchpad[9];
+    int16_t raw = 0;
+    bool    valid;
+
+    valid = (readScratchpad(channels[index].rom, scratchpad) == true) && (decodeScratchpad(scratchpad, raw) == true);
+
+    latest.raw[index]           = raw;
+    latest.valid[index]         = valid;
+    latest.temperatureC[index]  = (valid == true) ? (((raw / 16.0f) * channels[index].gain) + channels[index].offset) : NAN;
+
+    // Out of range raises the alarm; it clears once back inside by the hysteresis.  An unreadable probe keeps
+    // the state it had, so a flaky connection doesn't re-alert.
+    float   temperatureC    = latest.temperatureC[index];
+    bool    wasAlarm        = ((alarmBits & (1UL << index)) != 0);
+    if ((alarmsSet == false) || (valid == false)) {
+        latest.alarm[index] = (alarmsSet == true) && (wasAlarm == true);
+    }
+    else if ((temperatureC < alarmLowC) || (temperatureC > alarmHighC)) {
+        latest.alarm[index] = true;
+    }
+    else
+    {
+        latest.alarm[index] = (wasAlarm == true) &&
+            ((temperatureC < (alarmLowC + TEMP_PROBES_HYSTERESIS_C)) || (temperatureC > (alarmHighC - TEMP_PROBES_HYSTERESIS_C)));
+    }
+
+    // TH/TL live in the scratchpad; a probe that lost power comes back with the values in its own EEPROM.
+    if ((alarmsSet == true) && (valid == true) && (((int8_t)scratchpad[2] != alarmTH[index]) || ((int8_t)scratchpad[3] != alarmTL[index]))) {
+        alarmPendingBits |= (1UL << index);
+    }
+}
+
+
+//
+bool TempProbes::readScratchpad(const uint8_t rom[8], uint8_t *scratchpad) {
+    uint8_t command[10];
+
+    command[0] = ONEWIRE_MATCH_ROM;
+    memcpy(&command[1], rom, 8);
+    command[9] = DS18B20_READ_SCRATCHPAD;
+
+    // Block transfers; one interrupt lock per byte rather than per bit.
+    if (bus.reset() == 0) {
+        return false;
+    }
+    bus.write_block(command, sizeof(command));
+    bus.read_block(scratchpad, 9);
+
+    return true;
+}
+
+
+// Lowest pending channel's TH/TL.  A probe that can't be reached now is retried when a full read finds its
+// registers wrong, so a missing probe doesn't hold up the conversions.
+void TempProbes::programPendingAlarm(void) {
+    for (uint8_t i = 0; i < count; i++) {
+        if ((alarmPendingBits & (1UL << i)) != 0) {
+            alarmPendingBits &= ~(1UL << i);
+            programAlarm(i);
+            fullReadDone = false;   // Its flag follows the new registers from the next conversion
+            return;
+        }
+    }
+
+    alarmPendingBits = 0;
+}
+
+
+// TH/TL for one channel: the thresholds taken back through its calibration to raw °C & rounded down.  The
+// probe compares whole degrees (T >= TH or T <= TL), so its alarm flag covers every out of range reading plus
+// up to a degree inside; readChannel() makes the exact comparison.  Left alone if already set, so the
+// scratchpad is only written when something changed.  (Not copied to the probe's EEPROM; see readChannel().)
+bool TempProbes::programAlarm(uint8_t index) {
+    const struct channel &ch = channels[index];
+    uint8_t command[13];
+    uint8_t scratchpad[9];
+    int16_t raw;
+
+    alarmTH[index] = alarm_register((alarmHighC - ch.offset) / ch.gain);
+    alarmTL[index] = alarm_register((alarmLowC - ch.offset) / ch.gain);
+
+    if ((readScratchpad(ch.rom, scratchpad) == false) || (decodeScratchpad(scratchpad, raw) == false)) {
+        return false;
+    }
+    if (((int8_t)scratchpad[2] == alarmTH[index]) && ((int8_t)scratchpad[3] == alarmTL[index])) {
+        return true;
+    }
+
+    command[0] = ONEWIRE_MATCH_ROM;
+    memcpy(&command[1], ch.rom, 8);
+    command[9]  = DS18B20_WRITE_SCRATCHPAD;
+    command[10] = (uint8_t)alarmTH[index];
+    command[11] = (uint8_t)alarmTL[index];
+    command[12] = scratchpad[4];    // Configuration (resolution) unchanged
+
+    if (bus.reset() == 0) {
+        return false;
+    }
+    bus.write_block(command, sizeof(command));
+
+    // Read back.
+    return (readScratchpad(ch.rom, scratchpad) == true) && (decodeScratchpad(scratchpad, raw) == true) &&
+        ((int8_t)scratchpad[2] == alarmTH[index]) && ((int8_t)scratchpad[3] == alarmTL[index]);
+}
+
+
+// Conditional search (0xEC); channel bits of the probes with their alarm flag set.
+uint32_t TempProbes::alarmSearch(void) {
+    uint8_t     rom[8];
+    uint32_t    bits = 0;
+
+    bus.reset_search();
+    for (uint8_t search = 0; (search < DISCOVER_SEARCH_MAX) && (bus.search(rom, false) == 1); search++) {
+        int index = findRom(rom);
+
+        if ((OneWire::crc8(rom, 7) == rom[7]) && (index >= 0)) {
+            bits |= (1UL << index);
+        }
+    }
+
+    return bits;
+}
+
+
+// Channel index by ROM code; -1 if there is none.
+int TempProbes::findRom(const uint8_t rom[8]) const {
+    for (uint8_t i = 0; i < count; i++) {
+        if (memcmp(channels[i].rom, rom, 8) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+//
+void TempProbes::invalidateReadings(void) {
+    latest.count        = count;
+    latest.convertMs    = 0;
+    for (uint8_t i = 0; i < TEMP_PROBES_MAX; i++) {
+        latest.temperatureC[i]  = NAN;
+        latest.raw[i]           = 0;
+        latest.valid[i]         = false;
+        latest.alarm[i]         = false;
+    }
+}
+
+
+//
+bool TempProbes::nameInUse(const char *name) const {
+    return (findChannel(name) >= 0);
+}
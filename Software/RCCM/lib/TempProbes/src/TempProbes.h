@@ -0,0 +1,113 @@
+#ifndef TempProbes_h
+#define TempProbes_h
+
+//
+#include <Particle.h>
+#include <OneWire.h>
+
+
+#define TEMP_PROBES_MAX             8               // Named channels on the bus
+#define TEMP_PROBES_NAME_SIZE       16              // Channel name, including the terminator
+#define TEMP_PROBES_ROM_STRING      17              // ROM code as hex, including the terminator
+#define TEMP_PROBES_CONVERT_MS      750             // DS18B20 worst case (12 bit) conversion time
+#define TEMP_PROBES_MAGIC           0x54505201      // "TPR" + layout version 1
+#define TEMP_PROBES_HYSTERESIS_C    0.5             // An alarm clears this far back inside the thresholds
+
+
+// Multi-drop DS18B20 probes on one 1-Wire bus, mapped by ROM code to named channels (e.g. "crawlspace").
+// Every probe converts together on one broadcast (Skip ROM) command; once the conversion time has passed,
+// each channel's scratchpad is read by Match ROM in channel order.  Channels, names & calibration persist
+// in EEPROM, so a channel keeps its name & index regardless of search order or probes missing at boot.
+//
+// Alarm monitoring: once every probe's TH/TL registers hold the programAlarms() thresholds, a cycle between full
+// reads is the broadcast convert plus one alarm search (0xEC), which only out of range probes answer; only
+// those (and channels still in alarm) are read.  With every probe in range, that search is empty.  TH/TL are
+// written by process() between conversions, never during one (a parasite powered probe needs the strong
+// pull-up the whole time).  A channel's alarm clears only TEMP_PROBES_HYSTERESIS_C back inside the thresholds.
+class TempProbes {
+    public:
+        // PUBLIC - Class Variables
+        // One probe, as persisted.  temperature = (raw * gain) + offset
+        struct channel {
+            uint8_t     rom[8];
+            char        name[TEMP_PROBES_NAME_SIZE];
+            float       offset;                         // °C
+            float       gain;
+        };
+
+        // One conversion cycle, every channel.  Struct-of-arrays; index i is channel i.
+        struct readings {
+            uint8_t     count;                          // Channels 0..count-1
+            uint32_t    convertMs;                      // millis() at the broadcast convert of the last full read
+            float       temperatureC[TEMP_PROBES_MAX];  // Calibrated; NAN when not valid
+            int16_t     raw[TEMP_PROBES_MAX];           // Scratchpad counts (1/16 °C), before calibration
+            bool        valid[TEMP_PROBES_MAX];         // Probe answered with a good CRC
+            bool        alarm[TEMP_PROBES_MAX];         // Outside the programAlarms() thresholds (calibrated)
+        };
+
+        // PUBLIC - Class Functions
+        TempProbes(OneWire &bus, uint32_t periodMs);
+        ~TempProbes();
+        void begin(int eepromAddr);
+        uint8_t discover(void);
+        void process(void);
+        bool takeReadings(struct readings &cycle);
+        const struct readings &getReadings(void) const;
+        uint8_t channelCount(void) const;
+        const struct channel &getChannel(uint8_t index) const;
+        int findChannel(const char *name) const;
+        bool configureChannel(uint8_t index, const char *name, float offset, float gain);
+        bool programAlarms(float lowC, float highC);
+        void setFullReadPeriod(uint32_t fullReadPeriodMs);
+        uint32_t takeNewAlarms(void);
+        void save(void);
+        static void formatRom(const uint8_t rom[8], char *romString);
+        static bool decodeScratchpad(uint8_t *scratchpad, int16_t &raw);
+
+    private:
+        // PRIVATE - Class Variables
+        // EEPROM layout
+        struct persistedChannels {
+            uint32_t    magic;
+            uint8_t     count;
+            struct channel channels[TEMP_PROBES_MAX];
+        };
+
+        OneWire     &bus;
+        uint32_t    periodMs;
+        int         eepromAddr;
+        bool        started;                // First conversion issued
+        bool        converting;             // Convert T issued; scratchpads not yet read
+        bool        fresh;                  // Cycle completed since the last takeReadings()
+        uint32_t    lastConvertMs;
+        uint32_t    fullReadPeriodMs;       // Alarm monitoring; every channel is read this often (0: every cycle)
+        uint32_t    lastFullReadMs;
+        bool        fullReadDone;
+        bool        alarmsSet;              // programAlarms() called; thresholds below are in use
+        float       alarmLowC;
+        float       alarmHighC;
+        uint32_t    alarmBits;              // Channels out of range as of the last cycle
+        uint32_t    newAlarmBits;           // Channels gone out of range since takeNewAlarms()
+        uint32_t    alarmPendingBits;       // Channels whose TH/TL process() has yet to write
+        int8_t      alarmTH[TEMP_PROBES_MAX];   // Register values per channel (raw °C, through the calibration)
+        int8_t      alarmTL[TEMP_PROBES_MAX];
+        uint8_t     count;
+        struct channel  channels[TEMP_PROBES_MAX];
+        struct readings latest;
+
+        // PRIVATE - Class Functions
+        void load(void);
+        void startConversion(void);
+        void readChannels(bool fullRead);
+        void readChannel(uint8_t index);
+        bool readScratchpad(const uint8_t rom[8], uint8_t *scratchpad);
+        void programPendingAlarm(void);
+        bool programAlarm(uint8_t index);
+        uint32_t alarmSearch(void);
+        int findRom(const uint8_t rom[8]) const;
+        void invalidateReadings(void);
+        bool nameInUse(const char *name) const;
+
+};
+
+#endif
@@ -0,0 +1,157 @@
+
+// INCLUDEs
+#include "UartBridge.h"
+
+
+
+
+// CONSTRUCTOR
+UartBridge::UartBridge(Stream &port) : framesReceived(0), framesUnhandled(0), framesDropped(0), port(port), handlerCount(0) {
+    resetFrame();
+}
+
+
+// DESTRUCTOR
+UartBridge::~UartBridge() {
+
+}
+
+
+// 
+bool UartBridge::addHandler(uint8_t frameType, uartFrameHandler handler) {
+    if (handlerCount >= UART_BRIDGE_HANDLERS_MAX) {
+        return false;
+    }
+
+    handlers[handlerCount].frameType    = frameType;
+    handlers[handlerCount].handler      = handler;
+    handlerCount++;
+
+    return true;
+}
+
+
+// Call from loop(); never waits on the port.
+void UartBridge::process(void) {
+    for (size_t i = 0; i < UART_BRIDGE_DRAIN_MAX; i++) {
+        int byte = port.read();
+        if (byte < 0) {
+            break;
+        }
+        processByte((uint8_t)byte);
+    }
+}
+
+
+// Streaming COBS decode.
+void UartBridge::processByte(uint8_t byte) {
+    // Frame Delimiter
+    if (byte == 0x00) {
+        if (blockRemaining != 0) {
+            // Truncated block.
+            framesDropped++;
+        }
+        else if (frameOverflow == true) {
+            framesDropped++;
+        }
+        else if (frameLength > 0) {
+            dispatchFrame();
+        }
+        resetFrame();
+        return;
+    }
+
+    // Code Byte
+    if (blockRemaining == 0) {
+        // Previous block ended in an implied zero, unless it was a full 0xFF block (or the first).
+        if ((blockCode != 0) && (blockCode != 0xFF)) {
+            if (frameLength < UART_BRIDGE_FRAME_MAX) {
+                frame[frameLength++] = 0x00;
+            }
+            else
+            {
+                frameOverflow = true;
+            }
+        }
+        blockCode       = byte;
+        blockRemaining  = byte - 1;
+        return;
+    }
+
+    // Data Byte
+    if (frameLength < UART_BRIDGE_FRAME_MAX) {
+        frame[frameLength++] = byte;
+    }
+    else
+    {
+        frameOverflow = true;
+    }
+    blockRemaining--;
+}
+
+
+// COBS encode & write one frame.  Returns bytes written, or 0 if the frame is too large or the TX
+// buffer can't take the whole frame right now.
+size_t UartBridge::send(uint8_t frameType, const uint8_t *payload, size_t length) {
+    // Worst case: one code byte per 254 data bytes, plus leading code & trailing delimiter.
+    uint8_t encoded[UART_BRIDGE_FRAME_MAX + (UART_BRIDGE_FRAME_MAX / 254) + 2];
+    size_t  codeIndex   = 0;
+    size_t  out         = 1;
+    uint8_t code        = 1;
+
+    if ((length + 1) > UART_BRIDGE_FRAME_MAX) {
+        return 0;
+    }
+
+    for (size_t i = 0; i <= length; i++) {
+        uint8_t byte = (i == 0) ? frameType : payload[i - 1];
+
+        if (byte == 0x00) {
+            encoded[codeIndex] = code;
+            codeIndex = out++;
+            code = 1;
+        }
+        else
+        {
+            encoded[out++] = byte;
+            code++;
+            if (code == 0xFF) {
+                encoded[codeIndex] = code;
+                codeIndex = out++;
+                code = 1;
+            }
+        }
+    }
+    encoded[codeIndex] = code;
+    encoded[out++] = 0x00;
+
+    if (port.availableForWrite() < (int)out) {
+        return 0;
+    }
+
+    return port.write(encoded, out);
+}
+
+
+// Zero-copy hand-off; handler sees the payload in place (type byte stripped).
+void UartBridge::dispatchFrame(void) {
+    framesReceived++;
+
+    for (size_t i = 0; i < handlerCount; i++) {
+        if (handlers[i].frameType == frame[0]) {
+            handlers[i].handler(&frame[1], frameLength - 1);
+            return;
+        }
+    }
+
+    framesUnhandled++;
+}
+
+
+// 
+void UartBridge::resetFrame(void) {
+    frameLength     = 0;
+    blockCode       = 0;
+    blockRemaining  = 0;
+    frameOverflow   = false;
+}
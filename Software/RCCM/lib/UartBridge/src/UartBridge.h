@@ -0,0 +1,59 @@
+#ifndef UartBridge_h
+#define UartBridge_h
+
+// 
+#include <Particle.h>
+
+
+#define UART_BRIDGE_FRAME_MAX       64      // Largest decoded frame (type byte + payload)
+#define UART_BRIDGE_HANDLERS_MAX    8       // Registered frame types
+#define UART_BRIDGE_DRAIN_MAX       64      // Bytes consumed per process() call
+
+
+// Frame handler.  The payload points into the bridge's frame buffer and is only valid for the
+// duration of the call.
+typedef void (*uartFrameHandler)(const uint8_t *payload, size_t length);
+
+
+// UART expansion bridge.  Frames are COBS encoded & 0x00 delimited:  [type][payload...]
+// Receive is fed by the port's interrupt driven RX ring buffer; process() drains a bounded number of
+// bytes per call, decodes in place and dispatches complete frames, so it never blocks loop().
+class UartBridge {
+    public:
+        // PUBLIC - Class Variables
+        uint32_t    framesReceived;
+        uint32_t    framesUnhandled;
+        uint32_t    framesDropped;          // Oversize or malformed
+
+        // PUBLIC - Class Functions
+        UartBridge(Stream &port);
+        ~UartBridge();
+        bool addHandler(uint8_t frameType, uartFrameHandler handler);
+        void process(void);
+        void processByte(uint8_t byte);
+        size_t send(uint8_t frameType, const uint8_t *payload, size_t length);
+
+    private:
+        // PRIVATE - Class Variables
+        struct handlerEntry {
+            uint8_t             frameType;
+            uartFrameHandler    handler;
+        };
+
+        Stream              &port;
+        struct handlerEntry handlers[UART_BRIDGE_HANDLERS_MAX];
+        size_t              handlerCount;
+
+        uint8_t             frame[UART_BRIDGE_FRAME_MAX];
+        size_t              frameLength;
+        uint8_t             blockCode;          // Current COBS code byte
+        uint8_t             blockRemaining;     // Data bytes left in current COBS block
+        bool                frameOverflow;
+
+        // PRIVATE - Class Functions
+        void dispatchFrame(void);
+        void resetFrame(void);
+
+};
+
+#endif
@@ -16,12 +16,60 @@
 #define THRESH_TEMP_HIGH    95
 #define THRESH_TEMP_DELTA   0.2
 #define THRESH_BATT_LOW     25
+#define THRESH_PIR_EDGES    3       // PIR edges per interval before an unoccupied cabin is flagged
+#define THRESH_LIGHT_ON     2000    // ADC counts; cabin considered lit at or above this level
+#define THRESH_LIGHT_STEP   800     // ADC counts; sample-to-sample rise treated as a door opening
+#define THRESH_ADC_1_LEAK   1500    // ADC counts; external port 1 (water leak probe) wet level
+#define THRESH_ADC_1_RUN    32      // Consecutive samples at/over the wet level (~32 ms) before WATER_LEAK is raised
+#define THRESH_ADC_2_ZERO   2048    // ADC counts; external port 2 (current clamp) bias / crossing level
+
+#define EXPECT_VACANT       true    // Cabin should be empty; motion raises OCCUPANCY alert
 
 #define INTERNAL_COLLECTION_INTERVAL    (60*15)            // 15 Minutes
 #define HEARTBEAT_INTERVAL              (60*60*24)         // 1 Day
 
 #define ALERT_THROTTLE_DELAY            1010               // ms
 
+#define LOCAL_TIMEZONE                  "EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00"   // POSIX TZ; Eastern USA
+#define HEARTBEAT_LOCAL_TIME            "08:00:00"         // Heartbeats aligned to this local time (daily), or counted from it (sub-daily)
+#define QUIET_HOURS_START               "22:00:00"         // Local; non-critical alerts held from here...
+#define QUIET_HOURS_END                 "07:00:00"         // ...to here, then published as one DIGEST alert
+
+#define LIGHT_SAMPLE_PERIOD_MS          1000               // 1 Second
+#define LIGHT_ON_HOLD_MS                (1000*60*30)       // 30 Minutes
+
+// Port sample periods are minimums: PortSampler takes at most one sample per loop() pass, and a pass that publishes,
+// reads the probes or sits in delay(ALERT_THROTTLE_DELAY) skips slots rather than catching up.  port2Rms is the AC RMS
+// of the samples actually taken; port2Cross counts threshold crossings between consecutive samples (~2 per mains cycle
+// a block covers, ~15 per block when every slot is kept, fewer across skipped slots), so read it as current flowing,
+// not as a frequency.
+#define ADC_1_SAMPLE_PERIOD_US          1000               // 1 kHz
+#define ADC_1_BLOCK_PERIOD_MS           (1000*10)          // 10 Seconds
+#define ADC_2_SAMPLE_PERIOD_US          1000               // 1 kHz at best (~16 samples per 60Hz cycle; one per loop() pass)
+#define ADC_2_BLOCK_PERIOD_MS           (1000*60)          // 1 Minute
+
+#define UART_BRIDGE_BAUD                115200             // External UART Port (Serial1)
+#define UART_FRAME_CO                   0x01               // CO meter:  [ppm u16 LE]
+#define UART_FRAME_PM                   0x02               // Particulate meter:  [PM2.5 u16 LE][PM10 u16 LE] (ug/m3)
+
+#define PROBE_PERIOD_MS                 (1000*60)          // 1 Minute; 1-Wire probes convert together, once per period
+
+#define RH_SAMPLE_PERIOD_MS             (1000*60)          // 1 Minute; onboard Si7021
+#define RH_HEATER_TRIGGER               95                 // %RH; held at or above this, the sensor is treated as saturated...
+#define RH_HEATER_HOLD_MS               (1000*60*30)       // ...after 30 Minutes
+#define RH_HEATER_ON_MS                 (1000*60*5)        // 5 Minutes heating; readings held from here...
+#define RH_HEATER_SETTLE_MS             (1000*60*10)       // ...through 10 Minutes cool down
+#define RH_HEATER_LEVEL                 0x04               // Si7021 heater current ~27 mA; <= 5 of every 45 minutes while saturated
+
+#define CONFIG_EEPROM_ADDR              0                  // Remote configuration storage
+#define CONFIG_MAGIC                    0x52434301         // "RCC" + layout version 1
+#define PROBES_EEPROM_ADDR              64                 // 1-Wire probe channels & calibration (TempProbes)
+#define CONFIG_JSON_MAX                 256                // Bytes; configure() argument
+#define CONFIG_JSON_TOKENS              16                 // Outer object + 2 per key; larger documents are rejected
+#define STATUS_JSON_MAX                 512                // Bytes; envJson / config variables
+#define ALERT_JSON_MAX                  622                // Bytes; twilio_sms event data (Particle.publish() limit)
+#define TIME_STRING_MAX                 32                 // Bytes; "Fri Jan  1 18:45:56 2021" + terminator
+
 
 // === PCB PINPOUT DEFINITIONS ===
 #define PIN_LIGHT_SEN     19  // Internal Light Sensor Signal (Analog)
@@ -47,6 +95,7 @@
 
 // === INTERNAL MACROS ===
 #define C_TO_F(celsius)     (((celsius) * 1.8) + 32)
+#define F_TO_C(fahrenheit)  (((fahrenheit) - 32) / 1.8)
 
 
 // === INCLUDES ===
@@ -54,13 +103,38 @@
 #include <Adafruit_Si7021.h>
 #include <JsonParserGeneratorRK.h>
 #include <LocalTimeRK.h>
+#include <Occupancy.h>
+#include <LightMonitor.h>
+#include <PortSampler.h>
+#include <UartBridge.h>
+#include <AlertScheduler.h>
+#include <OneWire.h>
+#include <TempProbes.h>
+#include <HumidityHeater.h>
 #include "secrets.h"
+#include "config_profiles.h"
+#include "json_schema.h"
 
 
 // === GLOBAL OBJECTS ===
 DataLog         dataLog(100);
 Adafruit_Si7021 Si7021 = Adafruit_Si7021();     // Onboard I2C Temp & Humidity Sensor
+HumidityHeater  humidityHeater(Si7021, RH_SAMPLE_PERIOD_MS, RH_HEATER_TRIGGER, RH_HEATER_HOLD_MS, RH_HEATER_ON_MS, RH_HEATER_SETTLE_MS, RH_HEATER_LEVEL);
 FuelGauge       fuel;                           // Onboard Battery Fuel Gauge
+Occupancy       occupancy(PIN_PIR);             // PIR Motion Edge Counter
+LightMonitor    lightMonitor(PIN_LIGHT_SEN, LIGHT_SAMPLE_PERIOD_MS, THRESH_LIGHT_STEP, THRESH_LIGHT_ON, LIGHT_ON_HOLD_MS);
+PortSampler     port1Sampler(PIN_ADC_1, ADC_1_SAMPLE_PERIOD_US, ADC_1_BLOCK_PERIOD_MS, THRESH_ADC_1_LEAK);  // External Water Leak Probe
+PortSampler     port2Sampler(PIN_ADC_2, ADC_2_SAMPLE_PERIOD_US, ADC_2_BLOCK_PERIOD_MS, THRESH_ADC_2_ZERO);  // External Current Clamp
+UartBridge      uartBridge(Serial1);            // External UART Sensor Bridge (PIN_UART_Rx / PIN_UART_Tx)
+OneWire         oneWire(PIN_1W);                // External 1-Wire Bus
+TempProbes      tempProbes(oneWire, PROBE_PERIOD_MS);   // External DS18B20 Probes (Named Channels)
+JsonParserStatic<CONFIG_JSON_MAX, CONFIG_JSON_TOKENS>   jpConfig;   // Remote Configuration Parser (No Heap)
+static constexpr LocalTimePosixTimezone localTimezone(LOCAL_TIMEZONE);   // Parsed at compile time
+LocalTimeConvert        localTimeConvert;                       // Keeps the DST transitions for the current year cached
+const LocalTimeFormat   timeStringFormat(TIME_FORMAT_DEFAULT);  // Time.timeStr() layout, precompiled (No Heap)
+AlertScheduler          alertScheduler(LocalTimeHMS(HEARTBEAT_LOCAL_TIME), LocalTimeHMS(QUIET_HOURS_START), LocalTimeHMS(QUIET_HOURS_END));
+
+static_assert(localTimezone.isValid() && localTimezone.hasDST(), "LOCAL_TIMEZONE is not a valid POSIX TZ string with DST rules.");
 
 
 // === TIMERS ===
@@ -77,23 +151,129 @@ struct alertList {
     bool bPowerLoss;
     bool bPowerRestore;
     bool bBatteryLow;
+    bool bOccupancy;
+    bool bLightsOn;
+    bool bDoorOpen;
+    bool bWaterLeak;
+    bool bProbeTemp;
     bool bHeartbeat;
 };
 
+// Non-critical alerts; held for the morning digest during quiet hours.  (Value = digest bit.)
+// TEMP_LOW, TEMP_HIGH, POWER_LOSS, OCCUPANCY, DOOR_OPEN & WATER_LEAK always publish immediately.
+enum digestAlert : uint8_t {
+    DIGEST_TEMP_DELTA       = 0,
+    DIGEST_TEMP_CLEAR       = 1,
+    DIGEST_POWER_RESTORE    = 2,
+    DIGEST_BATTERY_LOW      = 3,
+    DIGEST_LIGHTS_ON        = 4,
+    DIGEST_ALERT_COUNT
+};
+
+static const char * const digestAlertNames[DIGEST_ALERT_COUNT] = {
+    "TEMP_DELTA", "TEMP_CLEAR", "POWER_RESTORE", "BATTERY_LOW", "LIGHTS_ON",
+};
+
+// Remote configuration, as persisted.  Only restored while the DIP switches match those it was written under.
+struct persistedConfig {
+    uint32_t    magic;
+    uint8_t     dipSwitches;
+    float       tempLow;
+    float       tempHigh;
+    float       tempDelta;
+    float       battLow;
+    long        collectionInterval;
+    long        heartbeatInterval;
+};
+
+static_assert(sizeof(struct persistedConfig) <= PROBES_EEPROM_ADDR, "persistedConfig overlaps the probe channels in EEPROM.");
+
+// probe() arguments.  Empty name / NAN calibration keep the channel's current value.
+struct probeCommand {
+    char        channel[TEMP_PROBES_NAME_SIZE];     // Current name
+    char        name[TEMP_PROBES_NAME_SIZE];        // New name
+    float       offset;                             // °C
+    float       gain;
+};
+
 // Environmental Data Collected
 struct environmentData {
     long        time;
-    String      timeString;
+    char        timeString[TIME_STRING_MAX];    // Local time (EST/EDT), timeStringFormat
     bool        timeValid;
     double      batteryCharge;
     int32_t     batteryState;
     int32_t     powerSource;
     double      temperatureF;
     double      humidity;    
-    int32_t     lightLevel;
+    int32_t     rhHeaterCycles; // Si7021 condensation recovery cycles started this interval
+    int32_t     lightLevel;     // Interval mean
+    int32_t     lightMin;
+    int32_t     lightMax;
+    double      lightStdDev;
+    int32_t     port1Peak;
+    int32_t     port1Over;      // Samples at/over leak threshold
+    double      port2Rms;
+    int32_t     port2Crossings;
+    int32_t     pirEdges;
+    int32_t     coPpm;          // Interval max from the UART CO meter; -1 if no frame
+    int32_t     pm25;           // Interval max from the UART particulate meter; -1 if no frame
+    int32_t     pm10;
+};
+
+// External UART sensors, folded by the frame handlers between intervals.  -1 = no frame yet.
+struct uartSensorSummary {
+    int32_t     coPpmMax;
+    int32_t     pm25Max;
+    int32_t     pm10Max;
 };
 
 
+// === JSON SCHEMAS ===
+// Keys match the Particle.variable names.
+static constexpr auto environmentDataSchema = json_schema(
+    json_field("time",          &environmentData::time),
+    json_field("timeStr",       &environmentData::timeString),
+    json_field("timeVal",       &environmentData::timeValid),
+    json_field("battCharge",    &environmentData::batteryCharge),
+    json_field("battState",     &environmentData::batteryState),
+    json_field("pwrSrc",        &environmentData::powerSource),
+    json_field("tempF",         &environmentData::temperatureF),
+    json_field("humidity",      &environmentData::humidity),
+    json_field("rhHeat",        &environmentData::rhHeaterCycles),
+    json_field("lightLevel",    &environmentData::lightLevel),
+    json_field("lightMin",      &environmentData::lightMin),
+    json_field("lightMax",      &environmentData::lightMax),
+    json_field("lightStdDev",   &environmentData::lightStdDev),
+    json_field("port1Peak",     &environmentData::port1Peak),
+    json_field("port1Over",     &environmentData::port1Over),
+    json_field("port2Rms",      &environmentData::port2Rms),
+    json_field("port2Cross",    &environmentData::port2Crossings),
+    json_field("pirEdges",      &environmentData::pirEdges),
+    json_field("coPpm",         &environmentData::coPpm),
+    json_field("pm25",          &environmentData::pm25),
+    json_field("pm10",          &environmentData::pm10)
+);
+
+// Keys accepted by configure() and reported by the "config" variable.
+static constexpr auto thresholdSchema = json_schema(
+    json_field("tempLow",       &thresholdProfile::tempLow),
+    json_field("tempHigh",      &thresholdProfile::tempHigh),
+    json_field("tempDelta",     &thresholdProfile::tempDelta),
+    json_field("battLow",       &thresholdProfile::battLow),
+    json_field("interval",      &thresholdProfile::collectionInterval),
+    json_field("heartbeat",     &thresholdProfile::heartbeatInterval)
+);
+
+// Keys accepted by probe().
+static constexpr auto probeCommandSchema = json_schema(
+    json_field("ch",            &probeCommand::channel),
+    json_field("name",          &probeCommand::name),
+    json_field("offset",        &probeCommand::offset),
+    json_field("gain",          &probeCommand::gain)
+);
+
+
 // === GLOBAL VARIABLES ===
 const String    sFwVersion                          = FW_VERSION;
 bool            bCollectIntervalEnvironmentData     = false;
@@ -102,10 +282,26 @@ float           fThreshTempHigh                     = THRESH_TEMP_HIGH;
 float           fThreshTempDelta                    = THRESH_TEMP_DELTA;
 bool            bCurrentTempAlert                   = false;
 float           fThreshBattLow                      = THRESH_BATT_LOW;
+long            lCollectionInterval                 = INTERNAL_COLLECTION_INTERVAL;
+long            lHeartbeatInterval                  = HEARTBEAT_INTERVAL;
+uint32_t        uThreshPirEdges                     = THRESH_PIR_EDGES;
+bool            bExpectVacant                       = EXPECT_VACANT;
+bool            bLightsWereOn                       = false;    // lightsOn of the previous interval; LIGHTS_ON fires on the rising edge
+bool            bAlertSchedulerStarted              = false;    // alertScheduler.begin() waits for a valid clock
 struct environmentData  environmentDataInterval;
 struct environmentData  environmentDataLastInterval;
 struct alertList        activeAlertsInterval;
 struct alertList        activeAlertsLastInterval;
+struct configProfile    activeProfile               = config_profile_resolve(0);
+int32_t                 dipProfile                  = 0;
+struct Occupancy::intervalSummary   occupancyInterval;
+struct LightMonitor::intervalSummary lightInterval;
+struct PortSampler::intervalSummary  port1Interval;
+struct PortSampler::intervalSummary  port2Interval;
+struct TempProbes::readings         probeReadings;
+struct HumidityHeater::reading      si7021Reading;
+struct uartSensorSummary            uartSensorInterval  = { -1, -1, -1 };
+uint32_t                            uProbeAlarms    = 0;    // Channel bits gone out of range, not yet published
 
 
 // === PARTICLE CONFIGURATION ===
@@ -119,16 +315,34 @@ void setup() {
     Particle.variable("battCharge", environmentDataInterval.batteryCharge);
     Particle.variable("battState", environmentDataInterval.batteryState);
     Particle.variable("humidity", environmentDataInterval.humidity);
+    Particle.variable("rhHeat", environmentDataInterval.rhHeaterCycles);
     Particle.variable("lightLevel", environmentDataInterval.lightLevel);
+    Particle.variable("lightMin", environmentDataInterval.lightMin);
+    Particle.variable("lightMax", environmentDataInterval.lightMax);
+    Particle.variable("lightStdDev", environmentDataInterval.lightStdDev);
+    Particle.variable("port1Peak", environmentDataInterval.port1Peak);
+    Particle.variable("port1Over", environmentDataInterval.port1Over);
+    Particle.variable("port2Rms", environmentDataInterval.port2Rms);
+    Particle.variable("port2Cross", environmentDataInterval.port2Crossings);
+    Particle.variable("pirEdges", environmentDataInterval.pirEdges);
+    Particle.variable("coPpm", environmentDataInterval.coPpm);
+    Particle.variable("pm25", environmentDataInterval.pm25);
+    Particle.variable("pm10", environmentDataInterval.pm10);
     Particle.variable("pwrSrc", environmentDataInterval.powerSource);
     Particle.variable("tempF", environmentDataInterval.temperatureF);
     Particle.variable("time", environmentDataInterval.time);
     Particle.variable("timeStr", environmentDataInterval.timeString);
     Particle.variable("timeVal", environmentDataInterval.timeValid);
+    Particle.variable("dipProfile", dipProfile);
+    Particle.variable("envJson", env_json);
+    Particle.variable("config", config_json);
+    Particle.variable("probes", probes_json);
 
     // Particle Cloud Function Registration
     Particle.function("collect_environment_data", collect_environment_data);
     Particle.function("publish_alert", publish_alert);
+    Particle.function("configure", configure);
+    Particle.function("probe", configure_probe);
 
     // I/O
         // Internal Sensor Expansion
@@ -156,10 +370,22 @@ void setup() {
         pinMode(PIN_INT_SIG,    INPUT_PULLUP);
 
         // External Sensor Interfaces
-        pinMode(PIN_ADC_1,  INPUT_PULLUP);
-        pinMode(PIN_ADC_2,  INPUT_PULLUP);
+        port1Sampler.begin();   // PIN_ADC_1 (Analog)
+        port2Sampler.begin();   // PIN_ADC_2 (Analog)
         pinMode(PIN_1W,     INPUT_PULLUP);
+        tempProbes.begin(PROBES_EEPROM_ADDR);   // PIN_1W; restores named channels, then searches the bus
+
+        // External UART Port  (Sensor frames dispatched to the handlers below.)
+        Serial1.begin(UART_BRIDGE_BAUD);
+        uartBridge.addHandler(UART_FRAME_CO, uart_frame_co);
+        uartBridge.addHandler(UART_FRAME_PM, uart_frame_pm);
 
+        // PIR Edge Counting (ISR)
+        occupancy.begin();
+
+    // Configuration Profile  (DIP switches read once; configure() may retune the thresholds at runtime.)
+    apply_config_profile(config_profile_resolve(read_dip_switches()));
+    config_load();
 
     // Debug UART
     Serial.begin(115200);
@@ -169,10 +395,12 @@ void setup() {
     // Set time zone to Eastern USA daylight saving time
     Time.zone(-4);
     // (https://docs.particle.io/cards/libraries/l/LocalTimeRK/), does not modify base Time class timezone!
-    LocalTime::instance().withConfig(LocalTimePosixTimezone("EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00"));
+    LocalTime::instance().withConfig(localTimezone);
+    // (alertScheduler is started from loop() once the clock is valid.)
 
     // Local Temp & Humidity Sensor
     Si7021.begin();
+    humidityHeater.begin();     // Heater off; first sample taken here, then sampled by process()
 
     // Ephemeral Debug Log Message
     Particle.publish("RCCM_Debug: Setup Function");
@@ -189,17 +417,43 @@ void loop() {
     // Local Variable Declarations
     //float fTempDelta;
     static long  lLastDataCollectTime = 0;
-    static long  lLastHeartbeatTime   = 0;
+    uint32_t     uDigest;
 
 
     // === TASK SCHEDULING ===
-    if (Time.now() >= (lLastDataCollectTime + INTERNAL_COLLECTION_INTERVAL)) {
+    if (Time.now() >= (lLastDataCollectTime + lCollectionInterval)) {
         lLastDataCollectTime = Time.now();
         bCollectIntervalEnvironmentData = true;
 
     }
 
 
+    // === TASK ===
+    // Sample light level between intervals.  (Summary only; raw samples are never stored.)
+    lightMonitor.process();
+
+    // Sample external analog ports into blocks; reduce each when full.  (One sample per pass; features only; blocks are overwritten.)
+    port1Sampler.process();
+    port2Sampler.process();
+
+    // Drain & dispatch external UART frames.  (Bounded per pass; never waits on the port.)
+    uartBridge.process();
+
+    // Convert & read external 1-Wire probes.  (One broadcast convert per period; never waits on the conversion.)
+    tempProbes.process();
+
+    // Sample onboard temperature & humidity; run the heater when the sensor stays saturated.  (Never waits on a conversion.)
+    humidityHeater.process();
+
+    // PROBE_TEMP
+    // (Checked every probe cycle by alarm search, not once per interval; raised once per probe leaving range, and not
+    // again until it is back TEMP_PROBES_HYSTERESIS_C inside.)
+    uProbeAlarms |= tempProbes.takeNewAlarms();
+    if (uProbeAlarms != 0) {
+        activeAlertsInterval.bProbeTemp = true;
+    }
+
+
     // === TASK ===
     // Collect interval environment data.  (Timer flag based.)
     if (bCollectIntervalEnvironmentData == true) {
@@ -212,6 +466,34 @@ void loop() {
         // Collect New Data
         collect_environment_data(" ");
 
+        // Motion Seen Since Last Interval
+        occupancy.takeInterval(occupancyInterval);
+        environmentDataInterval.pirEdges = occupancyInterval.edgeCount;
+
+        // Light Level Summary Since Last Interval
+        lightMonitor.takeInterval(lightInterval);
+        environmentDataInterval.lightLevel  = (int32_t)lightInterval.mean;
+        environmentDataInterval.lightMin    = lightInterval.min;
+        environmentDataInterval.lightMax    = lightInterval.max;
+        environmentDataInterval.lightStdDev = lightInterval.stdDev;
+
+        // External Port Features Since Last Interval
+        port1Sampler.takeInterval(port1Interval);
+        port2Sampler.takeInterval(port2Interval);
+        environmentDataInterval.port1Peak       = port1Interval.peak;
+        environmentDataInterval.port1Over       = port1Interval.overThreshold;
+        environmentDataInterval.port2Rms        = port2Interval.rmsMax;
+        environmentDataInterval.port2Crossings  = port2Interval.crossings;
+
+        // External UART Sensors Since Last Interval
+        environmentDataInterval.coPpm   = uartSensorInterval.coPpmMax;
+        environmentDataInterval.pm25    = uartSensorInterval.pm25Max;
+        environmentDataInterval.pm10    = uartSensorInterval.pm10Max;
+        uartSensorInterval = { -1, -1, -1 };
+
+        // External 1-Wire Probes (Latest conversion cycle, every channel.)
+        tempProbes.takeReadings(probeReadings);
+
         // Generate Alerts Based On New Data
             // Store current data as last for delta based alert comparison.
             activeAlertsLastInterval = activeAlertsInterval;
@@ -299,14 +581,45 @@ void loop() {
                 activeAlertsInterval.bBatteryLow = false;
             }
 
-            // HEARTBEAT
-            if ((Time.now() >= (lLastHeartbeatTime + HEARTBEAT_INTERVAL))) {
-                activeAlertsInterval.bHeartbeat = true;
-                lLastHeartbeatTime = Time.now();
+            // OCCUPANCY
+            // (Aggregated; at most one alert per interval regardless of how many times the PIR fired.)
+            if ((bExpectVacant == true) && (occupancyInterval.edgeCount >= uThreshPirEdges)) {
+                activeAlertsInterval.bOccupancy = true;
+            }
+            else
+            {
+                activeAlertsInterval.bOccupancy = false;
+            }
+
+            // LIGHTS_ON
+            // (Edge triggered; raised once when the lights come on, not every interval they stay on.)
+            if ((lightInterval.lightsOn == true) && (bLightsWereOn == false)) {
+                activeAlertsInterval.bLightsOn = true;
+            }
+            else
+            {
+                activeAlertsInterval.bLightsOn = false;
+            }
+            bLightsWereOn = lightInterval.lightsOn;
+
+            // DOOR_OPEN
+            // (Aggregated; one alert per interval however many steps were seen.)
+            if (lightInterval.doorEvents > 0) {
+                activeAlertsInterval.bDoorOpen = true;
             }
             else
             {
-                activeAlertsInterval.bHeartbeat = false;
+                activeAlertsInterval.bDoorOpen = false;
+            }
+
+            // WATER_LEAK
+            // (Sustained wet level only; single samples over the level are treated as noise.)
+            if (port1Interval.overRunMax >= THRESH_ADC_1_RUN) {
+                activeAlertsInterval.bWaterLeak = true;
+            }
+            else
+            {
+                activeAlertsInterval.bWaterLeak = false;
             }
 
 
@@ -315,6 +628,18 @@ void loop() {
     }
 
 
+    // HEARTBEAT
+    // (Checked every pass, not once per interval, so it goes out at HEARTBEAT_LOCAL_TIME; the deadline is cached by
+    // alertScheduler.  Deadlines need a valid clock, so it starts at the first pass after time sync.)
+    if ((bAlertSchedulerStarted == false) && (Time.isValid() == true)) {
+        alertScheduler.begin(Time.now());
+        bAlertSchedulerStarted = true;
+    }
+    if (alertScheduler.heartbeatDue(Time.now()) == true) {
+        activeAlertsInterval.bHeartbeat = true;
+    }
+
+
     // === PROCESS ALERTS ===
     // NOTE: Alerts don't mute, for now.
 
@@ -339,7 +664,7 @@ void loop() {
         // TEMP_DELTA
         if (activeAlertsInterval.bTempDelta == true) {
             // Publish Alert
-            publish_alert("TEMP_DELTA");
+            publish_noncritical_alert(DIGEST_TEMP_DELTA);
 
             // Clear Alert
             activeAlertsInterval.bTempDelta = false;
@@ -348,7 +673,7 @@ void loop() {
         // TEMP_CLEAR
         if (activeAlertsInterval.bTempClear == true) {
             // Publish Alert
-            publish_alert("TEMP_CLEAR");
+            publish_noncritical_alert(DIGEST_TEMP_CLEAR);
 
             // Clear Alert
             activeAlertsInterval.bTempClear = false;
@@ -366,7 +691,7 @@ void loop() {
         // POWER_RESTORE
         if (activeAlertsInterval.bPowerRestore == true) {
             // Publish Alert
-            publish_alert("POWER_RESTORE");
+            publish_noncritical_alert(DIGEST_POWER_RESTORE);
 
             // Clear Alert
             activeAlertsInterval.bPowerRestore = false;          
@@ -375,12 +700,58 @@ void loop() {
         // BATTERY_LOW
         if (activeAlertsInterval.bBatteryLow == true) {
             // Publish Alert
-            publish_alert("BATTERY_LOW");
+            publish_noncritical_alert(DIGEST_BATTERY_LOW);
 
             // Clear Alert
             activeAlertsInterval.bBatteryLow = false;
         }
 
+        // OCCUPANCY
+        if (activeAlertsInterval.bOccupancy == true) {
+            // Publish Alert
+            publish_alert("OCCUPANCY");
+
+            // Clear Alert
+            activeAlertsInterval.bOccupancy = false;
+        }
+
+        // LIGHTS_ON
+        if (activeAlertsInterval.bLightsOn == true) {
+            // Publish Alert
+            publish_noncritical_alert(DIGEST_LIGHTS_ON);
+
+            // Clear Alert
+            activeAlertsInterval.bLightsOn = false;
+        }
+
+        // DOOR_OPEN
+        if (activeAlertsInterval.bDoorOpen == true) {
+            // Publish Alert
+            publish_alert("DOOR_OPEN");
+
+            // Clear Alert
+            activeAlertsInterval.bDoorOpen = false;
+        }
+
+        // WATER_LEAK
+        if (activeAlertsInterval.bWaterLeak == true) {
+            // Publish Alert
+            publish_alert("WATER_LEAK");
+
+            // Clear Alert
+            activeAlertsInterval.bWaterLeak = false;
+        }
+
+        // PROBE_TEMP
+        if (activeAlertsInterval.bProbeTemp == true) {
+            // Publish Alert
+            publish_probe_alert(uProbeAlarms);
+
+            // Clear Alert
+            activeAlertsInterval.bProbeTemp = false;
+            uProbeAlarms = 0;
+        }
+
         // HEARTBEAT
         if (activeAlertsInterval.bHeartbeat == true) {
             // Publish Alert
@@ -390,6 +761,13 @@ void loop() {
             activeAlertsInterval.bHeartbeat = false;
         }
 
+        // DIGEST
+        // (Non-critical alerts held over quiet hours; released once, at the first pass after QUIET_HOURS_END.)
+        uDigest = alertScheduler.takeDigest(Time.now());
+        if (uDigest != 0) {
+            publish_digest(uDigest);
+        }
+
 
 }   // END loop
 
@@ -407,7 +785,7 @@ int publish_alert(String alertType) {
     }
 
     // Build & Format SMS Body
-    body = String::format("[ %s ]\nAlert: %s\nTemp: %.1fF\nHumidity: %.1f%%\nBatt: %.1f%%\nBatt State: %s\nPWR SRC: %s\nFW: %s\n%s\n", SECRET_LOCATION, alertType.c_str(), environmentDataInterval.temperatureF, environmentDataInterval.humidity, environmentDataInterval.batteryCharge, batteryState.c_str(), powerSource.c_str(), FW_VERSION, environmentDataInterval.timeString.c_str());
+    body = String::format("[ %s ]\nAlert: %s\nTemp: %.1fF\nHumidity: %.1f%%\nBatt: %.1f%%\nBatt State: %s\nPWR SRC: %s\nFW: %s\n%s\n", SECRET_LOCATION, alertType.c_str(), environmentDataInterval.temperatureF, environmentDataInterval.humidity, environmentDataInterval.batteryCharge, batteryState.c_str(), powerSource.c_str(), FW_VERSION, environmentDataInterval.timeString);
 
 
     // Throttle Alert Publishing
@@ -415,29 +793,23 @@ int publish_alert(String alertType) {
 
     // JSON Writer Example: https://github.com/rickkas7/JsonParserGeneratorRK/blob/master/examples/2-generator/2-generator-JsonParserGeneratorRK.cpp
     // {{Moustache}} templates used to populate To/From/Body form fields in Twilio API call.
-    JsonWriterStatic<256> jwA;
-    JsonWriterStatic<256> jwB;
-    {
-        JsonWriterAutoObject obj(&jwA);
+    JsonWriterStatic<ALERT_JSON_MAX> jw;
 
-        jwA.insertKeyValue("SMS_TO", SECRET_SMS_TO_A);
-        jwA.insertKeyValue("SMS_FROM", SECRET_SMS_FROM);
-        jwA.insertKeyValue("SMS_BODY", body);
+    // Publish Alert Data  (Per DIP switch publish policy.)
+    if ((activeProfile.policy == PUBLISH_SMS_BOTH) || (activeProfile.policy == PUBLISH_SMS_A)) {
+        sms_json(jw, SECRET_SMS_TO_A, body);
+        Particle.publish("twilio_sms", jw.getBuffer());
+        delay(ALERT_THROTTLE_DELAY);
     }
-
-    {
-        JsonWriterAutoObject obj(&jwB);
-
-        jwB.insertKeyValue("SMS_TO", SECRET_SMS_TO_B);
-        jwB.insertKeyValue("SMS_FROM", SECRET_SMS_FROM);
-        jwB.insertKeyValue("SMS_BODY", body);
+    if ((activeProfile.policy == PUBLISH_SMS_BOTH) || (activeProfile.policy == PUBLISH_SMS_B)) {
+        sms_json(jw, SECRET_SMS_TO_B, body);
+        Particle.publish("twilio_sms", jw.getBuffer());
+        delay(ALERT_THROTTLE_DELAY);
+    }
+    if (activeProfile.policy == PUBLISH_EVENT_ONLY) {
+        Particle.publish("RCCM_Alert", body);
+        delay(ALERT_THROTTLE_DELAY);
     }
-
-    // Publish Alert Data
-    Particle.publish("twilio_sms", jwA.getBuffer());
-    delay(ALERT_THROTTLE_DELAY);
-    Particle.publish("twilio_sms", jwB.getBuffer());
-    delay(ALERT_THROTTLE_DELAY);
     
     // Return Length of Alert Body
     return body.length();
@@ -445,6 +817,108 @@ int publish_alert(String alertType) {
 }   // END publish_alert
 
 
+// Twilio webhook document for one recipient.  A truncated document would reach the webhook as malformed JSON,
+// so the SMS body is cut short, 64 bytes at a time, until the whole document fits.
+void sms_json(JsonWriter &jw, const char *smsTo, String &body) {
+    for (;;) {
+        jw.init();
+        {
+            JsonWriterAutoObject obj(&jw);
+
+            jw.insertKeyValue("SMS_TO", smsTo);
+            jw.insertKeyValue("SMS_FROM", SECRET_SMS_FROM);
+            jw.insertKeyValue("SMS_BODY", body);
+        }
+
+        // (A document that exactly fills the buffer loses its closing brace to the terminator.)
+        if (((jw.isTruncated() == false) && (jw.getOffset() < jw.getBufferLen())) || (body.length() == 0)) {
+            return;
+        }
+        body = body.substring(0, (body.length() > 64) ? (body.length() - 64) : 0);
+    }
+}   // END sms_json
+
+
+// Publish now, or hold for the digest during quiet hours.  (alert: a digestAlert)
+void publish_noncritical_alert(uint8_t alert) {
+    if (alertScheduler.defer((1UL << alert), Time.now()) == true) {
+        return;
+    }
+
+    publish_alert(digestAlertNames[alert]);
+}   // END publish_noncritical_alert
+
+
+// One alert listing every held alert type, e.g. "DIGEST: TEMP_CLEAR LIGHTS_ON".
+void publish_digest(uint32_t digest) {
+    char    alertType[96] = "DIGEST:";
+    size_t  length = strlen(alertType);
+
+    for (uint8_t alert = 0; alert < DIGEST_ALERT_COUNT; alert++) {
+        if ((digest & (1UL << alert)) != 0) {
+            length += snprintf(&alertType[length], sizeof(alertType) - length, " %s", digestAlertNames[alert]);
+        }
+    }
+
+    publish_alert(alertType);
+}   // END publish_digest
+
+
+// One alert naming every probe that left range, e.g. "PROBE_TEMP: crawlspace 31.6F, pipe chase 30.9F".
+void publish_probe_alert(uint32_t channels) {
+    char        alertType[16 + (TEMP_PROBES_MAX * (TEMP_PROBES_NAME_SIZE + 12))] = "PROBE_TEMP:";
+    size_t      length = strlen(alertType);
+    const char  *separator = " ";
+
+    // Latest cycle; the alarming channels were read in it.  (Not taken; probeReadings stays the interval's snapshot.)
+    const struct TempProbes::readings &cycle = tempProbes.getReadings();
+
+    for (uint8_t i = 0; i < cycle.count; i++) {
+        if ((channels & (1UL << i)) != 0) {
+            length += snprintf(&alertType[length], sizeof(alertType) - length, "%s%s %.1fF", separator, tempProbes.getChannel(i).name, C_TO_F(cycle.temperatureC[i]));
+            separator = ", ";
+        }
+    }
+
+    publish_alert(alertType);
+}   // END publish_probe_alert
+
+
+// UART_FRAME_CO handler.  Payload is in the bridge's frame buffer; only valid for this call.
+void uart_frame_co(const uint8_t *payload, size_t length) {
+    int32_t ppm;
+
+    if (length != 2) {
+        return;
+    }
+
+    ppm = payload[0] | (payload[1] << 8);
+    if (ppm > uartSensorInterval.coPpmMax) {
+        uartSensorInterval.coPpmMax = ppm;
+    }
+}   // END uart_frame_co
+
+
+// UART_FRAME_PM handler.
+void uart_frame_pm(const uint8_t *payload, size_t length) {
+    int32_t pm25;
+    int32_t pm10;
+
+    if (length != 4) {
+        return;
+    }
+
+    pm25 = payload[0] | (payload[1] << 8);
+    pm10 = payload[2] | (payload[3] << 8);
+    if (pm25 > uartSensorInterval.pm25Max) {
+        uartSensorInterval.pm25Max = pm25;
+    }
+    if (pm10 > uartSensorInterval.pm10Max) {
+        uartSensorInterval.pm10Max = pm10;
+    }
+}   // END uart_frame_pm
+
+
 //
 void timer_interval_environment_data(void) {
     bCollectIntervalEnvironmentData = true;
@@ -458,7 +932,8 @@ int collect_environment_data(String junk) {
 
     // Time
     environmentDataReading.time             = Time.now();
-    environmentDataReading.timeString       = Time.timeStr();
+    localTimeConvert.withTime(environmentDataReading.time).convert();
+    localTimeConvert.format(timeStringFormat, environmentDataReading.timeString, sizeof(environmentDataReading.timeString));
     environmentDataReading.timeValid        = Time.isValid();
 
     // System Power
@@ -466,12 +941,31 @@ int collect_environment_data(String junk) {
     environmentDataReading.batteryState     = System.batteryState();
     environmentDataReading.batteryCharge    = System.batteryCharge();
 
-    // Temperature & Humidity
-    environmentDataReading.temperatureF     = C_TO_F(Si7021.readTemperature());
-    environmentDataReading.humidity         = Si7021.readHumidity();
+    // Temperature & Humidity (Sampled by humidityHeater; held at the last reading before the heater went on.)
+    humidityHeater.takeReading(si7021Reading);
+    environmentDataReading.temperatureF     = C_TO_F(si7021Reading.temperatureC);
+    environmentDataReading.humidity         = si7021Reading.humidity;
+    environmentDataReading.rhHeaterCycles   = humidityHeater.takeCycles();
+
+    // Light Level (Summarized by lightMonitor, latched once per interval in loop.)
+    environmentDataReading.lightLevel       = environmentDataInterval.lightLevel;
+    environmentDataReading.lightMin         = environmentDataInterval.lightMin;
+    environmentDataReading.lightMax         = environmentDataInterval.lightMax;
+    environmentDataReading.lightStdDev      = environmentDataInterval.lightStdDev;
+
+    // External Ports (Reduced by port samplers, latched once per interval in loop.)
+    environmentDataReading.port1Peak        = environmentDataInterval.port1Peak;
+    environmentDataReading.port1Over        = environmentDataInterval.port1Over;
+    environmentDataReading.port2Rms         = environmentDataInterval.port2Rms;
+    environmentDataReading.port2Crossings   = environmentDataInterval.port2Crossings;
 
-    // Light Level
-    environmentDataReading.lightLevel       = analogRead(PIN_LIGHT_SEN);
+    // PIR Edges (Counted by ISR, latched once per interval in loop.)
+    environmentDataReading.pirEdges         = environmentDataInterval.pirEdges;
+
+    // External UART Sensors (Folded by frame handlers, latched once per interval in loop.)
+    environmentDataReading.coPpm            = environmentDataInterval.coPpm;
+    environmentDataReading.pm25             = environmentDataInterval.pm25;
+    environmentDataReading.pm10             = environmentDataInterval.pm10;
 
     // Save Last Interval Reading & Save New Data
     environmentDataLastInterval = environmentDataInterval;
@@ -483,6 +977,239 @@ int collect_environment_data(String junk) {
 }   // END collect_environment_data
 
 
+// Active low; switch ON = bit set.  DIP 1 is bit 0.
+uint8_t read_dip_switches(void) {
+    uint8_t dipSwitches = 0;
+
+    dipSwitches |= (digitalRead(PIN_DIP_1) == LOW) ? 0x01 : 0;
+    dipSwitches |= (digitalRead(PIN_DIP_2) == LOW) ? 0x02 : 0;
+    dipSwitches |= (digitalRead(PIN_DIP_3) == LOW) ? 0x04 : 0;
+    dipSwitches |= (digitalRead(PIN_DIP_4) == LOW) ? 0x08 : 0;
+    dipSwitches |= (digitalRead(PIN_DIP_5) == LOW) ? 0x10 : 0;
+
+    return dipSwitches;
+}   // END read_dip_switches
+
+
+// Copy a resolved profile into the working thresholds used by loop().
+void apply_config_profile(const struct configProfile &profile) {
+    activeProfile       = profile;
+    dipProfile          = profile.dipSwitches;
+
+    fThreshTempLow      = profile.thresholds.tempLow;
+    fThreshTempHigh     = profile.thresholds.tempHigh;
+    fThreshTempDelta    = profile.thresholds.tempDelta;
+    fThreshBattLow      = profile.thresholds.battLow;
+    lCollectionInterval = profile.thresholds.collectionInterval;
+    lHeartbeatInterval  = profile.thresholds.heartbeatInterval;
+    alertScheduler.setHeartbeatInterval(lHeartbeatInterval);
+    bExpectVacant       = profile.expectVacant;
+
+    // Same thresholds on the 1-Wire probes' alarm registers (written by process() between conversions); every channel
+    // is still read once per interval.
+    tempProbes.programAlarms(F_TO_C(fThreshTempLow), F_TO_C(fThreshTempHigh));
+    tempProbes.setFullReadPeriod(lCollectionInterval * 1000);
+}   // END apply_config_profile
+
+
+// Remote configuration.  e.g. {"tempLow":38,"tempHigh":90,"interval":900}
+// Keys: tempLow, tempHigh, tempDelta, battLow (float); interval, heartbeat (int, seconds).  Omitted keys keep their current value.
+// All keys are parsed & validated before anything is applied, so a bad document changes nothing.
+// Returns 0 on success, -1 parse error, -2 unknown key / bad value, -3 failed validation.
+int configure(String command) {
+    // Local Variable Declarations
+    struct thresholdProfile candidate = activeProfile.thresholds;
+    int     result;
+
+    // Parse into the static token pool.  (Documents needing more than CONFIG_JSON_TOKENS fail here.)
+    jpConfig.clear();
+    if (!jpConfig.addString(command.c_str()) || !jpConfig.parse()) {
+        return -1;
+    }
+
+    // Keys compared in place against thresholdSchema; no String per key.
+    result = json_read_object(jpConfig, jpConfig.getOuterObject(), candidate, thresholdSchema);
+    if (result == JSON_SCHEMA_BAD_DOCUMENT) {
+        return -1;
+    }
+    if (result != JSON_SCHEMA_OK) {
+        return -2;
+    }
+
+    if (config_validate(candidate) == false) {
+        return -3;
+    }
+
+    // Apply & Persist  (Cloud functions run on the loop thread, so loop() never sees a partial update.)
+    candidate.name = "REMOTE";
+    activeProfile.thresholds = candidate;
+    apply_config_profile(activeProfile);
+    config_save();
+
+    return 0;
+}   // END configure
+
+
+// Probe channel configuration.  e.g. {"ch":"probe2","name":"crawlspace","offset":-0.25}
+// Keys: ch (current channel name, required), name (new name), offset (°C), gain.  Omitted keys keep their current value.
+// Returns 0 on success, -1 parse error, -2 unknown key / bad value, -3 unknown channel or failed validation.
+int configure_probe(String command) {
+    // Local Variable Declarations
+    struct probeCommand candidate = { "", "", NAN, NAN };
+    int     result;
+    int     index;
+
+    jpConfig.clear();
+    if (!jpConfig.addString(command.c_str()) || !jpConfig.parse()) {
+        return -1;
+    }
+
+    result = json_read_object(jpConfig, jpConfig.getOuterObject(), candidate, probeCommandSchema);
+    if (result == JSON_SCHEMA_BAD_DOCUMENT) {
+        return -1;
+    }
+    if (result != JSON_SCHEMA_OK) {
+        return -2;
+    }
+
+    index = tempProbes.findChannel(candidate.channel);
+    if (index < 0) {
+        return -3;
+    }
+    if (isnan(candidate.offset)) {
+        candidate.offset = tempProbes.getChannel(index).offset;
+    }
+    if (isnan(candidate.gain)) {
+        candidate.gain = tempProbes.getChannel(index).gain;
+    }
+
+    // Validates, applies & persists.
+    if (tempProbes.configureChannel(index, (candidate.name[0] != 0) ? candidate.name : 0, candidate.offset, candidate.gain) == false) {
+        return -3;
+    }
+
+    // "probes" reflects the new name & calibration without waiting for the next interval.
+    tempProbes.takeReadings(probeReadings);
+
+    return 0;
+}   // END configure_probe
+
+
+// (Written as in-range tests so NaN fails them.)
+bool config_validate(const struct thresholdProfile &thresholds) {
+    if (!((thresholds.tempLow >= -40) && (thresholds.tempHigh <= 150) && (thresholds.tempLow < thresholds.tempHigh))) {
+        return false;
+    }
+    if (!((thresholds.tempDelta >= 0) && (thresholds.battLow >= 0) && (thresholds.battLow <= 100))) {
+        return false;
+    }
+    if (!((thresholds.collectionInterval >= 60) && (thresholds.heartbeatInterval >= thresholds.collectionInterval))) {
+        return false;
+    }
+    if (AlertScheduler::heartbeatIntervalValid(thresholds.heartbeatInterval) == false) {
+        return false;
+    }
+
+    return true;
+}   // END config_validate
+
+
+// 
+void config_save(void) {
+    struct persistedConfig config;
+
+    config.magic                = CONFIG_MAGIC;
+    config.dipSwitches          = activeProfile.dipSwitches;
+    config.tempLow              = activeProfile.thresholds.tempLow;
+    config.tempHigh             = activeProfile.thresholds.tempHigh;
+    config.tempDelta            = activeProfile.thresholds.tempDelta;
+    config.battLow              = activeProfile.thresholds.battLow;
+    config.collectionInterval   = activeProfile.thresholds.collectionInterval;
+    config.heartbeatInterval    = activeProfile.thresholds.heartbeatInterval;
+
+    EEPROM.put(CONFIG_EEPROM_ADDR, config);
+}   // END config_save
+
+
+// Restore a remote configuration written under the current DIP switch settings, if any.
+void config_load(void) {
+    struct persistedConfig      config;
+    struct thresholdProfile     thresholds;
+
+    EEPROM.get(CONFIG_EEPROM_ADDR, config);
+    if ((config.magic != CONFIG_MAGIC) || (config.dipSwitches != activeProfile.dipSwitches)) {
+        return;
+    }
+
+    thresholds.name                 = "REMOTE";
+    thresholds.tempLow              = config.tempLow;
+    thresholds.tempHigh             = config.tempHigh;
+    thresholds.tempDelta            = config.tempDelta;
+    thresholds.battLow              = config.battLow;
+    thresholds.collectionInterval   = config.collectionInterval;
+    thresholds.heartbeatInterval    = config.heartbeatInterval;
+
+    if (config_validate(thresholds) == false) {
+        return;
+    }
+
+    activeProfile.thresholds = thresholds;
+    apply_config_profile(activeProfile);
+}   // END config_load
+
+
+// "envJson" cloud variable.  Current interval readings, built on request only.
+String env_json(void) {
+    JsonWriterStatic<STATUS_JSON_MAX> jw;
+
+    jw.setFloatPlaces(2);
+    json_write_object(jw, environmentDataInterval, environmentDataSchema);
+
+    return String(jw.getBuffer());
+}   // END env_json
+
+
+// "config" cloud variable.  Active thresholds in the same form configure() accepts, plus their source.
+String config_json(void) {
+    JsonWriterStatic<STATUS_JSON_MAX> jw;
+
+    jw.setFloatPlaces(2);
+    {
+        JsonWriterAutoObject obj(&jw);
+
+        json_write_fields(jw, activeProfile.thresholds, thresholdSchema);
+        jw.insertKeyValue("profile", activeProfile.thresholds.name);
+        jw.insertKeyValue("dip", (int)activeProfile.dipSwitches);
+    }
+
+    return String(jw.getBuffer());
+}   // END config_json
+
+
+// "probes" cloud variable.  Interval reading per named channel, in °F; null if the probe did not answer.
+// e.g. {"crawlspace":38.75,"pipe chase":null}
+String probes_json(void) {
+    JsonWriterStatic<STATUS_JSON_MAX> jw;
+
+    jw.setFloatPlaces(2);
+    {
+        JsonWriterAutoObject obj(&jw);
+
+        for (uint8_t i = 0; i < probeReadings.count; i++) {
+            if (probeReadings.valid[i] == true) {
+                jw.insertKeyValue(tempProbes.getChannel(i).name, C_TO_F(probeReadings.temperatureC[i]));
+            }
+            else
+            {
+                jw.insertKeyJson(tempProbes.getChannel(i).name, "null");
+            }
+        }
+    }
+
+    return String(jw.getBuffer());
+}   // END probes_json
+
+
 //
 String power_source_cast(int intPowerSource) {
     // https://docs.particle.io/cards/firmware/system-calls/powersource/
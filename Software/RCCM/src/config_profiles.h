@@ -0,0 +1,95 @@
+#ifndef CONFIG_PROFILES_H_
+#define CONFIG_PROFILES_H_
+
+// DIP switch selected configuration profiles.
+// Read once in setup() and copied into the working thresholds; loop() never touches the switches.
+//
+//  DIP 1-2     Threshold Profile   (see thresholdProfiles[])
+//  DIP 3-4     Publish Policy      (see publishPolicy)
+//  DIP 5       Cabin Occupancy     (OFF = expected vacant, ON = occupied; no OCCUPANCY alerts)
+//
+// Switches are active low (INPUT_PULLUP); a switch turned ON reads as a 1 bit here.
+// All switches OFF selects the STATIC CONFIGURATION defaults from RCCM.ino.
+
+
+// Where alerts go.
+enum publishPolicy : uint8_t {
+    PUBLISH_SMS_BOTH        = 0,    // SMS to A & B
+    PUBLISH_SMS_A           = 1,    // SMS to A only
+    PUBLISH_SMS_B           = 2,    // SMS to B only
+    PUBLISH_EVENT_ONLY      = 3,    // Cloud event only, no SMS
+};
+
+// Thresholds & timing.
+struct thresholdProfile {
+    const char  *name;
+    float       tempLow;
+    float       tempHigh;
+    float       tempDelta;
+    float       battLow;
+    long        collectionInterval;     // s
+    long        heartbeatInterval;      // s
+};
+
+// Fully resolved profile.
+struct configProfile {
+    uint8_t                 dipSwitches;
+    struct thresholdProfile thresholds;
+    publishPolicy           policy;
+    bool                    expectVacant;
+};
+
+
+// Threshold Profiles
+static constexpr struct thresholdProfile thresholdProfiles[4] = {
+    // Name         Low                 High                Delta               Batt                Collect                         Heartbeat
+    { "STANDARD",   THRESH_TEMP_LOW,    THRESH_TEMP_HIGH,   THRESH_TEMP_DELTA,  THRESH_BATT_LOW,    INTERNAL_COLLECTION_INTERVAL,   HEARTBEAT_INTERVAL  },
+    { "WINTERIZED", 20,                 THRESH_TEMP_HIGH,   THRESH_TEMP_DELTA,  THRESH_BATT_LOW,    (60*30),                        HEARTBEAT_INTERVAL  },  // Drained cabin; deep freeze only
+    { "IN_SEASON",  45,                 90,                 THRESH_TEMP_DELTA,  THRESH_BATT_LOW,    INTERNAL_COLLECTION_INTERVAL,   HEARTBEAT_INTERVAL  },
+    { "BENCH_TEST", THRESH_TEMP_LOW,    THRESH_TEMP_HIGH,   THRESH_TEMP_DELTA,  THRESH_BATT_LOW,    (60*1),                         (60*60)             },  // 1 Minute / 1 Hour
+};
+
+
+// Map a 5-bit switch field to a profile.  Pure & constexpr; every combination is valid.
+static constexpr struct configProfile config_profile_resolve(uint8_t dipSwitches) {
+    return configProfile {
+        (uint8_t)(dipSwitches & 0x1F),
+        thresholdProfiles[dipSwitches & 0x03],
+        (publishPolicy)((dipSwitches >> 2) & 0x03),
+        ((dipSwitches & 0x10) == 0),
+    };
+}
+
+// Every switch combination, checked at compile time: decodes each field from its own bits and lands on a
+// profile that config_validate() would accept.
+static constexpr bool config_profiles_valid(void) {
+    for (uint8_t dip = 0x00; dip <= 0x1F; dip++) {
+        const struct configProfile profile = config_profile_resolve(dip);
+
+        if ((profile.dipSwitches != dip) ||
+            (profile.thresholds.name != thresholdProfiles[dip & 0x03].name) ||
+            (profile.policy != ((dip >> 2) & 0x03)) ||
+            (profile.expectVacant != ((dip & 0x10) == 0))) {
+            return false;
+        }
+        if ((profile.thresholds.tempLow < -40) || (profile.thresholds.tempHigh > 150) ||
+            (profile.thresholds.tempLow >= profile.thresholds.tempHigh) ||
+            (profile.thresholds.tempDelta < 0) ||
+            (profile.thresholds.battLow < 0) || (profile.thresholds.battLow > 100) ||
+            (profile.thresholds.collectionInterval < 60) ||
+            (profile.thresholds.heartbeatInterval < profile.thresholds.collectionInterval) ||
+            // Whole days or a divisor of a day, as AlertScheduler::heartbeatIntervalValid()
+            (((profile.thresholds.heartbeatInterval % 86400) != 0) && ((86400 % profile.thresholds.heartbeatInterval) != 0))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(config_profiles_valid(), "Every DIP switch combination must resolve to a valid profile.");
+static_assert(config_profile_resolve(0x00).thresholds.collectionInterval == INTERNAL_COLLECTION_INTERVAL, "All switches OFF must select the static defaults.");
+static_assert(config_profile_resolve(0x00).policy == PUBLISH_SMS_BOTH, "All switches OFF must SMS both numbers.");
+static_assert(config_profile_resolve(0x00).expectVacant == true, "All switches OFF must expect a vacant cabin.");
+
+
+#endif // CONFIG_PROFILES_H_
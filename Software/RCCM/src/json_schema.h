@@ -0,0 +1,160 @@
+#ifndef JSON_SCHEMA_H_
+#define JSON_SCHEMA_H_
+
+// Compile-time JSON binding for plain structs.
+// A schema is a tuple of (key, member pointer) fields; json_write_object() / json_read_object() expand it
+// into straight-line insert / compare code per struct.  No key table is walked at run time and nothing is virtual.
+//
+//  static constexpr auto fooSchema = json_schema(
+//      json_field("tempF",     &foo::temperatureF),
+//      json_field("interval",  &foo::collectionInterval)
+//  );
+//
+// Keys must be plain ASCII (no quotes, backslashes or control characters); they are written without escaping.
+
+#include <JsonParserGeneratorRK.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+// json_read_object() results.
+#define JSON_SCHEMA_OK              0
+#define JSON_SCHEMA_BAD_DOCUMENT    -1      // Not an object
+#define JSON_SCHEMA_BAD_VALUE       -2      // Unknown key, or value of the wrong type
+
+
+// One key <-> member binding.  KEY_SIZE includes the terminator, so key lengths are compile-time constants.
+template <class S, class T, size_t KEY_SIZE>
+struct jsonField {
+    const char  *key;
+    T S::*      member;
+};
+
+template <class S, class T, size_t KEY_SIZE>
+constexpr jsonField<S, T, KEY_SIZE> json_field(const char (&key)[KEY_SIZE], T S::*member) {
+    return jsonField<S, T, KEY_SIZE> { key, member };
+}
+
+template <class... F>
+constexpr std::tuple<F...> json_schema(F... fields) {
+    return std::tuple<F...>(fields...);
+}
+
+
+// === WRITE ===
+template <class S, class T, size_t KEY_SIZE>
+inline void json_write_field(JsonWriter &jw, const S &s, const jsonField<S, T, KEY_SIZE> &field) {
+    // Equivalent to insertKeyValue(), with the key copied as-is and the value passed by reference.
+    jw.insertCheckSeparator();
+    jw.insertChar('"');
+    jw.insertData(field.key, KEY_SIZE - 1);
+    jw.insertData("\":", 2);
+    jw.insertValue(s.*field.member);
+}
+
+template <class S, class Schema, size_t... I>
+inline void json_write_fields(JsonWriter &jw, const S &s, const Schema &schema, std::index_sequence<I...>) {
+    (void) std::initializer_list<int> { (json_write_field(jw, s, std::get<I>(schema)), 0)... };
+}
+
+// Insert every schema field of s as key/value pairs into the object currently open in jw.
+template <class S, class... F>
+inline void json_write_fields(JsonWriter &jw, const S &s, const std::tuple<F...> &schema) {
+    json_write_fields(jw, s, schema, std::index_sequence_for<F...>());
+}
+
+// Write s as a complete object.
+template <class S, class... F>
+inline void json_write_object(JsonWriter &jw, const S &s, const std::tuple<F...> &schema) {
+    JsonWriterAutoObject obj(&jw);
+    json_write_fields(jw, s, schema);
+}
+
+
+// === READ ===
+// Type conversion for member types JsonParser::getTokenValue() has no overload for.
+template <class T>
+inline bool json_read_value(const JsonParser &jp, const JsonParserGeneratorRK::jsmntok_t *token, T &value) {
+    return jp.getTokenValue(token, value);
+}
+
+inline bool json_read_value(const JsonParser &jp, const JsonParserGeneratorRK::jsmntok_t *token, long &value) {
+    int intValue;
+    if (!jp.getTokenValue(token, intValue)) {
+        return false;
+    }
+    value = intValue;
+    return true;
+}
+
+// Fixed size strings.  Too long to fit (with the terminator) is a bad value rather than silently truncated.
+template <size_t N>
+inline bool json_read_value(const JsonParser &jp, const JsonParserGeneratorRK::jsmntok_t *token, char (&value)[N]) {
+    size_t length = N;
+
+    if ((token->type != JsonParserGeneratorRK::JSMN_STRING) || ((size_t)(token->end - token->start) >= N)) {
+        return false;
+    }
+    return jp.getTokenValue(token, value, length);
+}
+
+template <class S, class T, size_t KEY_SIZE>
+inline bool json_read_field(const JsonParser &jp, const JsonParserGeneratorRK::jsmntok_t *keyToken, const JsonParserGeneratorRK::jsmntok_t *valueToken, S &s, const jsonField<S, T, KEY_SIZE> &field, int &result) {
+    // Length first; it's a constant, so most keys are rejected without touching the buffer.
+    if (((size_t)(keyToken->end - keyToken->start) != (KEY_SIZE - 1)) || (memcmp(&jp.getBuffer()[keyToken->start], field.key, KEY_SIZE - 1) != 0)) {
+        return false;
+    }
+    // Numbers & bools must be bare primitives, not strings that happen to parse.
+    if (std::is_arithmetic<T>::value && (valueToken->type != JsonParserGeneratorRK::JSMN_PRIMITIVE)) {
+        result = JSON_SCHEMA_BAD_VALUE;
+        return true;
+    }
+    result = json_read_value(jp, valueToken, s.*field.member) ? JSON_SCHEMA_OK : JSON_SCHEMA_BAD_VALUE;
+    return true;
+}
+
+template <class S, class Schema, size_t... I>
+inline int json_read_key(const JsonParser &jp, const JsonParserGeneratorRK::jsmntok_t *keyToken, const JsonParserGeneratorRK::jsmntok_t *valueToken, S &s, const Schema &schema, std::index_sequence<I...>) {
+    int     result = JSON_SCHEMA_BAD_VALUE;
+    bool    found = false;
+
+    // Stops at the first field whose key matches.
+    (void) std::initializer_list<int> { (found = found || json_read_field(jp, keyToken, valueToken, s, std::get<I>(schema), result), 0)... };
+    return result;
+}
+
+// Read the key/value pairs of object into s.  Keys not present leave their member unchanged.
+// Keys must not contain escapes; they are compared against the raw document.
+// Stops at the first unknown key or bad value, so s may be partly updated on failure; read into a copy to apply atomically.
+template <class S, class... F>
+inline int json_read_object(const JsonParser &jp, const JsonParserGeneratorRK::jsmntok_t *object, S &s, const std::tuple<F...> &schema) {
+    const JsonParserGeneratorRK::jsmntok_t *keyToken;
+    const JsonParserGeneratorRK::jsmntok_t *valueToken;
+
+    if ((object == 0) || (object->type != JsonParserGeneratorRK::JSMN_OBJECT)) {
+        return JSON_SCHEMA_BAD_DOCUMENT;
+    }
+
+    // One walk over the pairs; skipObject() steps over each value (a single jump with the sibling index enabled).
+    keyToken = object + 1;
+    for (int ii = 0; ii < object->size; ii++) {
+        valueToken = keyToken;
+        if (jp.skipObject(object, valueToken) == false) {
+            return JSON_SCHEMA_BAD_DOCUMENT;
+        }
+
+        int result = json_read_key(jp, keyToken, valueToken, s, schema, std::index_sequence_for<F...>());
+        if (result != JSON_SCHEMA_OK) {
+            return result;
+        }
+
+        keyToken = valueToken;
+        jp.skipObject(object, keyToken);        // false after the last pair
+    }
+
+    return JSON_SCHEMA_OK;
+}
+
+
+#endif // JSON_SCHEMA_H_
@@ -0,0 +1,72 @@
+#ifndef TEST_JSON_CORPUS_H
+#define TEST_JSON_CORPUS_H
+
+// Generated JSON documents for the JsonParserGeneratorRK tests.
+
+#include <random>
+#include <string>
+
+// A random value, nested up to 5 levels.  Object keys are "k0".."k<keySpread - 1>", so duplicate & missing keys
+// both occur; escapedKeys occasionally spells one as "k1" (which a raw compare must not match).
+static inline std::string json_random_value(std::mt19937 &rng, int depth = 0, int keySpread = 6, bool escapedKeys = false) {
+    int kind = (depth > 4) ? (int)(rng() % 3) : (int)(rng() % 6);
+    std::string s;
+
+    switch (kind) {
+        case 0:
+            return std::to_string((int)(rng() % 2000) - 1000);
+        case 1:
+            return "\"s" + std::to_string(rng() % 100) + "\"";
+        case 2:
+            return (rng() % 2) ? "true" : "null";
+        case 3: {
+            int n = rng() % 6;
+            s = "[";
+            for (int i = 0; i < n; i++) {
+                if (i > 0) s += ",";
+                s += json_random_value(rng, depth + 1, keySpread, escapedKeys);
+            }
+            return s + "]";
+        }
+        default: {
+            int n = rng() % 8;
+            s = "{";
+            for (int i = 0; i < n; i++) {
+                if (i > 0) s += ",";
+                if ((escapedKeys == true) && (rng() % 20 == 0)) {
+                    s += "\"k\\u0031\":";
+                }
+                else
+                {
+                    s += "\"k" + std::to_string(rng() % keySpread) + "\":";
+                }
+                s += json_random_value(rng, depth + 1, keySpread, escapedKeys);
+            }
+            return s + "}";
+        }
+    }
+}
+
+// A random object at the top level, as webhook responses are.
+static inline std::string json_random_document(std::mt19937 &rng, int keySpread = 6, bool escapedKeys = false) {
+    std::string s = "{";
+    int n = 1 + rng() % 8;
+    for (int i = 0; i < n; i++) {
+        if (i > 0) s += ",";
+        s += "\"k" + std::to_string(rng() % keySpread) + "\":" + json_random_value(rng, 1, keySpread, escapedKeys);
+    }
+    return s + "}";
+}
+
+// A webhook-response-like document of roughly the given size: an array of flat records.
+static inline std::string json_records(size_t approxBytes) {
+    std::string s = "{\"ok\":true,\"records\":[";
+    for (int i = 0; s.size() < approxBytes; i++) {
+        if (i > 0) s += ",";
+        s += "{\"id\":" + std::to_string(1000 + i) + ",\"name\":\"cabin " + std::to_string(i) +
+             "\",\"tempF\":" + std::to_string(40 + i % 50) + ".5,\"alarm\":" + ((i % 7 == 0) ? "true" : "false") + "}";
+    }
+    return s + "]}";
+}
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef TEST_SHIM_PARTICLE_H
+#define TEST_SHIM_PARTICLE_H
+
+// Host stand-in for the subset of Device OS the RCCM libraries use.  Not a model of the platform: time is a
+// virtual clock the test advances (delay() & delayMicroseconds() advance it too), and pins, ADC, I2C & 1-Wire
+// are hooks a test (or one of the bus models in this directory) fills in.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <time.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#define PLATFORM_ID     12          // Argon; selects the nRF52 paths in OneWire
+#define HIGH            1
+#define LOW             0
+#define TRUE            1
+#define FALSE           0
+
+typedef bool boolean;
+enum InterruptMode { CHANGE, RISING, FALLING };
+enum PinMode { INPUT, OUTPUT, INPUT_PULLUP, INPUT_PULLDOWN };
+
+enum {
+    POWER_SOURCE_UNKNOWN = 0, POWER_SOURCE_VIN = 1, POWER_SOURCE_USB_HOST = 2, POWER_SOURCE_USB_ADAPTER = 3,
+    POWER_SOURCE_USB_OTG = 4, POWER_SOURCE_BATTERY = 5
+};
+
+
+namespace host {
+
+// Virtual clock.  Microseconds since boot; Time.now() is separate so tests can move the wall clock alone.
+inline uint64_t     nowUs = 1000000;
+inline uint64_t     delayedUs = 0;          // Total time spent in delay() / delayMicroseconds()
+inline time_t       unixTime = 0;
+inline bool         timeValid = true;
+inline uint64_t     timeNowCalls = 0;       // Time.now() calls, for per-call work checks
+
+inline void advanceUs(uint64_t us) { nowUs += us; }
+inline void advanceMs(uint64_t ms) { nowUs += ms * 1000; }
+
+// Pins.  Unset hooks read as idle (high) / mid-scale.
+inline std::function<int32_t(uint16_t)>         analogRead;
+inline std::function<int32_t(uint16_t)>         digitalRead;
+inline std::function<void(uint16_t, bool)>      fastWrite;      // pinSetFast / pinResetFast
+inline std::function<int32_t(uint16_t)>         fastRead;       // pinReadFast
+inline std::function<void(uint16_t, PinMode)>   fastMode;       // HAL_Pin_Mode
+
+// Interrupt masking, as counted by the test.
+inline int          irqDepth = 0;
+inline uint64_t     irqOffCount = 0;
+inline uint64_t     irqOffAt = 0;
+inline uint64_t     irqOffMaxUs = 0;
+
+// Attached ISRs, by pin.  fire() runs one as if the edge had arrived.
+inline std::function<void(void)>    isr[32];
+inline void fire(uint16_t pin) { if (pin < 32 && isr[pin]) isr[pin](); }
+
+// Published events, oldest first.
+struct publishedEvent { std::string name; std::string data; uint64_t atUs; };
+inline std::vector<publishedEvent>  published;
+inline std::function<bool(const char *, const char *)> onPublish;
+
+}
+
+
+// === TIMING ===
+inline uint32_t millis() { return (uint32_t)(host::nowUs / 1000); }
+inline uint32_t micros() { return (uint32_t)host::nowUs; }
+inline void delay(uint32_t ms) { host::nowUs += (uint64_t)ms * 1000; host::delayedUs += (uint64_t)ms * 1000; }
+inline void delayMicroseconds(uint32_t us) { host::nowUs += us; host::delayedUs += us; }
+
+
+// === PINS ===
+inline void pinMode(uint16_t, PinMode) {}
+inline int32_t digitalRead(uint16_t pin) { return host::digitalRead ? host::digitalRead(pin) : HIGH; }
+inline void digitalWrite(uint16_t, uint8_t) {}
+inline int32_t analogRead(uint16_t pin) { return host::analogRead ? host::analogRead(pin) : 2048; }
+inline void pinResetFast(uint16_t pin) { if (host::fastWrite) host::fastWrite(pin, false); }
+inline void pinSetFast(uint16_t pin) { if (host::fastWrite) host::fastWrite(pin, true); }
+inline int32_t pinReadFast(uint16_t pin) { return host::fastRead ? host::fastRead(pin) : HIGH; }
+inline void HAL_Pin_Mode(uint16_t pin, PinMode mode) { if (host::fastMode) host::fastMode(pin, mode); }
+
+
+// === INTERRUPTS ===
+inline void noInterrupts() {
+    if (host::irqDepth++ == 0) {
+        host::irqOffAt = host::nowUs;
+        host::irqOffCount++;
+    }
+}
+inline void interrupts() {
+    if (--host::irqDepth == 0) {
+        host::irqOffMaxUs = std::max(host::irqOffMaxUs, host::nowUs - host::irqOffAt);
+    }
+}
+#define ATOMIC_BLOCK()              for (int _atomic = (noInterrupts(), 1); _atomic; _atomic = (interrupts(), 0))
+#define SINGLE_THREADED_BLOCK()     for (int _single = 1; _single; _single = 0)
+
+template <class T>
+inline bool attachInterrupt(uint16_t pin, void (T::*handler)(), T *instance, InterruptMode, int8_t = -1, uint8_t = 0) {
+    host::isr[pin] = [=]() { (instance->*handler)(); };
+    return true;
+}
+inline bool attachInterrupt(uint16_t pin, void (*handler)(), InterruptMode, int8_t = -1, uint8_t = 0) {
+    host::isr[pin] = handler;
+    return true;
+}
+inline void detachInterrupt(uint16_t pin) { host::isr[pin] = nullptr; }
+
+
+// === STRING ===
+class String {
+public:
+    std::string s;
+
+    String() {}
+    String(const char *c) : s(c ? c : "") {}
+    String(const char *c, unsigned n) : s(c, n) {}
+    String(const String &o) = default;
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned v) : s(std::to_string(v)) {}
+    String(long v) : s(std::to_string(v)) {}
+    String(unsigned long v) : s(std::to_string(v)) {}
+    String &operator=(const String &o) = default;
+    String &operator=(const char *c) { s = c; return *this; }
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned length() const { return s.size(); }
+    char charAt(unsigned i) const { return s[i]; }
+    bool reserve(unsigned n) { s.reserve(n); return true; }
+
+    bool operator==(const char *c) const { return s == c; }
+    bool operator==(const String &o) const { return s == o.s; }
+    bool operator!=(const char *c) const { return s != c; }
+    String &operator+=(const String &o) { s += o.s; return *this; }
+    String &operator+=(const char *o) { s += o; return *this; }
+    String &operator+=(char c) { s += c; return *this; }
+    bool concat(char c) { s += c; return true; }
+    bool concat(const char *c) { s += c; return true; }
+    bool concat(const String &o) { s += o.s; return true; }
+
+    String substring(unsigned a, unsigned b) const { return String(s.substr(a, b - a).c_str()); }
+    String substring(unsigned a) const { return String(s.substr(a).c_str()); }
+    int indexOf(char c) const { size_t p = s.find(c); return (p == std::string::npos) ? -1 : (int)p; }
+    int toInt() const { return atoi(s.c_str()); }
+
+    static String format(const char *fmt, ...) {
+        char buf[1024];
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(buf, sizeof(buf), fmt, ap);
+        va_end(ap);
+        return String(buf);
+    }
+};
+
+
+// === STREAMS ===
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buf, size_t n) { for (size_t i = 0; i < n; i++) write(buf[i]); return n; }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() { return -1; }
+    virtual int availableForWrite() { return 1 << 20; }
+};
+
+
+// === EEPROM ===
+struct EEPROMClass {
+    uint8_t mem[4096];
+
+    EEPROMClass() { memset(mem, 0xFF, sizeof(mem)); }
+    template <class T> T &get(int addr, T &t) { memcpy(&t, mem + addr, sizeof(T)); return t; }
+    template <class T> const T &put(int addr, const T &t) { memcpy(mem + addr, &t, sizeof(T)); return t; }
+    void clear() { memset(mem, 0xFF, sizeof(mem)); }
+};
+inline EEPROMClass EEPROM;
+
+
+// === TIME ===
+#define TIME_FORMAT_DEFAULT         "asctime"
+#define TIME_FORMAT_ISO8601_FULL    "%Y-%m-%dT%H:%M:%S%z"
+
+struct TimeClass {
+    time_t now() { host::timeNowCalls++; return host::unixTime; }
+    bool isValid() { return host::timeValid; }
+    String timeStr(time_t t) { char buf[32]; struct tm tm; gmtime_r(&t, &tm); strftime(buf, sizeof(buf), "%a %b %e %H:%M:%S %Y", &tm); return String(buf); }
+    String format(time_t t, const char *fmt) { char buf[64]; struct tm tm; gmtime_r(&t, &tm); strftime(buf, sizeof(buf), fmt, &tm); return String(buf); }
+};
+inline TimeClass Time;
+
+
+// === CLOUD ===
+struct CloudClass {
+    bool publish(const char *name, const char *data) {
+        host::published.push_back({ name, data ? data : "", host::nowUs });
+        return host::onPublish ? host::onPublish(name, data) : true;
+    }
+    bool publish(const char *name) { return publish(name, ""); }
+    bool publish(const String &name, const String &data) { return publish(name.c_str(), data.c_str()); }
+    template <class T> bool variable(const char *, T) { return true; }
+    template <class T> bool function(const char *, T) { return true; }
+};
+inline CloudClass Particle;
+
+
+// === I2C ===
+// One device model per test; see si7021_model.h.
+struct TwoWireDevice {
+    virtual ~TwoWireDevice() {}
+    virtual bool command(const std::vector<uint8_t> &tx) = 0;      // false = NACK
+    virtual std::vector<uint8_t> read(size_t n) = 0;                // fewer than n = NACK
+};
+
+namespace host {
+inline TwoWireDevice    *i2cDevice = nullptr;
+}
+
+struct TwoWire {
+    std::vector<uint8_t>    tx;
+    std::vector<uint8_t>    rx;
+    size_t                  rxPos = 0;
+
+    void begin() {}
+    void beginTransmission(int) { tx.clear(); }
+    size_t write(uint8_t b) { tx.push_back(b); return 1; }
+    uint8_t endTransmission(bool = true) { return (host::i2cDevice && host::i2cDevice->command(tx)) ? 0 : 2; }
+    uint8_t requestFrom(int, int n) {
+        rx = host::i2cDevice ? host::i2cDevice->read(n) : std::vector<uint8_t>();
+        rxPos = 0;
+        return (uint8_t)rx.size();
+    }
+    int read() { return (rxPos < rx.size()) ? rx[rxPos++] : -1; }
+};
+inline TwoWire Wire;
+
+#endif
@@ -0,0 +1,361 @@
+#ifndef TEST_SHIM_ONEWIRE_MODEL_H
+#define TEST_SHIM_ONEWIRE_MODEL_H
+
+// Bit level 1-Wire bus for the host tests.  The master is the real OneWire.cpp driving the pin through the shim's
+// fast pin hooks; every edge is timestamped on host::nowUs (delayMicroseconds() advances it) and each slave decodes
+// slots by the width of the low pulse, as a DS18B20 would.  Timing outside the datasheet limits is counted in
+// onewire_model::violations rather than failing the transfer.
+//
+//   onewire_model::attach();
+//   onewire_model::devices.push_back(onewire_model::Device::ds18b20(1, 21.5));
+
+#include "Particle.h"
+
+namespace onewire_model {
+
+struct Violations {
+    uint64_t    ambiguous;          // Low pulse between a 1 and a 0
+    uint64_t    slotShort;          // Slot started before the previous one's minimum length
+    uint64_t    recovery;           // No recovery time after a slot
+    uint64_t    resetShort;         // Reset pulse below 480 us at standard speed
+    uint64_t    resetRecovery;      // Slot started before the presence window ended
+    uint64_t    conversionCut;      // Bus driven low while a parasite powered probe converts
+};
+inline Violations   violations = {};
+inline uint64_t     slots = 0;
+inline uint64_t     resets = 0;
+
+inline uint8_t crc8(const uint8_t *p, int n) {
+    uint8_t crc = 0;
+    while (n--) {
+        uint8_t b = *p++;
+        for (int i = 0; i < 8; i++) {
+            uint8_t mix = (crc ^ b) & 1;
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+// One slave.  The function layer is a DS18B20's: Convert T, Read / Write / Copy Scratchpad, Recall E2.
+struct Device {
+    uint8_t     rom[8];
+    double      tempC = 20.0;
+    bool        connected = true;
+    bool        parasite = false;           // Powered from the data line; needs the strong pull-up while converting
+    bool        supportsOverdrive = true;
+    int         corruptReads = 0;           // Flip a bit in the next N scratchpad reads
+    uint8_t     scratch[9] = { 0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0 };
+    uint8_t     eeprom[3] = { 0x4B, 0x46, 0x7F };
+    bool        alarm = false;
+    bool        overdrive = false;
+    uint64_t    converts = 0;
+    uint64_t    scratchReads = 0;
+    uint64_t    scratchWrites = 0;
+    uint64_t    convertingUntil = 0;
+
+    enum State { IDLE, ROM_CMD, MATCH, SEARCH, FUNC_CMD, WRITE_SP, TX, DONE } state = IDLE;
+    uint32_t    acc = 0;
+    int         accBits = 0;
+    uint8_t     matchBuf[8];
+    int         matchBits = 0;
+    int         searchBit = 0;
+    int         searchPhase = 0;
+    std::vector<uint8_t> tx;
+    size_t      txBit = 0;
+    uint8_t     wsp[3];
+    int         wspBytes = 0;
+    uint64_t    holdFrom = 0;
+    uint64_t    holdUntil = 0;
+
+    Device(const uint8_t *r) {
+        memcpy(rom, r, 8);
+        scratch[8] = crc8(scratch, 8);
+    }
+    static Device ds18b20(uint8_t serial, double t) {
+        uint8_t r[8] = { 0x28, serial, (uint8_t)(serial * 7), 0x5A, 0x01, 0x00, 0x00, 0 };
+        r[7] = crc8(r, 7);
+        Device d(r);
+        d.tempC = t;
+        return d;
+    }
+
+    int resolutionBits() const { return 9 + ((scratch[4] >> 5) & 3); }
+    uint64_t conversionUs() const { return 93750ULL << (resolutionBits() - 9); }
+
+    void convert() {
+        converts++;
+        convertingUntil = host::nowUs + conversionUs();
+        int16_t raw = (int16_t)lround(tempC * 16.0);
+        int drop = 12 - resolutionBits();
+        raw &= (int16_t)~((1 << drop) - 1);
+        scratch[0] = raw & 0xFF;
+        scratch[1] = (raw >> 8) & 0xFF;
+        scratch[8] = crc8(scratch, 8);
+        int whole = raw >> 4;           // The alarm compares the integer part
+        alarm = (whole >= (int8_t)scratch[2]) || (whole <= (int8_t)scratch[3]);
+    }
+    // The strong pull-up went away mid conversion: the part browns out to its power on state.
+    void brownOut() {
+        int16_t raw = 85 * 16;
+        scratch[0] = raw & 0xFF;
+        scratch[1] = (raw >> 8) & 0xFF;
+        memcpy(&scratch[2], eeprom, 3);
+        scratch[8] = crc8(scratch, 8);
+        convertingUntil = 0;
+        state = IDLE;
+    }
+
+    void startTx(const uint8_t *p, int n) {
+        tx.assign(p, p + n);
+        txBit = 0;
+        state = TX;
+    }
+    bool txCurrent() const { return (tx[txBit / 8] >> (txBit % 8)) & 1; }
+
+    // Master falling edge: hold the line low through the sample point to send a 0.
+    void slotStart(uint64_t t0) {
+        if (!connected) return;
+        int bit = -1;
+        if (state == TX && txBit < tx.size() * 8) {
+            bit = txCurrent();
+        }
+        else if (state == SEARCH && searchPhase < 2) {
+            int b = (rom[searchBit / 8] >> (searchBit % 8)) & 1;
+            bit = (searchPhase == 0) ? b : !b;
+        }
+        if (bit == 0) {
+            holdFrom = t0;
+            holdUntil = t0 + (overdrive ? 2 : 15);
+        }
+    }
+
+    // Master rising edge: take a bit if listening.
+    void slotEnd(uint64_t t0, uint64_t t1) {
+        if (!connected) return;
+        uint64_t low = t1 - t0;
+        uint64_t zeroMin = overdrive ? 6 : 60, oneMax = overdrive ? 2 : 15;
+        int bit;
+        if (low >= zeroMin) {
+            bit = 0;
+        }
+        else if (low <= oneMax) {
+            bit = 1;
+        }
+        else {
+            violations.ambiguous++;
+            bit = (low >= (overdrive ? 3u : 30u)) ? 0 : 1;
+        }
+
+        if (state == TX) {
+            if (txBit < tx.size() * 8) txBit++;
+            return;
+        }
+        if (state == SEARCH) {
+            if (searchPhase < 2) {
+                searchPhase++;
+                return;
+            }
+            int b = (rom[searchBit / 8] >> (searchBit % 8)) & 1;
+            if (bit != b) {
+                state = IDLE;
+                return;
+            }
+            searchPhase = 0;
+            if (++searchBit == 64) {
+                state = FUNC_CMD;
+                acc = 0;
+                accBits = 0;
+            }
+            return;
+        }
+        if (state == MATCH) {
+            if (bit) matchBuf[matchBits / 8] |= 1 << (matchBits % 8);
+            if (++matchBits == 64) {
+                state = (memcmp(matchBuf, rom, 8) == 0) ? FUNC_CMD : IDLE;
+                acc = 0;
+                accBits = 0;
+            }
+            return;
+        }
+        if (state == ROM_CMD || state == FUNC_CMD || state == WRITE_SP) {
+            acc |= (uint32_t)bit << accBits;
+            if (++accBits < 8) return;
+            uint8_t byte = acc;
+            acc = 0;
+            accBits = 0;
+            if (state == WRITE_SP) {
+                wsp[wspBytes++] = byte;
+                if (wspBytes == 3) {
+                    scratch[2] = wsp[0];
+                    scratch[3] = wsp[1];
+                    scratch[4] = (wsp[2] & 0x60) | 0x1F;
+                    scratch[8] = crc8(scratch, 8);
+                    scratchWrites++;
+                    state = DONE;
+                }
+            }
+            else if (state == ROM_CMD) {
+                romCommand(byte);
+            }
+            else {
+                functionCommand(byte);
+            }
+        }
+    }
+
+    void romCommand(uint8_t cmd) {
+        switch (cmd) {
+            case 0x33: startTx(rom, 8); break;
+            case 0x55: memset(matchBuf, 0, 8); matchBits = 0; state = MATCH; break;
+            case 0xCC: state = FUNC_CMD; break;
+            case 0x3C:
+                if (supportsOverdrive) { overdrive = true; state = FUNC_CMD; } else state = IDLE;
+                break;
+            case 0x69:
+                if (supportsOverdrive) { overdrive = true; memset(matchBuf, 0, 8); matchBits = 0; state = MATCH; } else state = IDLE;
+                break;
+            case 0xF0: searchBit = 0; searchPhase = 0; state = SEARCH; break;
+            case 0xEC:
+                if (alarm) { searchBit = 0; searchPhase = 0; state = SEARCH; } else state = IDLE;
+                break;
+            default: state = IDLE;
+        }
+    }
+
+    void functionCommand(uint8_t cmd) {
+        switch (cmd) {
+            case 0x44: convert(); state = DONE; break;
+            case 0xBE: {
+                scratchReads++;
+                uint8_t sp[9];
+                memcpy(sp, scratch, 9);
+                if (corruptReads > 0) {
+                    corruptReads--;
+                    sp[0] ^= 0x04;
+                }
+                startTx(sp, 9);
+                break;
+            }
+            case 0x4E: wspBytes = 0; state = WRITE_SP; break;
+            case 0x48: memcpy(eeprom, &scratch[2], 3); state = DONE; break;
+            case 0xB8: memcpy(&scratch[2], eeprom, 3); scratch[8] = crc8(scratch, 8); state = DONE; break;
+            default: state = IDLE;
+        }
+    }
+
+    void reset(uint64_t low, uint64_t t1, uint64_t &presenceFrom, uint64_t &presenceUntil) {
+        if (!connected) return;
+        if (low >= 480) {
+            overdrive = false;
+        }
+        else if (!(overdrive && low >= 48)) {
+            state = IDLE;
+            return;
+        }
+        state = ROM_CMD;
+        acc = 0;
+        accBits = 0;
+        presenceFrom = t1 + (overdrive ? 2 : 30);
+        presenceUntil = presenceFrom + (overdrive ? 8 : 90);
+    }
+};
+
+inline std::vector<Device>  devices;
+
+// Master side of the line, and the bus timing state.
+inline bool         masterOutput = false;
+inline bool         masterHigh = true;
+inline bool         lineLow = false;
+inline uint64_t     fallAt = 0;
+inline uint64_t     riseAt = 0;
+inline uint64_t     lastSlotStart = 0;
+inline uint64_t     resetEnd = 0;
+inline uint64_t     presenceFrom = 0;
+inline uint64_t     presenceUntil = 0;
+inline bool         shorted = false;
+
+inline bool anyOverdrive() {
+    for (auto &d : devices) {
+        if (d.connected && d.overdrive) return true;
+    }
+    return false;
+}
+
+inline void edge() {
+    bool low = masterOutput && !masterHigh;
+    if (low == lineLow) return;
+    lineLow = low;
+    bool od = anyOverdrive();
+
+    if (low) {
+        fallAt = host::nowUs;
+        if (host::nowUs < riseAt + 1) violations.recovery++;
+        if (resetEnd && host::nowUs < resetEnd + (od ? 48 : 480)) violations.resetRecovery++;
+        for (auto &d : devices) {
+            if (d.connected && d.parasite && (host::nowUs < d.convertingUntil)) {
+                violations.conversionCut++;
+                d.brownOut();
+            }
+            d.slotStart(host::nowUs);
+        }
+        return;
+    }
+
+    riseAt = host::nowUs;
+    uint64_t lowFor = host::nowUs - fallAt;
+    if (lowFor >= (od ? 48u : 480u)) {
+        resets++;
+        if (!od && lowFor < 480) violations.resetShort++;
+        presenceFrom = presenceUntil = 0;
+        for (auto &d : devices) {
+            uint64_t from = 0, until = 0;
+            d.reset(lowFor, host::nowUs, from, until);
+            if (until) {
+                presenceFrom = from;
+                presenceUntil = std::max(presenceUntil, until);
+            }
+        }
+        resetEnd = host::nowUs;
+        lastSlotStart = 0;
+        return;
+    }
+    slots++;
+    if (lastSlotStart && fallAt < lastSlotStart + (od ? 6 : 60)) violations.slotShort++;
+    lastSlotStart = fallAt;
+    resetEnd = 0;
+    for (auto &d : devices) d.slotEnd(fallAt, host::nowUs);
+}
+
+inline int line() {
+    if (lineLow || shorted) return 0;
+    if (host::nowUs >= presenceFrom && host::nowUs < presenceUntil) return 0;
+    for (auto &d : devices) {
+        if (d.connected && host::nowUs >= d.holdFrom && host::nowUs < d.holdUntil) return 0;
+    }
+    return 1;
+}
+
+inline uint64_t totalViolations() {
+    return violations.ambiguous + violations.slotShort + violations.recovery + violations.resetShort +
+           violations.resetRecovery + violations.conversionCut;
+}
+
+inline void resetStats() {
+    violations = {};
+    slots = resets = 0;
+    host::irqOffCount = host::irqOffMaxUs = 0;
+}
+
+// The bus on every pin (one bus per test).
+inline void attach() {
+    host::fastWrite = [](uint16_t, bool high) { masterHigh = high; edge(); };
+    host::fastMode  = [](uint16_t, PinMode mode) { masterOutput = (mode == OUTPUT); edge(); };
+    host::fastRead  = [](uint16_t) { return (int32_t)line(); };
+}
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef TEST_SHIM_SI7021_MODEL_H
+#define TEST_SHIM_SI7021_MODEL_H
+
+// Si7021 on the shim's I2C bus: the command layer Adafruit_Si7021 uses, over a lumped model of condensation and
+// drift, stepped on host::nowUs.
+//  - The die relaxes towards ambient (tau 40 s), raised ~1.2 C per heater current step while HTRE is set.
+//  - RH at the die is ambient RH * psat(ambient) / psat(die).
+//  - A water film builds while die RH is at 100 % and evaporates faster the further below 100 % it is; with any
+//    film the sensor reads 100 %.  Time wet builds a polymer drift (+%RH) that relaxes slowly at ambient and
+//    quickly when heated.
+//
+//   host::i2cDevice = &si7021_model::device;
+
+#include "Particle.h"
+
+namespace si7021_model {
+
+inline double psat(double tempC) { return 6.112 * exp(17.62 * tempC / (243.12 + tempC)); }
+
+struct Device : public TwoWireDevice {
+    double      ambientC = 5;
+    double      ambientRh = 80;
+    double      dieC = 5;
+    double      film = 0;
+    double      drift = 0;
+    uint8_t     user1 = 0x3A;
+    uint8_t     heatReg = 0;
+    bool        heaterEverOn = false;
+    uint64_t    heaterOnUs = 0;
+    double      maxDieRiseWhileHeating = 0;
+    int         nackStarts = 0;             // NACK the next N measurement commands
+    int         corruptReads = 0;           // Bad checksum on the next N results
+
+    uint64_t    convertStartUs = 0;
+    bool        converting = false;
+    bool        haveResult = false;
+    uint16_t    rhCode = 0;
+    uint16_t    tCode = 0;
+    uint64_t    lastUs = host::nowUs;
+    enum { NONE, RH, PREVIOUS_T, USER1, HEATER } pending = NONE;
+
+    bool heater() const { return (user1 & 0x04) != 0; }
+    double heaterRiseC() const { return heater() ? 1.2 * (1 + heatReg) : 0; }
+    double dieRh() const { return ambientRh * psat(ambientC) / psat(dieC); }
+    double reportedRh() const { return (film > 0) ? 100.0 : std::min(100.0, dieRh() + drift); }
+
+    void step(uint64_t nowUs) {
+        while (lastUs < nowUs) {
+            uint64_t stepUs = std::min<uint64_t>(nowUs - lastUs, 1000000);
+            double dt = stepUs / 1e6;
+            lastUs += stepUs;
+
+            dieC += (ambientC + heaterRiseC() - dieC) * (1 - exp(-dt / 40.0));
+            if (heater()) {
+                heaterOnUs += stepUs;
+                maxDieRiseWhileHeating = std::max(maxDieRiseWhileHeating, dieC - ambientC);
+            }
+            double rh = dieRh();
+            if (rh >= 100) {
+                film += dt * (rh - 99) * 0.01;
+            }
+            else {
+                film = std::max(0.0, film - dt * (100 - rh) * 0.002);
+            }
+            if (film > 0) {
+                drift = std::min(8.0, drift + dt * 8.0 / 7200);        // Two hours wet: +8 %RH
+            }
+            else {
+                drift = std::max(0.0, drift - dt * (heater() ? 8.0 / 300 : 8.0 / (3600 * 48)));
+            }
+        }
+    }
+
+    static uint8_t crc(uint16_t v) {
+        uint8_t c = 0;
+        for (int i = 1; i >= 0; i--) {
+            c ^= v >> (i * 8);
+            for (int b = 0; b < 8; b++) {
+                c = (c & 0x80) ? (c << 1) ^ 0x31 : c << 1;
+            }
+        }
+        return c;
+    }
+
+    bool command(const std::vector<uint8_t> &tx) override {
+        step(host::nowUs);
+        if (tx.empty()) return true;
+        switch (tx[0]) {
+            case 0xF5: {        // Measure RH, no hold
+                if (nackStarts > 0) {
+                    nackStarts--;
+                    return false;
+                }
+                if (converting && host::nowUs < convertStartUs + 23000) return false;
+                converting = true;
+                haveResult = false;
+                convertStartUs = host::nowUs;
+                double rh = reportedRh() + 0.02;
+                rhCode = (uint16_t)std::min(65532.0, std::max(0.0, (rh + 6) * 65536 / 125)) & 0xFFFC;
+                tCode = (uint16_t)((dieC + 46.85) * 65536 / 175.72) & 0xFFFC;
+                pending = RH;
+                return true;
+            }
+            case 0xE0: pending = PREVIOUS_T; return true;
+            case 0xE7: pending = USER1; return true;
+            case 0x11: pending = HEATER; return true;
+            case 0xE6: user1 = (tx[1] & ~0x3A) | 0x3A; heaterEverOn |= heater(); return true;
+            case 0x51: heatReg = tx[1] & 0x0F; return true;
+            case 0xFE: user1 = 0x3A; heatReg = 0; converting = false; return true;
+            default: return true;
+        }
+    }
+
+    std::vector<uint8_t> read(size_t n) override {
+        step(host::nowUs);
+        switch (pending) {
+            case RH: {
+                if (host::nowUs < convertStartUs + 23000) return {};     // Still converting: NACK
+                converting = false;
+                pending = NONE;
+                haveResult = true;
+                uint8_t c = crc(rhCode);
+                if (corruptReads > 0) {
+                    corruptReads--;
+                    c ^= 1;
+                }
+                return { (uint8_t)(rhCode >> 8), (uint8_t)rhCode, c };
+            }
+            case PREVIOUS_T:
+                pending = NONE;
+                if (!haveResult) return {};
+                return { (uint8_t)(tCode >> 8), (uint8_t)tCode };
+            case USER1: pending = NONE; return { user1 };
+            case HEATER: pending = NONE; return { heatReg };
+            default: return std::vector<uint8_t>(n, 0xFF);
+        }
+    }
+};
+
+inline Device device;
+
+}
+
+#endif
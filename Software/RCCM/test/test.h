@@ -0,0 +1,46 @@
+#ifndef TEST_H
+#define TEST_H
+
+// Minimal check macros for the host tests.  Every test is a standalone program; main() ends with TEST_END().
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+static int testFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        testFailures++; \
+    } \
+} while (0)
+
+#define TEST_END() do { \
+    printf("%s: %s\n", __FILE__, (testFailures == 0) ? "ok" : "FAILED"); \
+    return (testFailures == 0) ? 0 : 1; \
+} while (0)
+
+// Benchmarks run only when asked for: `test_x bench` (make bench).
+static inline bool bench_requested(int argc, char **argv) {
+    return (argc > 1) && (strcmp(argv[1], "bench") == 0);
+}
+
+// Wall clock for the benchmarks; nanoseconds per call of fn over iterations.
+template <class F>
+static double bench_ns(long iterations, F fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+// Keeps a benchmarked result from being optimized away.
+template <class T>
+static inline void keep(const T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif
@@ -0,0 +1,219 @@
+// AlertScheduler on a virtual clock across DST changes: a daily heartbeat at 08:00 or 23:30 local once per local day
+// for two years, quiet hours 22:00-07:00 with deferred alerts delivered as one digest at 07:00, sub-day intervals on
+// fixed local times with no repeated or skipped slot at spring forward / fall back, N-day intervals, intervals refused,
+// nothing due before begin(), and a clock stepped backwards.  Benchmarks the per loop() checks against a convert() per
+// pass.
+#include "test.h"
+#include "LocalTimeRK.cpp"
+#include "AlertScheduler.cpp"
+#include <map>
+#include <random>
+
+static const char *const zones[] = {
+    "EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00",
+    "AEST-10AEDT,M10.1.0/2,M4.1.0/3",
+    "NST3:30NDT,M3.2.0/2,M11.1.0/2",
+};
+
+static LocalTimeConvert localAt(time_t t) {
+    LocalTimeConvert conv;
+    conv.withTime(t).convert();
+    return conv;
+}
+
+static int localDay(const LocalTimeConvert &conv) {
+    return conv.localTimeValue.tm_year * 1000 + conv.localTimeValue.tm_yday;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(45);
+
+    for (const char *zone : zones) {
+        LocalTime::instance().withConfig(LocalTimePosixTimezone(zone));
+        time_t start = 1735707600 + (time_t)(rng() % 86400);
+
+        // Daily, polled every minute with some jitter, for two years; late in the day, too, where a UTC day step would
+        // skip the spring forward day.
+        for (const char *heartbeatTime : { "08:00:00", "23:30:00" }) {
+            long heartbeatLocal = LocalTimeHMS(heartbeatTime).toSeconds();
+            AlertScheduler scheduler(LocalTimeHMS(heartbeatTime), LocalTimeHMS("22:00:00"), LocalTimeHMS("07:00:00"));
+            scheduler.begin(start);
+            std::map<int, int> perDay;
+            bool pending = false;
+            int deferred = 0, digests = 0;
+            for (time_t t = start; t < start + 86400LL * 730 && testFailures == 0; t += 50 + rng() % 20) {
+                LocalTimeConvert conv = localAt(t);
+                int hour = conv.localTimeValue.tm_hour, minute = conv.localTimeValue.tm_min;
+
+                CHECK(scheduler.isQuiet(t) == ((hour >= 22) || (hour < 7)));
+                if (scheduler.heartbeatDue(t) == true) {
+                    perDay[localDay(conv)]++;
+                    CHECK((conv.localTimeValue.hms().toSeconds() - heartbeatLocal >= 0) && (conv.localTimeValue.hms().toSeconds() - heartbeatLocal < 120));
+                }
+                if ((hour == 23) && (minute == 0)) {
+                    CHECK(scheduler.defer(1UL << 3, t) == true);
+                    deferred++;
+                    pending = true;
+                }
+                if ((hour == 12) && (minute == 0)) {
+                    CHECK(scheduler.defer(1UL << 3, t) == false);
+                }
+                uint32_t digest = scheduler.takeDigest(t);
+                if (digest != 0) {
+                    CHECK((hour == 7) && (minute <= 1) && (digest == (1UL << 3)) && (pending == true));
+                    pending = false;
+                    digests++;
+                }
+                CHECK(scheduler.nextDeadline() > t);
+                if (testFailures > 0) printf("  %s daily from %s at %s\n", zone, heartbeatTime, conv.format(TIME_FORMAT_ISO8601_FULL).c_str());
+            }
+            CHECK(perDay.size() >= 729);
+            for (auto &day : perDay) {
+                CHECK(day.second == 1);
+            }
+            CHECK(digests > 0 && digests <= deferred);
+        }
+
+        // Divisors of a day: every slot is heartbeatTime + k * interval local, once each.  Over a DST change the UTC
+        // gap is an hour longer or shorter; a slot that does not exist that day (spring forward) is skipped, and one in
+        // the repeated hour (fall back) is taken the second time.
+        for (long interval : { 1800L, 3600L, 7200L, 6 * 3600L, 8 * 3600L, 12 * 3600L }) {
+            for (const char *heartbeatTime : { "08:00:00", "01:30:00", "02:30:00" }) {
+                AlertScheduler scheduler(LocalTimeHMS(heartbeatTime), LocalTimeHMS("0"), LocalTimeHMS("0"));
+                CHECK(scheduler.setHeartbeatInterval(interval) == true);
+                scheduler.begin(start);
+                long phase = LocalTimeHMS(heartbeatTime).toSeconds() % interval;
+                std::map<std::pair<int, long>, int> slots;
+                time_t last = 0;
+                for (time_t t = start; t < start + 86400LL * 400 && testFailures == 0; t += 60) {
+                    if (scheduler.heartbeatDue(t) == false) {
+                        continue;
+                    }
+                    LocalTimeConvert conv = localAt(t);
+                    long local = conv.localTimeValue.hms().toSeconds();
+                    CHECK(((local - phase) % interval + interval) % interval < 60);
+                    CHECK(++slots[std::make_pair(localDay(conv), local / 60)] == 1);
+                    if (last != 0) {
+                        CHECK((t - last >= interval - 3600 - 60) && (t - last <= std::max(2 * interval, interval + 3600) + 60));
+                        CHECK((labs((long)(t - last) - interval) <= 60) || (conv.isDST() != localAt(last).isDST()));
+                    }
+                    last = t;
+                    if (testFailures > 0) printf("  %s every %ld s from %s at %s\n", zone, interval, heartbeatTime,
+                                                 conv.format(TIME_FORMAT_ISO8601_FULL).c_str());
+                }
+                long expected = 400 * (86400 / interval);
+                CHECK(labs((long)slots.size() - expected) <= 4);
+            }
+        }
+
+        // Whole days: 08:00 and 23:30 local every second and third day, whatever the offset.
+        for (long days : { 2L, 3L }) for (const char *heartbeatTime : { "08:00:00", "23:30:00" }) {
+            long heartbeatLocal = LocalTimeHMS(heartbeatTime).toSeconds();
+            AlertScheduler scheduler(LocalTimeHMS(heartbeatTime), LocalTimeHMS("0"), LocalTimeHMS("0"));
+            CHECK(scheduler.setHeartbeatInterval(days * 86400) == true);
+            scheduler.begin(start);
+            time_t last = 0;
+            int fires = 0;
+            for (time_t t = start; t < start + 86400LL * 400 && testFailures == 0; t += 300) {
+                if (scheduler.heartbeatDue(t) == false) {
+                    continue;
+                }
+                LocalTimeConvert conv = localAt(t);
+                CHECK((conv.localTimeValue.hms().toSeconds() - heartbeatLocal >= 0) && (conv.localTimeValue.hms().toSeconds() - heartbeatLocal < 300));
+                if (last != 0) {
+                    CHECK(labs((long)(t - last) - days * 86400) <= 3600 + 300);
+                }
+                last = t;
+                fires++;
+            }
+            CHECK(labs(fires - 400 / days) <= 1);
+        }
+    }
+    LocalTime::instance().withConfig(LocalTimePosixTimezone(zones[0]));
+
+    // Intervals that do not land on the same local times every day are refused; the previous one stays.
+    {
+        AlertScheduler scheduler(LocalTimeHMS("08:00:00"), LocalTimeHMS("0"), LocalTimeHMS("0"));
+        for (long interval : { 36 * 3600L, 7000L, 5 * 3600L, 0L, -86400L, 86401L }) {
+            CHECK(scheduler.setHeartbeatInterval(interval) == false);
+            CHECK(AlertScheduler::heartbeatIntervalValid(interval) == false);
+        }
+        for (long interval : { 60L, 900L, 4 * 3600L, 86400L, 7 * 86400L }) {
+            CHECK(AlertScheduler::heartbeatIntervalValid(interval) == true);
+        }
+        scheduler.begin(1760000000);
+        int fires = 0;
+        for (time_t t = 1760000000; t < 1760000000 + 86400 * 10; t += 60) {
+            fires += (scheduler.heartbeatDue(t) == true) ? 1 : 0;
+        }
+        CHECK(fires == 10);
+    }
+
+    // Not started (clock not yet valid): nothing is due and nothing is deferred; after begin() at time sync, the
+    // first heartbeat is the next 08:00, not one for every slot since 1970.
+    {
+        AlertScheduler scheduler(LocalTimeHMS("08:00:00"), LocalTimeHMS("22:00:00"), LocalTimeHMS("07:00:00"));
+        for (time_t t = 0; t < 3600; t += 10) {
+            CHECK(scheduler.heartbeatDue(t) == false);
+            CHECK(scheduler.isQuiet(t) == false);
+            CHECK(scheduler.defer(1, t) == false);
+        }
+        time_t synced = 1760000000;
+        scheduler.begin(synced);
+        CHECK(scheduler.heartbeatDue(synced) == false);
+        int fires = 0;
+        for (time_t t = synced; t < synced + 86400; t += 60) {
+            if (scheduler.heartbeatDue(t) == true) {
+                CHECK(localAt(t).localTimeValue.tm_hour == 8);
+                fires++;
+            }
+        }
+        CHECK(fires == 1);
+    }
+
+    // 23:30 daily over the 2025 spring forward in EST5EDT: the 23-hour day still gets its heartbeat.
+    {
+        AlertScheduler scheduler(LocalTimeHMS("23:30:00"), LocalTimeHMS("0"), LocalTimeHMS("0"));
+        scheduler.begin(1741237200);                            // 2025-03-06 00:00 EST
+        std::vector<int> days;
+        for (time_t t = 1741237200; t < 1741237200 + 86400 * 6; t += 60) {
+            if (scheduler.heartbeatDue(t) == true) {
+                LocalTimeConvert conv = localAt(t);
+                CHECK((conv.localTimeValue.tm_hour == 23) && (conv.localTimeValue.tm_min == 30));
+                days.push_back(conv.localTimeValue.tm_mday);
+            }
+        }
+        CHECK(days == std::vector<int>({ 6, 7, 8, 9, 10, 11 }));
+    }
+
+    // A clock stepped back a day reschedules from the new time, with no spurious heartbeat.
+    {
+        AlertScheduler scheduler(LocalTimeHMS("08:00:00"), LocalTimeHMS("22:00:00"), LocalTimeHMS("07:00:00"));
+        scheduler.begin(1760000000);
+        CHECK(scheduler.heartbeatDue(1760000000 - 86400) == false);
+        CHECK(scheduler.nextDeadline() > 1760000000 - 86400);
+        CHECK(scheduler.nextDeadline() <= 1760000000 - 86400 + 86400);
+    }
+
+    if (bench == true) {
+        // One loop() pass: heartbeat & quiet checks, against converting the time every pass to compare by hand.
+        AlertScheduler scheduler(LocalTimeHMS("08:00:00"), LocalTimeHMS("22:00:00"), LocalTimeHMS("07:00:00"));
+        scheduler.begin(1760000000);
+        LocalTimeConvert conv;
+        long sum = 0;
+        double cachedNs = bench_ns(2000000, [&](long i) {
+            time_t t = 1760000000 + i / 100;
+            sum += scheduler.heartbeatDue(t) + scheduler.isQuiet(t);
+        });
+        double convertNs = bench_ns(2000000, [&](long i) {
+            conv.withTime(1760000000 + i / 100).convert();
+            int hour = conv.localTimeValue.tm_hour;
+            sum += (hour == 8) + ((hour >= 22) || (hour < 7));
+        });
+        keep(sum);
+        printf("bench per loop() pass: cached deadlines %.1f ns, convert() each pass %.1f ns\n", cachedNs, convertNs);
+    }
+
+    TEST_END();
+}
@@ -0,0 +1,190 @@
+// configure() parser: the static token pool & thresholdSchema path from RCCM.ino, fuzzed with generated documents
+// (checked against an independent oracle) and with mutated ones (must fail cleanly), plus parse time per document.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+#include <random>
+
+// STATIC CONFIGURATION, as in RCCM.ino.
+#define THRESH_TEMP_LOW                 40
+#define THRESH_TEMP_HIGH                95
+#define THRESH_TEMP_DELTA               0.2
+#define THRESH_BATT_LOW                 25
+#define INTERNAL_COLLECTION_INTERVAL    (60*15)
+#define HEARTBEAT_INTERVAL              (60*60*24)
+#define CONFIG_JSON_MAX                 256
+#define CONFIG_JSON_TOKENS              16
+
+#include "config_profiles.h"
+#include "json_schema.h"
+
+// As in RCCM.ino.
+static constexpr auto thresholdSchema = json_schema(
+    json_field("tempLow",       &thresholdProfile::tempLow),
+    json_field("tempHigh",      &thresholdProfile::tempHigh),
+    json_field("tempDelta",     &thresholdProfile::tempDelta),
+    json_field("battLow",       &thresholdProfile::battLow),
+    json_field("interval",      &thresholdProfile::collectionInterval),
+    json_field("heartbeat",     &thresholdProfile::heartbeatInterval)
+);
+
+JsonParserStatic<CONFIG_JSON_MAX, CONFIG_JSON_TOKENS>   jpConfig;
+
+// The parse half of configure(): 0, -1 parse error, -2 unknown key / bad value.
+static int configure_parse(const char *command, struct thresholdProfile &candidate) {
+    int result;
+
+    jpConfig.clear();
+    if (!jpConfig.addString(command) || !jpConfig.parse()) {
+        return -1;
+    }
+    result = json_read_object(jpConfig, jpConfig.getOuterObject(), candidate, thresholdSchema);
+    if (result == JSON_SCHEMA_BAD_DOCUMENT) {
+        return -1;
+    }
+    if (result != JSON_SCHEMA_OK) {
+        return -2;
+    }
+    return 0;
+}
+
+static const char *const knownKeys[]    = { "tempLow", "tempHigh", "tempDelta", "battLow", "interval", "heartbeat" };
+static const char *const unknownKeys[]  = { "tempLo", "tempLowX", "TEMPLOW", "", "interval ", "bogus" };
+static const char *const badValues[]    = { "\"38\"", "[1]", "{\"a\":1}", "\"\"" };
+static const int badValueTokens[]       = { 1, 2, 3, 1 };
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(31);
+    const struct thresholdProfile defaults = thresholdProfiles[0];
+
+    // Generated documents against an oracle: known keys with numbers apply in order (last one wins); any unknown
+    // key or non-number value is -2; more tokens than the pool holds is -1.
+    for (int trial = 0; trial < 200000; trial++) {
+        struct thresholdProfile expected = defaults;
+        struct thresholdProfile candidate = defaults;
+        std::string doc = "{";
+        int pairs = rng() % 9;
+        int tokens = 1;
+        int expectedResult = 0;
+
+        for (int i = 0; i < pairs; i++) {
+            char value[32];
+            int kind = rng() % 20;
+            int key = rng() % 6;
+            if (i > 0) doc += (rng() % 2) ? "," : " , ";
+
+            if (kind == 0) {
+                doc += std::string("\"") + unknownKeys[rng() % 6] + "\":1";
+                tokens += 2;
+                if (expectedResult == 0) expectedResult = -2;
+                continue;
+            }
+            if (kind == 1) {
+                int bad = rng() % 4;
+                doc += std::string("\"") + knownKeys[key] + "\":" + badValues[bad];
+                tokens += 1 + badValueTokens[bad];
+                if (expectedResult == 0) expectedResult = -2;
+                continue;
+            }
+            if (key < 4) {
+                float f = (float)((int)(rng() % 40000) - 20000) / 100.0f;
+                snprintf(value, sizeof(value), "%.2f", f);
+                if (expectedResult == 0) {
+                    float *members[4] = { &expected.tempLow, &expected.tempHigh, &expected.tempDelta, &expected.battLow };
+                    *members[key] = (float)atof(value);
+                }
+            }
+            else
+            {
+                long l = (long)(rng() % 200000);
+                snprintf(value, sizeof(value), "%ld", l);
+                if (expectedResult == 0) {
+                    ((key == 4) ? expected.collectionInterval : expected.heartbeatInterval) = l;
+                }
+            }
+            doc += std::string("\"") + knownKeys[key] + "\":" + value;
+            tokens += 2;
+        }
+        doc += "}";
+        if (tokens > CONFIG_JSON_TOKENS) expectedResult = -1;
+
+        int result = configure_parse(doc.c_str(), candidate);
+        CHECK(result == expectedResult);
+        if (result == 0) {
+            CHECK(candidate.tempLow == expected.tempLow);
+            CHECK(candidate.tempHigh == expected.tempHigh);
+            CHECK(candidate.tempDelta == expected.tempDelta);
+            CHECK(candidate.battLow == expected.battLow);
+            CHECK(candidate.collectionInterval == expected.collectionInterval);
+            CHECK(candidate.heartbeatInterval == expected.heartbeatInterval);
+        }
+        if (testFailures > 0) {
+            printf("  document: %s  result %d expected %d\n", doc.c_str(), result, expectedResult);
+            break;
+        }
+    }
+
+    // Fixed cases: not an object, truncated, over the buffer.
+    {
+        struct thresholdProfile candidate = defaults;
+        CHECK(configure_parse("", candidate) == -1);
+        CHECK(configure_parse("[1,2]", candidate) == -1);
+        CHECK(configure_parse("38", candidate) == -1);
+        CHECK(configure_parse("{\"tempLow\":", candidate) == -1);
+        CHECK(configure_parse("{\"tempLow\":38", candidate) == -1);
+        CHECK(configure_parse("{}", candidate) == 0);
+        std::string big = "{\"tempLow\":" + std::string(CONFIG_JSON_MAX, '1') + "}";
+        CHECK(configure_parse(big.c_str(), candidate) == -1);
+        CHECK(candidate.tempLow == defaults.tempLow);
+    }
+
+    // Mutated documents: random byte flips, insertions & truncations of a valid document.  Any result is allowed
+    // as long as it is one of the three, the parser never overruns its pool and a later good document still parses.
+    {
+        const std::string good = "{\"tempLow\":38,\"tempHigh\":90.5,\"tempDelta\":0.5,\"battLow\":20,\"interval\":900,\"heartbeat\":86400}";
+        const char alphabet[] = "{}[]\":,\\ 0123456789.-+eEtruefalsnl\x01\xff";
+        int counts[3] = {};
+        for (int trial = 0; trial < 200000; trial++) {
+            std::string doc = good;
+            int edits = 1 + rng() % 4;
+            for (int e = 0; e < edits && doc.size() > 0; e++) {
+                size_t at = rng() % doc.size();
+                switch (rng() % 4) {
+                    case 0: doc[at] = alphabet[rng() % (sizeof(alphabet) - 1)]; break;
+                    case 1: doc.insert(at, 1, alphabet[rng() % (sizeof(alphabet) - 1)]); break;
+                    case 2: doc.erase(at, 1); break;
+                    case 3: doc.resize(at); break;
+                }
+            }
+            struct thresholdProfile candidate = defaults;
+            int result = configure_parse(doc.c_str(), candidate);
+            CHECK((result == 0) || (result == -1) || (result == -2));
+            counts[-std::min(result, 0)]++;
+        }
+        struct thresholdProfile candidate = defaults;
+        CHECK(configure_parse(good.c_str(), candidate) == 0);
+        CHECK(candidate.tempLow == 38 && candidate.heartbeatInterval == 86400);
+        printf("mutation fuzz: %d applied, %d parse errors, %d bad values\n", counts[0], counts[1], counts[2]);
+    }
+
+    if (bench == true) {
+        // Typical command, the largest document the pool accepts, and the worst rejected one (fills the buffer).
+        const std::string typical = "{\"tempLow\":38,\"tempHigh\":90}";
+        const std::string full = "{\"tempLow\":38.25,\"tempHigh\":90.5,\"tempDelta\":0.5,\"battLow\":20,\"interval\":900,\"heartbeat\":86400,\"tempLow\":39}";
+        std::string worst = "{";
+        while (worst.size() < CONFIG_JSON_MAX - 14) worst += "\"a\":1,";
+        worst += "\"a\":1}";
+        struct thresholdProfile candidate = defaults;
+
+        CHECK(configure_parse(full.c_str(), candidate) == 0);
+        CHECK(configure_parse(worst.c_str(), candidate) == -1);
+        const std::string *docs[3] = { &typical, &full, &worst };
+        const char *labels[3] = { "typical", "7 keys (pool full)", "buffer full, over the pool" };
+        for (int i = 0; i < 3; i++) {
+            double ns = bench_ns(1000000, [&](long) { keep(configure_parse(docs[i]->c_str(), candidate)); });
+            printf("bench configure parse, %s (%zu B): %.0f ns\n", labels[i], docs[i]->size(), ns);
+        }
+    }
+
+    TEST_END();
+}
@@ -0,0 +1,75 @@
+// Configuration profiles: all 32 DIP switch combinations resolve to the expected profile, policy & occupancy,
+// independent of the compile-time checks in config_profiles.h.
+#include "test.h"
+#include <Particle.h>
+
+// STATIC CONFIGURATION, as in RCCM.ino.
+#define THRESH_TEMP_LOW                 40
+#define THRESH_TEMP_HIGH                95
+#define THRESH_TEMP_DELTA               0.2
+#define THRESH_BATT_LOW                 25
+#define INTERNAL_COLLECTION_INTERVAL    (60*15)
+#define HEARTBEAT_INTERVAL              (60*60*24)
+
+#include "config_profiles.h"
+
+// Resolution has to be usable for a constexpr-initialized global, as activeProfile is in RCCM.ino.
+static constexpr struct configProfile bootDefault = config_profile_resolve(0);
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    static const char *const names[4]               = { "STANDARD", "WINTERIZED", "IN_SEASON", "BENCH_TEST" };
+    static const publishPolicy policies[4]          = { PUBLISH_SMS_BOTH, PUBLISH_SMS_A, PUBLISH_SMS_B, PUBLISH_EVENT_ONLY };
+    int seen[4][4][2] = {};
+
+    CHECK(strcmp(bootDefault.thresholds.name, "STANDARD") == 0);
+
+    for (int dip = 0x00; dip <= 0x1F; dip++) {
+        // Switches as the firmware reads them: DIP n ON = bit n-1 set.
+        bool on[5];
+        for (int i = 0; i < 5; i++) on[i] = (dip >> i) & 1;
+        struct configProfile profile = config_profile_resolve(dip);
+
+        CHECK(profile.dipSwitches == dip);
+        CHECK(strcmp(profile.thresholds.name, names[on[0] + 2 * on[1]]) == 0);
+        CHECK(profile.policy == policies[on[2] + 2 * on[3]]);
+        CHECK(profile.expectVacant == !on[4]);
+
+        // DIP 1-2 pick the thresholds alone; the other switches never change them.
+        const struct thresholdProfile &base = thresholdProfiles[dip & 0x03];
+        CHECK(profile.thresholds.tempLow == base.tempLow);
+        CHECK(profile.thresholds.tempHigh == base.tempHigh);
+        CHECK(profile.thresholds.tempDelta == base.tempDelta);
+        CHECK(profile.thresholds.battLow == base.battLow);
+        CHECK(profile.thresholds.collectionInterval == base.collectionInterval);
+        CHECK(profile.thresholds.heartbeatInterval == base.heartbeatInterval);
+
+        // Same rules as config_validate().
+        CHECK(profile.thresholds.tempLow >= -40);
+        CHECK(profile.thresholds.tempHigh <= 150);
+        CHECK(profile.thresholds.tempLow < profile.thresholds.tempHigh);
+        CHECK(profile.thresholds.collectionInterval >= 60);
+        CHECK(profile.thresholds.heartbeatInterval >= profile.thresholds.collectionInterval);
+        CHECK(((profile.thresholds.heartbeatInterval % 86400) == 0) || ((86400 % profile.thresholds.heartbeatInterval) == 0));
+
+        seen[dip & 0x03][(dip >> 2) & 0x03][(dip >> 4) & 0x01]++;
+    }
+
+    // Every (profile, policy, occupancy) triple is reachable exactly once.
+    for (auto &a : seen) for (auto &b : a) for (int n : b) CHECK(n == 1);
+
+    // Bits above DIP 5 are ignored.
+    for (int dip = 0x20; dip <= 0xFF; dip++) {
+        CHECK(config_profile_resolve(dip).dipSwitches == (dip & 0x1F));
+        CHECK(config_profile_resolve(dip).thresholds.name == config_profile_resolve(dip & 0x1F).thresholds.name);
+    }
+
+    if (bench == true) {
+        // Boot-time cost only; reported for completeness.
+        volatile uint8_t dip = 0;
+        double ns = bench_ns(10000000, [&](long i) { dip = (uint8_t)i; struct configProfile p = config_profile_resolve(dip); keep(p); });
+        printf("bench config_profile_resolve: %.2f ns\n", ns);
+    }
+
+    TEST_END();
+}
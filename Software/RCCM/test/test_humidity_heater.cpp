@@ -0,0 +1,151 @@
+// HumidityHeater against a simulated Si7021 that fogs over and drifts: a dry cabin with noisy RH never runs the
+// heater; through six hours of saturated air the heater runs only after the trigger hold, within its duty limit, and
+// the reading recovers sooner than with no heater, while heated samples are never reported.  A NACKed start or a bad
+// checksum gives an invalid sample with the values held, and process() never waits.
+#include "test.h"
+#include "si7021_model.h"
+#include "Adafruit_Si7021.cpp"
+#include "HumidityHeater.cpp"
+#include <random>
+
+#define HOLD_MS     (1000UL * 60 * 30)
+#define HEAT_MS     (1000UL * 60 * 5)
+#define SETTLE_MS   (1000UL * 60 * 10)
+
+static std::mt19937 rng(50);
+
+struct Result {
+    double      recoverH;           // Hours after the fog until readings are back within 3 %RH; -1 if never
+    double      maxTempErrorC;      // Largest reported temperature error against ambient
+    uint32_t    cycles;
+    double      heaterFraction;
+    double      maxDieRiseC;
+    uint64_t    firstHeatUs;
+    uint64_t    firstSaturatedUs;
+};
+
+static double ambientAt(double hours) {
+    return 5 + 2 * sin(hours / 24 * 2 * M_PI);
+}
+
+// process() every 5 ms and a reading collected every 15 minutes, as RCCM does; profile(hours) is the ambient RH.
+template <class F>
+static Result run(float triggerRh, double hours, double fogEndH, F profile) {
+    si7021_model::device = si7021_model::Device();
+    host::i2cDevice = &si7021_model::device;
+    Adafruit_Si7021 sensor;
+    HumidityHeater heater(sensor, 60000, triggerRh, HOLD_MS, HEAT_MS, SETTLE_MS, 0x04);
+    sensor.begin();
+    heater.begin();
+
+    uint64_t start = host::nowUs;
+    uint64_t nextCollect = start + 15ULL * 60 * 1000000;
+    bool wasHeating = false;
+    Result result = { -1, 0, 0, 0, 0, 0, 0 };
+    host::delayedUs = 0;
+    while (host::nowUs < start + (uint64_t)(hours * 3600e6)) {
+        double h = (host::nowUs - start) / 3600e6;
+        si7021_model::device.ambientC = ambientAt(h);
+        si7021_model::device.ambientRh = profile(h);
+        heater.process();
+        if (si7021_model::device.heater() && !wasHeating && result.firstHeatUs == 0) {
+            result.firstHeatUs = host::nowUs - start;
+        }
+        if (result.firstSaturatedUs == 0 && si7021_model::device.reportedRh() >= triggerRh) {
+            result.firstSaturatedUs = host::nowUs - start;
+        }
+        wasHeating = si7021_model::device.heater();
+
+        if (host::nowUs >= nextCollect) {
+            nextCollect += 15ULL * 60 * 1000000;
+            struct HumidityHeater::reading reading;
+            heater.takeReading(reading);
+            result.cycles += heater.takeCycles();
+            CHECK(reading.valid == true);
+            double sampledH = (reading.sampleMs - start / 1000) / 3600e3;
+            result.maxTempErrorC = std::max(result.maxTempErrorC, fabs(reading.temperatureC - ambientAt(sampledH)));
+            bool close = fabs(reading.humidity - si7021_model::device.ambientRh) < 3.0;
+            if (h > fogEndH && result.recoverH < 0 && close) {
+                result.recoverH = h - fogEndH;
+            }
+            if (h > fogEndH && result.recoverH >= 0 && !close && !heater.masked()) {
+                result.recoverH = -1;
+            }
+        }
+        host::advanceUs(5000);
+    }
+    CHECK(host::delayedUs == 0);
+    si7021_model::device.step(host::nowUs);
+    result.heaterFraction = si7021_model::device.heaterOnUs / (hours * 3600e6);
+    result.maxDieRiseC = si7021_model::device.maxDieRiseWhileHeating;
+    return result;
+}
+
+int main() {
+    // A dry cabin: RH wandering 60-92 % never trips the heater.
+    double walk = 80;
+    auto dry = [&](double) {
+        walk += std::uniform_real_distribution<double>(-0.05, 0.05)(rng);
+        walk = std::min(92.0, std::max(60.0, walk));
+        return walk;
+    };
+    Result dryCabin = run(95, 48, 1e9, dry);
+    CHECK(dryCabin.cycles == 0 && si7021_model::device.heaterEverOn == false);
+
+    // Fog: 85 % for 4 h, saturated air for 6 h, then 85 % for 14 h.
+    auto fog = [](double h) { return (h >= 4 && h < 10) ? 100.0 : 85.0; };
+    Result off = run(1000, 24, 10, fog);
+    Result on = run(95, 24, 10, fog);
+    CHECK(on.recoverH >= 0 && (off.recoverH < 0 || on.recoverH < off.recoverH));
+    CHECK(on.maxTempErrorC < 0.3);                  // Heated samples are masked...
+    CHECK(on.maxDieRiseC > 3);                      // ...though the die did heat
+    CHECK(on.firstHeatUs >= on.firstSaturatedUs + HOLD_MS * 1000ULL - 60000000ULL);
+    CHECK(on.heaterFraction <= (double)HEAT_MS / (HOLD_MS + HEAT_MS + SETTLE_MS) + 1e-3);
+    CHECK(on.cycles >= 1);
+    char without[32];
+    snprintf(without, sizeof(without), (off.recoverH < 0) ? "not within the day" : "%.2f h after", off.recoverH);
+    printf("fog: reading recovered %.2f h after with the heater (%u cycles, on %.1f%% of the day), %s without\n",
+           on.recoverH, on.cycles, on.heaterFraction * 100, without);
+
+    // Failed samples: invalid, with the values held; the heater state is unaffected.
+    {
+        si7021_model::device = si7021_model::Device();
+        host::i2cDevice = &si7021_model::device;
+        Adafruit_Si7021 sensor;
+        HumidityHeater heater(sensor, 60000, 95, HOLD_MS, HEAT_MS, SETTLE_MS, 0x04);
+        sensor.begin();
+        heater.begin();
+        struct HumidityHeater::reading reading;
+        CHECK(heater.takeReading(reading) == true && reading.valid == true && fabs(reading.humidity - 80) < 0.5);
+        CHECK(heater.takeReading(reading) == false);
+        float held = reading.humidity;
+
+        si7021_model::device.ambientRh = 50;
+        si7021_model::device.nackStarts = 1;
+        for (int i = 0; i < 12100; i++) {
+            heater.process();
+            host::advanceUs(5000);
+        }
+        CHECK(heater.takeReading(reading) == true && reading.valid == false && reading.humidity == held);
+        si7021_model::device.corruptReads = 1;
+        for (int i = 0; i < 12000; i++) {
+            heater.process();
+            host::advanceUs(5000);
+        }
+        CHECK(heater.takeReading(reading) == true && reading.valid == false && reading.humidity == held);
+        for (int i = 0; i < 12000; i++) {
+            heater.process();
+            host::advanceUs(5000);
+        }
+        CHECK(heater.takeReading(reading) == true && reading.valid == true && fabs(reading.humidity - 50) < 0.5);
+
+        sensor.heater(true);
+        CHECK(sensor.isHeaterEnabled() == true);
+        sensor.heater(false);
+        CHECK(sensor.isHeaterEnabled() == false);
+        CHECK(si7021_model::device.user1 == 0x3A);
+    }
+    host::i2cDevice = nullptr;
+
+    TEST_END();
+}
@@ -0,0 +1,171 @@
+// JsonWriter::insertString(): random mixes of ASCII, escapes, control characters, 2/3/4-byte UTF-8 and invalid
+// bytes (including overlong and past U+10FFFF 4-byte sequences) against a byte-at-a-time reference, in roomy and
+// truncating buffers.  Benchmarks SMS bodies and UTF-8-heavy text against the former per-byte insertChar /
+// insertsprintf("\\u%04X") path.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+#include <random>
+
+// Reference escaper: the specified output, one input byte or sequence at a time.
+static std::string reference(const std::string &s) {
+    std::string out = "\"";
+    char escape[16];
+    auto cont = [&](size_t i) { return (i < s.size()) && (((uint8_t)s[i] & 0xC0) == 0x80); };
+
+    for (size_t i = 0; i < s.size(); i++) {
+        uint8_t c = (uint8_t)s[i];
+        uint32_t cp = 0;
+        if ((c & 0xF8) == 0xF0 && cont(i + 1) && cont(i + 2) && cont(i + 3)) {
+            cp = ((c & 0x07) << 18) | ((s[i + 1] & 0x3F) << 12) | ((s[i + 2] & 0x3F) << 6) | (s[i + 3] & 0x3F);
+        }
+        if (cp >= 0x10000 && cp <= 0x10FFFF) {
+            cp -= 0x10000;
+            snprintf(escape, sizeof(escape), "\\u%04X", 0xD800 | (cp >> 10));
+            out += escape;
+            snprintf(escape, sizeof(escape), "\\u%04X", 0xDC00 | (cp & 0x3FF));
+            out += escape;
+            i += 3;
+        }
+        else if ((c & 0xF0) == 0xE0 && cont(i + 1) && cont(i + 2)) {
+            snprintf(escape, sizeof(escape), "\\u%04X", ((c & 0x0F) << 12) | ((s[i + 1] & 0x3F) << 6) | (s[i + 2] & 0x3F));
+            out += escape;
+            i += 2;
+        }
+        else if ((c & 0xE0) == 0xC0 && cont(i + 1)) {
+            snprintf(escape, sizeof(escape), "\\u%04X", ((c & 0x1F) << 6) | (s[i + 1] & 0x3F));
+            out += escape;
+            i += 1;
+        }
+        else if (c & 0x80) {
+            out += (char)c;                                     // Invalid UTF-8 (overlong, past U+10FFFF) passes through
+        }
+        else if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        }
+        else if (c == '\b') out += "\\b";
+        else if (c == '\f') out += "\\f";
+        else if (c == '\n') out += "\\n";
+        else if (c == '\r') out += "\\r";
+        else if (c == '\t') out += "\\t";
+        else if (c < 0x20) {
+            snprintf(escape, sizeof(escape), "\\u%04X", c);
+            out += escape;
+        }
+        else {
+            out += (char)c;
+        }
+    }
+    return out + "\"";
+}
+
+// The former insertString(), on the public JsonWriter API, for the benchmark baseline.  (2 & 3-byte UTF-8 only.)
+static void insertStringPerByte(JsonWriter &jw, const char *s) {
+    jw.insertChar('"');
+    for (size_t ii = 0; s[ii] && jw.getOffset() < jw.getBufferLen(); ii++) {
+        if (s[ii] & 0x80) {
+            if (((s[ii] & 0b11110000) == 0b11100000) && ((s[ii+1] & 0b11000000) == 0b10000000) && ((s[ii+2] & 0b11000000) == 0b10000000)) {
+                jw.insertsprintf("\\u%04X", ((s[ii] & 0b1111) << 12) | ((s[ii+1] & 0b111111) << 6) | (s[ii+2] & 0b111111));
+                ii += 2;
+            }
+            else if (((s[ii] & 0b11100000) == 0b11000000) && ((s[ii+1] & 0b11000000) == 0b10000000)) {
+                jw.insertsprintf("\\u%04X", ((s[ii] & 0b11111) << 6) | (s[ii+1] & 0b111111));
+                ii++;
+            }
+            else {
+                jw.insertChar(s[ii]);
+            }
+        }
+        else {
+            switch(s[ii]) {
+            case '\b': jw.insertChar('\\'); jw.insertChar('b'); break;
+            case '\f': jw.insertChar('\\'); jw.insertChar('f'); break;
+            case '\n': jw.insertChar('\\'); jw.insertChar('n'); break;
+            case '\r': jw.insertChar('\\'); jw.insertChar('r'); break;
+            case '\t': jw.insertChar('\\'); jw.insertChar('t'); break;
+            case '"':
+            case '\\': jw.insertChar('\\'); jw.insertChar(s[ii]); break;
+            default: jw.insertChar(s[ii]); break;
+            }
+        }
+    }
+    jw.insertChar('"');
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(35);
+    static const char *const pieces[] = {
+        "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf", "\"", "\\", "\n", "\t", "\r", "\b", "\f",
+        "\x01", "\x1f", "\x7f", "\xff", "\x80", "\xc3", "\xe2\x82", "\xf0\x9f\x98", "/",
+        "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xf7\xbf\xbf\xbf",
+    };
+
+    for (int trial = 0; trial < 50000; trial++) {
+        std::string s;
+        int n = rng() % 48;
+        for (int i = 0; i < n; i++) {
+            if (rng() % 2) s += (char)(0x20 + rng() % 0x5F);
+            else s += pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))];
+        }
+        std::string expected = reference(s);
+
+        size_t capacity = (trial % 3 == 0) ? (1 + rng() % 64) : 1024;
+        std::vector<char> buf(capacity);
+        JsonWriter jw(buf.data(), capacity);
+        jw.insertString(s.c_str(), true);
+
+        // Roomy: exact.  Truncating: a prefix of the exact output, flagged.
+        size_t written = jw.getOffset();
+        CHECK(written == std::min(expected.size(), capacity));
+        CHECK(std::string(buf.data(), written) == expected.substr(0, written));
+        CHECK(jw.isTruncated() == (expected.size() > capacity));
+        if (testFailures > 0) {
+            printf("  input %zu bytes, capacity %zu\n", s.size(), capacity);
+            break;
+        }
+    }
+
+    // Fixed cases.
+    {
+        char buf[64];
+        JsonWriter jw(buf, sizeof(buf));
+        jw.insertString("\xf0\x9f\x98\x80", false);                          // U+1F600
+        CHECK(std::string(buf, jw.getOffset()) == "\\uD83D\\uDE00");
+        jw.init();
+        jw.insertString("\xf4\x8f\xbf\xbf", false);                          // U+10FFFF
+        CHECK(std::string(buf, jw.getOffset()) == "\\uDBFF\\uDFFF");
+        jw.init();
+        jw.insertString("\xf0\x90\x80\x80", false);                          // U+10000
+        CHECK(std::string(buf, jw.getOffset()) == "\\uD800\\uDC00");
+
+        // Overlong (F0 80..8F) and past U+10FFFF (F4 90+, F5-F7): not surrogates; the bytes pass through.
+        for (const char *invalid : { "\xf0\x80\x80\x80", "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xf7\xbf\xbf\xbf" }) {
+            jw.init();
+            jw.insertString(invalid, false);
+            CHECK(std::string(buf, jw.getOffset()) == invalid);
+        }
+        jw.init();
+        jw.insertString("a\x01" "b", false);
+        CHECK(std::string(buf, jw.getOffset()) == "a\\u0001b");
+    }
+
+    if (bench == true) {
+        const char *sms = "[ Cabin 12 ]\nAlert: TEMP_LOW\nTemp: 38.2F\nHumidity: 61.0%\nBatt: 88.1%\nBatt State: CHARGED\n"
+                          "PWR SRC: VIN\nFW: 0.1.4\nSat Oct 18 03:00:00 2026\n";
+        const char *utf8 = "Caf\xc3\xa9 \xe2\x82\xac 12 \xc3\xa9t\xc3\xa9 \xe2\x82\xac\xe2\x82\xac na\xc3\xafve r\xc3\xa9sum\xc3\xa9 \xc3\xa0 la carte";
+        const char *labels[2] = { "SMS body", "UTF-8 heavy" };
+        const char *texts[2] = { sms, utf8 };
+        char buf[1024];
+        for (int i = 0; i < 2; i++) {
+            JsonWriter jw(buf, sizeof(buf));
+            double before = bench_ns(200000, [&](long) { jw.init(); insertStringPerByte(jw, texts[i]); keep(buf); });
+            double after = bench_ns(200000, [&](long) { jw.init(); jw.insertString(texts[i], true); keep(buf); });
+            size_t len = strlen(texts[i]);
+            printf("bench insertString, %s (%zu B): per byte %.0f MB/s, fast path %.0f MB/s\n", labels[i], len,
+                   len * 1e3 / before, len * 1e3 / after);
+        }
+    }
+
+    TEST_END();
+}
@@ -0,0 +1,147 @@
+// JsonParser key index: lookups with the hashed index (malloc'd & static slots) give the same token as the linear
+// scan on random documents with duplicate, missing & escaped keys, including through JsonReference chains; too few
+// slots falls back to the scan, deciding that once per parse().  Microbenchmark over object width.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+#include "json_corpus.h"
+
+using namespace JsonParserGeneratorRK;
+
+// Exposes the index state, to see when a build is attempted.
+template <size_t BUFFER_SIZE, size_t MAX_TOKENS>
+struct IndexState : public JsonParserStatic<BUFFER_SIZE, MAX_TOKENS> {
+    bool built() const { return this->keyIndexBuilt; }
+    bool failed() const { return this->keyIndexFailed; }
+};
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(33);
+    long hits = 0;
+
+    for (int trial = 0; trial < 3000; trial++) {
+        std::string s = json_random_document(rng, 6, true);
+
+        JsonParser scan;
+        scan.addString(s.c_str());
+        CHECK(scan.parse() == true);
+
+        JsonParser indexed;
+        indexed.enableKeyIndex();
+        indexed.addString(s.c_str());
+        CHECK(indexed.parse() == true);
+
+        JsonParserKeySlot slots[64];
+        JsonParserStatic<4096, 1024> pool;
+        pool.enableKeyIndex(slots, 64);
+        pool.addString(s.c_str());
+        CHECK(pool.parse() == true);
+
+        JsonParserKeySlot fewSlots[2];
+        JsonParserStatic<4096, 1024> tooFew;
+        tooFew.enableKeyIndex(fewSlots, 2);
+        tooFew.addString(s.c_str());
+        CHECK(tooFew.parse() == true);
+
+        JsonParser *parsers[3] = { &indexed, &pool, &tooFew };
+        size_t n = scan.getTokensEnd() - scan.getTokens();
+        for (size_t i = 0; i < n; i++) {
+            if (scan.getTokens()[i].type != JSMN_OBJECT) continue;
+            for (int k = 0; k < 7; k++) {
+                char key[8];
+                snprintf(key, sizeof(key), "k%d", k);
+                const jsmntok_t *expected = 0;
+                bool found = scan.getValueTokenByKey(&scan.getTokens()[i], key, expected);
+                hits += found;
+                for (JsonParser *p : parsers) {
+                    const jsmntok_t *value = 0;
+                    CHECK(p->getValueTokenByKey(&p->getTokens()[i], key, value) == found);
+                    if (found) CHECK(value - p->getTokens() == expected - scan.getTokens());
+                }
+            }
+        }
+
+        // Chains: k0.k1.k2 ... through JsonReference, indexed vs scan.
+        for (int k = 0; k < 6; k++) {
+            char a[4], b[4];
+            snprintf(a, sizeof(a), "k%d", k);
+            snprintf(b, sizeof(b), "k%d", (k + 1) % 6);
+            JsonReference r1 = scan.getReference().key(a).key(b).key(a);
+            JsonReference r2 = indexed.getReference().key(a).key(b).key(a);
+            CHECK(r1.valueString() == r2.valueString());
+        }
+    }
+    CHECK(hits > 10000);
+
+    // Re-parse invalidates the index.
+    {
+        JsonParser p;
+        p.enableKeyIndex();
+        p.addString("{\"a\":1,\"b\":2}");
+        p.parse();
+        int v = 0;
+        CHECK(p.getOuterValueByKey("b", v) && v == 2);
+        p.clear();
+        p.addString("{\"b\":3,\"c\":4,\"a\":5}");
+        p.parse();
+        CHECK(p.getOuterValueByKey("b", v) && v == 3);
+        CHECK(p.getOuterValueByKey("a", v) && v == 5);
+        CHECK(p.getOuterValueByKey("d", v) == false);
+    }
+
+    // Slots too few or not a power of 2: the build fails once per parse() and every lookup goes straight to the scan.
+    for (size_t numSlots : { (size_t)4, (size_t)24 }) {
+        JsonParserKeySlot slots[24];
+        memset(slots, 0xa5, sizeof(slots));
+        IndexState<256, 32> p;
+        p.enableKeyIndex(slots, numSlots);
+        p.addString("{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5}");
+        CHECK(p.parse() == true);
+        CHECK(p.failed() == false);
+        int v = 0;
+        CHECK(p.getOuterValueByKey("e", v) && v == 5);
+        CHECK(p.failed() == true && p.built() == false);
+        CHECK(p.getOuterValueByKey("a", v) && v == 1);
+        CHECK(p.getOuterValueByKey("f", v) == false);
+        CHECK(slots[0].key == 0xa5a5);              // Never cleared: no build was tried after the first
+        CHECK(p.parse() == true);
+        CHECK(p.failed() == false);
+        CHECK(p.getOuterValueByKey("c", v) && v == 3);
+        CHECK(p.failed() == true);
+
+        // Enough slots: the next lookup builds the index.
+        p.enableKeyIndex(slots, 16);
+        CHECK(p.failed() == false);
+        CHECK(p.getOuterValueByKey("d", v) && v == 4);
+        CHECK(p.built() == true && p.failed() == false);
+    }
+
+    if (bench == true) {
+        for (int width : { 8, 64, 512 }) {
+            std::string s = "{";
+            for (int i = 0; i < width; i++) {
+                if (i > 0) s += ",";
+                s += "\"key" + std::to_string(i) + "\":" + std::to_string(i);
+            }
+            s += "}";
+            std::vector<std::string> keys;
+            for (int i = 0; i < width; i++) keys.push_back("key" + std::to_string(i));
+
+            double ns[2];
+            for (int idx = 0; idx < 2; idx++) {
+                JsonParser p;
+                if (idx == 1) p.enableKeyIndex();
+                p.addString(s.c_str());
+                p.parse();
+                ns[idx] = bench_ns(2000000, [&](long i) {
+                    int v;
+                    p.getOuterValueByKey(keys[i % width].c_str(), v);
+                    keep(v);
+                });
+            }
+            printf("bench key lookup, width %3d: scan %.1f ns, index %.1f ns\n", width, ns[0], ns[1]);
+        }
+    }
+
+    TEST_END();
+}
@@ -0,0 +1,295 @@
+// JsonModifier batches: random objects (with arrays and varied whitespace) take random mixes of updates, inserts,
+// key removals, array appends & index removals in one batch, and must come out as a model says, and parse.  Running
+// out of scratch, splices or parser buffer leaves the document unchanged.  Benchmarks k updates to a 60-key config
+// document, one JsonModifier call at a time against one batch.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+#include <map>
+#include <random>
+
+static std::mt19937 rng(40);
+
+struct Item {
+    std::string         key;
+    bool                isArray;
+    int                 value;
+    std::vector<int>    array;
+    std::vector<bool>   arrayRemoved;
+    std::vector<int>    appended;
+    bool                removed = false;
+};
+
+static std::string whitespace() {
+    int r = rng() % 4;
+    return (r == 0) ? " " : (r == 1) ? "\n  " : "";
+}
+
+// Whitespace outside strings removed, so output compares with the model however the modifier spaced it.
+static std::string compact(const std::string &s) {
+    std::string out;
+    bool inString = false;
+    for (size_t i = 0; i < s.size(); i++) {
+        char c = s[i];
+        if (inString) {
+            out += c;
+            if (c == '\\') out += s[++i];
+            else if (c == '"') inString = false;
+        }
+        else if (c == '"') {
+            inString = true;
+            out += c;
+        }
+        else if (!isspace((unsigned char)c)) {
+            out += c;
+        }
+    }
+    return out;
+}
+
+// The model's document: surviving items in order, inserted keys at the end.
+static std::string serialize(const std::vector<Item> &items) {
+    std::string out = "{";
+    bool first = true;
+    for (auto &item : items) {
+        if (item.removed) continue;
+        if (!first) out += ",";
+        first = false;
+        out += "\"" + item.key + "\":";
+        if (item.isArray) {
+            out += "[";
+            bool firstElement = true;
+            for (size_t i = 0; i < item.array.size(); i++) {
+                if (item.arrayRemoved[i]) continue;
+                if (!firstElement) out += ",";
+                firstElement = false;
+                out += std::to_string(item.array[i]);
+            }
+            for (int v : item.appended) {
+                if (!firstElement) out += ",";
+                firstElement = false;
+                out += std::to_string(v);
+            }
+            out += "]";
+        }
+        else
+        {
+            out += std::to_string(item.value);
+        }
+    }
+    return out + "}";
+}
+
+static std::string configDocument() {
+    std::string doc = "{";
+    for (int i = 0; i < 60; i++) {
+        if (i > 0) doc += ",";
+        doc += "\"key" + std::to_string(i) + "\":" + std::to_string(i * 37);
+    }
+    return doc + "}";
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    size_t edits = 0;
+
+    for (int trial = 0; trial < 20000 && testFailures == 0; trial++) {
+        std::vector<Item> items;
+        int n = rng() % 8;
+        for (int i = 0; i < n; i++) {
+            Item item;
+            item.key = "k" + std::to_string(i);
+            item.isArray = (rng() % 3) == 0;
+            item.value = rng() % 1000;
+            if (item.isArray) {
+                int m = rng() % 5;
+                for (int j = 0; j < m; j++) {
+                    item.array.push_back(rng() % 100);
+                    item.arrayRemoved.push_back(false);
+                }
+            }
+            items.push_back(item);
+        }
+
+        std::string doc = "{" + whitespace();
+        for (int i = 0; i < n; i++) {
+            if (i > 0) doc += whitespace() + "," + whitespace();
+            doc += "\"" + items[i].key + "\"" + whitespace() + ":" + whitespace();
+            if (items[i].isArray) {
+                doc += "[" + whitespace();
+                for (size_t j = 0; j < items[i].array.size(); j++) {
+                    if (j > 0) doc += whitespace() + "," + whitespace();
+                    doc += std::to_string(items[i].array[j]);
+                }
+                doc += whitespace() + "]";
+            }
+            else
+            {
+                doc += std::to_string(items[i].value);
+            }
+        }
+        doc += whitespace() + "}";
+
+        JsonParser jp;
+        jp.allocate(doc.size() + 400);
+        jp.addString(doc.c_str());
+        CHECK(jp.parse() == true);
+
+        // Edits refer to the document at startBatch(), so a key updated in this batch isn't then removed or appended to.
+        std::vector<Item> model = items;
+        std::map<std::string, bool> updated;
+        JsonModifierBatch<512, 64> mod(jp);
+        CHECK(mod.startBatch() == true);
+        CHECK(mod.isBatchInProgress() == true);
+        const JsonParserGeneratorRK::jsmntok_t *outer = jp.getOuterObject();
+        const JsonParserGeneratorRK::jsmntok_t *array;
+        int count = rng() % 10;
+        for (int e = 0; e < count; e++) {
+            int kind = rng() % 4;
+            int i = (n > 0) ? (int)(rng() % n) : 0;
+            if (kind == 0) {
+                std::string key = "k" + std::to_string(rng() % 10);
+                int v = rng() % 1000;
+                mod.insertOrUpdateKeyValue(outer, key.c_str(), v);
+                updated[key] = true;
+                for (auto &item : model) {
+                    if (item.key == key) item.removed = true;
+                }
+                Item inserted;
+                inserted.key = key;
+                inserted.isArray = false;
+                inserted.value = v;
+                model.push_back(inserted);
+            }
+            else if (kind == 1 && n > 0 && !updated[items[i].key]) {
+                mod.removeKeyValue(outer, items[i].key.c_str());
+                model[i].removed = true;
+            }
+            else if (kind == 2 && n > 0 && items[i].isArray && !updated[items[i].key]) {
+                jp.getValueTokenByKey(outer, items[i].key.c_str(), array);
+                int v = rng() % 100;
+                mod.appendArrayValue(array, v);
+                model[i].appended.push_back(v);
+            }
+            else if (kind == 3 && n > 0 && items[i].isArray && !items[i].array.empty() && !updated[items[i].key]) {
+                jp.getValueTokenByKey(outer, items[i].key.c_str(), array);
+                size_t j = rng() % items[i].array.size();
+                mod.removeArrayIndex(array, j);
+                model[i].arrayRemoved[j] = true;
+            }
+            else {
+                continue;
+            }
+            edits++;
+        }
+        // Nothing moves until finishBatch().
+        CHECK(std::string(jp.getBuffer(), jp.getOffset()) == doc);
+
+        CHECK(mod.finishBatch() == true);
+        CHECK(mod.isBatchInProgress() == false);
+        std::string got(jp.getBuffer(), jp.getOffset());
+        CHECK(compact(got) == serialize(model));
+        CHECK(jp.parse() == true);
+        if (testFailures > 0) printf("  doc %s\n  got %s\n  expected %s\n", doc.c_str(), got.c_str(), serialize(model).c_str());
+    }
+    printf("%zu edits in batches\n", edits);
+
+    // Out of room: the document is left as it was.
+    {
+        JsonParserStatic<64, 16> jp;
+        jp.addString("{\"a\":1,\"b\":[1,2]}");
+        jp.parse();
+        std::string before(jp.getBuffer(), jp.getOffset());
+
+        JsonModifierBatch<8, 4> smallScratch(jp);
+        smallScratch.startBatch();
+        smallScratch.insertOrUpdateKeyValue(jp.getOuterObject(), "long_key_name", 12345);
+        CHECK(smallScratch.finishBatch() == false);
+        CHECK(std::string(jp.getBuffer(), jp.getOffset()) == before);
+
+        JsonModifierBatch<64, 2> fewSplices(jp);
+        fewSplices.startBatch();
+        fewSplices.insertOrUpdateKeyValue(jp.getOuterObject(), "a", 2);
+        fewSplices.insertOrUpdateKeyValue(jp.getOuterObject(), "c", 3);
+        CHECK(fewSplices.finishBatch() == false);
+        CHECK(std::string(jp.getBuffer(), jp.getOffset()) == before);
+
+        JsonModifierBatch<64, 8> mod(jp);
+        mod.startBatch();
+        for (int i = 0; i < 4; i++) {
+            char key[8];
+            snprintf(key, sizeof(key), "key%d", i);
+            mod.insertOrUpdateKeyValue(jp.getOuterObject(), key, 1234567);
+        }
+        CHECK(mod.finishBatch() == false);
+        CHECK(std::string(jp.getBuffer(), jp.getOffset()) == before);
+
+        // The last update of a key wins.
+        mod.startBatch();
+        mod.insertOrUpdateKeyValue(jp.getOuterObject(), "a", "x\"y");
+        mod.insertOrUpdateKeyValue(jp.getOuterObject(), "a", 7);
+        CHECK(mod.finishBatch() == true);
+        int a = 0;
+        CHECK(jp.getOuterValueByKey("a", a) == true && a == 7);
+    }
+
+    // The batch writes the same document as the same updates one at a time.
+    {
+        std::string doc = configDocument();
+        JsonParser one, batch;
+        one.allocate(4096);
+        batch.allocate(4096);
+        one.addString(doc.c_str());
+        batch.addString(doc.c_str());
+        one.parse();
+        batch.parse();
+        JsonModifier sequential(one);
+        JsonModifierBatch<512, 64> mod(batch);
+        mod.startBatch();
+        for (int i = 0; i < 30; i++) {
+            std::string key = "key" + std::to_string(i * 7 % 60);
+            sequential.insertOrUpdateKeyValue(one.getOuterObject(), key.c_str(), i * 1001);
+            mod.insertOrUpdateKeyValue(batch.getOuterObject(), key.c_str(), i * 1001);
+        }
+        CHECK(mod.finishBatch() == true);
+        CHECK(std::string(one.getBuffer(), one.getOffset()) == std::string(batch.getBuffer(), batch.getOffset()));
+    }
+
+    if (bench == true) {
+        // Each iteration re-parses the original document, in both columns.
+        std::string doc = configDocument();
+        JsonParser jp;
+        jp.allocate(4096);
+        for (int k : { 1, 4, 12, 30 }) {
+            double sequentialNs = bench_ns(20000, [&](long r) {
+                jp.clear();
+                jp.addString(doc.c_str());
+                jp.parse();
+                JsonModifier mod(jp);
+                for (int i = 0; i < k; i++) {
+                    char key[16];
+                    snprintf(key, sizeof(key), "key%d", i * 5 % 60);
+                    mod.insertOrUpdateKeyValue(jp.getOuterObject(), key, (int)r + i);
+                }
+                keep(jp);
+            });
+            double batchNs = bench_ns(20000, [&](long r) {
+                jp.clear();
+                jp.addString(doc.c_str());
+                jp.parse();
+                JsonModifierBatch<512, 64> mod(jp);
+                mod.startBatch();
+                for (int i = 0; i < k; i++) {
+                    char key[16];
+                    snprintf(key, sizeof(key), "key%d", i * 5 % 60);
+                    mod.insertOrUpdateKeyValue(jp.getOuterObject(), key, (int)r + i);
+                }
+                mod.finishBatch();
+                keep(jp);
+            });
+            printf("bench %2d updates to a %zu B, 60 key document: one at a time %.1f us, batched %.1f us\n", k,
+                   doc.size(), sequentialNs / 1000, batchNs / 1000);
+        }
+    }
+
+    TEST_END();
+}
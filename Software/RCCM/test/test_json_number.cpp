@@ -0,0 +1,139 @@
+// JsonWriter::insertValue() numbers: byte-identical to the printf formats they replace ("%d"/"%ld"/"%lu",
+// "%.*lf" and "%lf") over every int16, int32/int64 boundaries & random values, an even stride through all float
+// bit patterns, every hundredth in the sensor range (which must also round trip), random doubles & rounding ties.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+#include <climits>
+#include <random>
+
+static long checked = 0;
+
+template <class T>
+static bool same(T value, const char *fmt) {
+    char buf[512], ref[512];
+    JsonWriter jw(buf, sizeof(buf));
+    jw.insertValue(value);
+    jw.nullTerminate();
+    snprintf(ref, sizeof(ref), fmt, value);
+    checked++;
+    if (strcmp(buf, ref) != 0) {
+        printf("  got %s expected %s\n", buf, ref);
+        return false;
+    }
+    return true;
+}
+
+static bool sameDouble(double value, int places) {
+    char buf[512], ref[512];
+    JsonWriter jw(buf, sizeof(buf));
+    jw.setFloatPlaces(places);
+    jw.insertValue(value);
+    jw.nullTerminate();
+    if (places >= 0) {
+        snprintf(ref, sizeof(ref), "%.*lf", places, value);
+    }
+    else
+    {
+        snprintf(ref, sizeof(ref), "%lf", value);
+    }
+    checked++;
+    if (strcmp(buf, ref) != 0) {
+        printf("  %.17g places %d: got %s expected %s\n", value, places, buf, ref);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937_64 rng(36);
+
+    // Integers.
+    for (int v = INT16_MIN; v <= INT16_MAX; v++) CHECK(same(v, "%d"));
+    for (long p = 1; p < LONG_MAX / 10; p *= 10) {
+        for (long v : { p - 1, p, p + 1, -p + 1, -p, -p - 1 }) CHECK(same(v, "%ld"));
+        CHECK(same((unsigned long)p * 10 - 1, "%lu"));
+    }
+    for (long v : { 0L, LONG_MAX, LONG_MIN, (long)INT_MAX, (long)INT_MIN }) CHECK(same(v, "%ld"));
+    CHECK(same(INT_MIN, "%d"));
+    CHECK(same(ULONG_MAX, "%lu"));
+    CHECK(same(UINT_MAX, "%u"));
+    for (int i = 0; i < 1000000; i++) {
+        CHECK(same((int)rng(), "%d"));
+        CHECK(same((long)rng(), "%ld"));
+        CHECK(same((unsigned long)rng(), "%lu"));
+        if (testFailures > 0) break;
+    }
+
+    // Every 4099th float bit pattern (~1M floats, all exponents), through insertValue(float) at each precision.
+    for (uint64_t bits = 0; bits <= 0xFFFFFFFFULL && testFailures == 0; bits += 4099) {
+        uint32_t b = (uint32_t)bits;
+        float f;
+        memcpy(&f, &b, sizeof(f));
+        int places = (int)(bits % 11) - 1;
+        char buf[512], ref[512];
+        JsonWriter jw(buf, sizeof(buf));
+        jw.setFloatPlaces(places);
+        jw.insertValue(f);
+        jw.nullTerminate();
+        if (places >= 0) snprintf(ref, sizeof(ref), "%.*f", places, f);
+        else snprintf(ref, sizeof(ref), "%f", f);
+        checked++;
+        CHECK(strcmp(buf, ref) == 0);
+    }
+
+    // Every hundredth from -1000 to 1000 (temperatures, humidity, charge) at 0-3 places & default; at 2 places
+    // the output reads back as the same double.
+    for (int k = -100000; k <= 100000 && testFailures == 0; k++) {
+        double v = k / 100.0;
+        for (int places = -1; places <= 3; places++) CHECK(sameDouble(v, places));
+        char buf[64];
+        JsonWriter jw(buf, sizeof(buf));
+        jw.setFloatPlaces(2);
+        jw.insertValue(v);
+        jw.nullTerminate();
+        CHECK(strtod(buf, 0) == v);
+    }
+
+    // Random doubles: raw bit patterns (incl. inf, nan, subnormals) and values scaled into the fixed-point range.
+    for (int i = 0; i < 1000000 && testFailures == 0; i++) {
+        int places = (int)(rng() % 11) - 1;
+        double v;
+        switch (i % 4) {
+            case 0: { uint64_t b = rng(); memcpy(&v, &b, sizeof(v)); break; }
+            case 1: v = (double)(int64_t)(rng() % 2000000 - 1000000) / 1000.0; break;
+            case 2: v = (double)(rng() % 200001) / (double)(1ULL << (rng() % 12)) * ((rng() & 1) ? 1 : -1); break;
+            default: v = ldexp((double)(rng() >> 11), (int)(rng() % 140) - 120); break;
+        }
+        CHECK(sameDouble(v, places));
+    }
+
+    // Ties, near-ties & extremes.
+    for (int places = -1; places <= 9; places++) {
+        for (double v : { 0.5, 1.5, 2.5, 0.125, 0.375, 1.005, 2.675, -0.0, 0.0, 1e-300, -1e-300, 5e-324,
+                          1.7976931348623157e308, 18446744073709551615.0, 1e19, 1e20, -0.5, 0.05, 0.25,
+                          (double)INFINITY, -(double)INFINITY, (double)NAN }) {
+            CHECK(sameDouble(v, places));
+        }
+    }
+    printf("%ld values compared\n", checked);
+
+    if (bench == true) {
+        char buf[64], ref[64];
+        double values[1000];
+        for (int i = 0; i < 1000; i++) values[i] = (double)((int)(rng() % 20000) - 10000) / 10.0;
+        JsonWriter jw(buf, sizeof(buf));
+
+        double printfNs = bench_ns(1000000, [&](long i) { snprintf(ref, sizeof(ref), "%d", (int)(i * 7919)); keep(ref); });
+        double fastNs = bench_ns(1000000, [&](long i) { jw.init(); jw.insertValue((int)(i * 7919)); keep(buf); });
+        printf("bench int: snprintf %.1f ns, insertValue %.1f ns\n", printfNs, fastNs);
+        for (int places : { 1, 2, -1 }) {
+            jw.setFloatPlaces(places);
+            printfNs = bench_ns(1000000, [&](long i) { snprintf(ref, sizeof(ref), "%.*lf", (places >= 0) ? places : 6, values[i % 1000]); keep(ref); });
+            fastNs = bench_ns(1000000, [&](long i) { jw.init(); jw.insertValue(values[i % 1000]); keep(buf); });
+            printf("bench double, places %2d: snprintf %.1f ns, insertValue %.1f ns\n", places, printfNs, fastNs);
+        }
+    }
+
+    TEST_END();
+}
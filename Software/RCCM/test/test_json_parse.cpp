@@ -0,0 +1,129 @@
+// JsonParser::parse(): the growable token arena & the static pool against the former count-then-parse scan, on
+// random documents, truncated ones & token-dense ones; benchmarked on webhook-response-sized and multi-KB documents.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+#include "json_corpus.h"
+
+using namespace JsonParserGeneratorRK;
+
+// The former parse(): count tokens with a null pool, allocate exactly, then parse everything again.
+struct countThenParse {
+    std::vector<jsmntok_t> tokens;
+
+    bool parse(const std::string &s) {
+        jsmn_parser parser;
+        jsmn_init(&parser);
+        int count = jsmn_parse(&parser, s.c_str(), s.size(), 0, 0);
+        if (count <= 0) {
+            return false;
+        }
+        tokens.resize(count);
+        jsmn_init(&parser);
+        return jsmn_parse(&parser, s.c_str(), s.size(), tokens.data(), tokens.size()) == count;
+    }
+};
+
+static bool sameTokens(const jsmntok_t *a, const jsmntok_t *aEnd, const std::vector<jsmntok_t> &b) {
+    if ((size_t)(aEnd - a) != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < b.size(); i++) {
+        if ((a[i].type != b[i].type) || (a[i].start != b[i].start) || (a[i].end != b[i].end) || (a[i].size != b[i].size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(32);
+
+    // Random documents, one in ten truncated: same result & same tokens from every mode.
+    for (int trial = 0; trial < 5000; trial++) {
+        std::string s = json_random_document(rng);
+        if (rng() % 10 == 0) s = s.substr(0, s.size() / 2);
+
+        countThenParse reference;
+        bool referenceOk = reference.parse(s);
+
+        JsonParser arena;
+        arena.addString(s.c_str());
+        CHECK(arena.parse() == referenceOk);
+        if (referenceOk) CHECK(sameTokens(arena.getTokens(), arena.getTokensEnd(), reference.tokens));
+
+        JsonParser small;                                      // Grows from 2 tokens, several doublings
+        small.allocateTokens(2);
+        small.addString(s.c_str());
+        CHECK(small.parse() == referenceOk);
+        if (referenceOk) CHECK(sameTokens(small.getTokens(), small.getTokensEnd(), reference.tokens));
+
+        JsonParserStatic<4096, 256> pool;
+        pool.addString(s.c_str());
+        bool fits = referenceOk && (reference.tokens.size() <= 256);
+        CHECK(pool.parse() == fits);
+        if (fits) CHECK(sameTokens(pool.getTokens(), pool.getTokensEnd(), reference.tokens));
+    }
+
+    // Token-dense input (2 bytes per token) is well past the 1-per-8-bytes first guess.
+    {
+        std::string s = "[1";
+        for (int i = 0; i < 5000; i++) s += ",1";
+        s += "]";
+        JsonParser arena;
+        arena.addString(s.c_str());
+        CHECK(arena.parse() == true);
+        CHECK(arena.getTokensEnd() - arena.getTokens() == 5002);
+    }
+
+    // A static pool that's too small fails instead of allocating.
+    {
+        JsonParserStatic<256, 4> pool;
+        pool.addString("{\"a\":1,\"b\":2,\"c\":3}");
+        CHECK(pool.parse() == false);
+        pool.clear();
+        pool.addString("{\"a\":1}");
+        CHECK(pool.parse() == true);
+    }
+
+    // Re-parse after more data arrives (chunked webhook responses) reuses the grown arena.
+    {
+        JsonParser arena;
+        arena.addString("{\"a\":[1,2,");
+        CHECK(arena.parse() == false);
+        arena.addString("3],\"b\":true}");
+        CHECK(arena.parse() == true);
+        CHECK(arena.getTokensEnd() - arena.getTokens() == 8);
+    }
+
+    if (bench == true) {
+        for (size_t size : { (size_t)600, (size_t)4096, (size_t)16384 }) {
+            std::string s = json_records(size);
+            countThenParse reference;
+            double before = bench_ns(20000, [&](long) { keep(reference.parse(s)); });
+            double arena = bench_ns(20000, [&](long) {
+                JsonParser p;
+                p.addString(s.c_str());
+                keep(p.parse());
+            });
+            JsonParser reused;
+            double reusedArena = bench_ns(20000, [&](long) {
+                reused.clear();
+                reused.addString(s.c_str());
+                keep(reused.parse());
+            });
+            printf("bench parse %5zu B: count-then-parse %.0f ns, arena %.0f ns (%.0f%% saved), arena reused %.0f ns\n",
+                   s.size(), before, arena, 100.0 * (before - arena) / before, reusedArena);
+        }
+        std::string s = json_records(600);
+        JsonParserStatic<1024, 128> pool;
+        double ns = bench_ns(20000, [&](long) {
+            pool.clear();
+            pool.addString(s.c_str());
+            keep(pool.parse());
+        });
+        printf("bench parse %5zu B: static pool %.0f ns\n", s.size(), ns);
+    }
+
+    TEST_END();
+}
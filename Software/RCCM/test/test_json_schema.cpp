@@ -0,0 +1,281 @@
+// json_schema.h: json_write_object() is byte-identical to the hand-written insertKeyValue() sequence it replaced for
+// random environmentData, json_read_object() reads it back & agrees with a getKeyValueTokenByIndex() / strcmp()
+// reader on generated config documents and in one walk over a wide object, and fixed-size strings that don't fit are
+// bad values.  Benchmarks both directions against the hand-written code.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+#include <random>
+
+// STATIC CONFIGURATION, as in RCCM.ino.
+#define THRESH_TEMP_LOW                 40
+#define THRESH_TEMP_HIGH                95
+#define THRESH_TEMP_DELTA               0.2
+#define THRESH_BATT_LOW                 25
+#define INTERNAL_COLLECTION_INTERVAL    (60*15)
+#define HEARTBEAT_INTERVAL              (60*60*24)
+#define TIME_STRING_MAX                 32
+
+#include "config_profiles.h"
+#include "json_schema.h"
+
+// As in RCCM.ino.
+struct environmentData {
+    long        time;
+    char        timeString[TIME_STRING_MAX];
+    bool        timeValid;
+    double      batteryCharge;
+    int32_t     batteryState;
+    int32_t     powerSource;
+    double      temperatureF;
+    double      humidity;
+    int32_t     rhHeaterCycles;
+    int32_t     lightLevel;
+    int32_t     lightMin;
+    int32_t     lightMax;
+    double      lightStdDev;
+    int32_t     port1Peak;
+    int32_t     port1Over;
+    double      port2Rms;
+    int32_t     port2Crossings;
+    int32_t     pirEdges;
+    int32_t     coPpm;
+    int32_t     pm25;
+    int32_t     pm10;
+};
+
+static constexpr auto environmentDataSchema = json_schema(
+    json_field("time",          &environmentData::time),
+    json_field("timeStr",       &environmentData::timeString),
+    json_field("timeVal",       &environmentData::timeValid),
+    json_field("battCharge",    &environmentData::batteryCharge),
+    json_field("battState",     &environmentData::batteryState),
+    json_field("pwrSrc",        &environmentData::powerSource),
+    json_field("tempF",         &environmentData::temperatureF),
+    json_field("humidity",      &environmentData::humidity),
+    json_field("rhHeat",        &environmentData::rhHeaterCycles),
+    json_field("lightLevel",    &environmentData::lightLevel),
+    json_field("lightMin",      &environmentData::lightMin),
+    json_field("lightMax",      &environmentData::lightMax),
+    json_field("lightStdDev",   &environmentData::lightStdDev),
+    json_field("port1Peak",     &environmentData::port1Peak),
+    json_field("port1Over",     &environmentData::port1Over),
+    json_field("port2Rms",      &environmentData::port2Rms),
+    json_field("port2Cross",    &environmentData::port2Crossings),
+    json_field("pirEdges",      &environmentData::pirEdges),
+    json_field("coPpm",         &environmentData::coPpm),
+    json_field("pm25",          &environmentData::pm25),
+    json_field("pm10",          &environmentData::pm10)
+);
+
+static constexpr auto thresholdSchema = json_schema(
+    json_field("tempLow",       &thresholdProfile::tempLow),
+    json_field("tempHigh",      &thresholdProfile::tempHigh),
+    json_field("tempDelta",     &thresholdProfile::tempDelta),
+    json_field("battLow",       &thresholdProfile::battLow),
+    json_field("interval",      &thresholdProfile::collectionInterval),
+    json_field("heartbeat",     &thresholdProfile::heartbeatInterval)
+);
+
+// The field by field writer the schema replaced.
+static void handWrite(JsonWriter &jw, const environmentData &e) {
+    JsonWriterAutoObject obj(&jw);
+    jw.insertKeyValue("time", e.time);
+    jw.insertKeyValue("timeStr", e.timeString);
+    jw.insertKeyValue("timeVal", e.timeValid);
+    jw.insertKeyValue("battCharge", e.batteryCharge);
+    jw.insertKeyValue("battState", e.batteryState);
+    jw.insertKeyValue("pwrSrc", e.powerSource);
+    jw.insertKeyValue("tempF", e.temperatureF);
+    jw.insertKeyValue("humidity", e.humidity);
+    jw.insertKeyValue("rhHeat", e.rhHeaterCycles);
+    jw.insertKeyValue("lightLevel", e.lightLevel);
+    jw.insertKeyValue("lightMin", e.lightMin);
+    jw.insertKeyValue("lightMax", e.lightMax);
+    jw.insertKeyValue("lightStdDev", e.lightStdDev);
+    jw.insertKeyValue("port1Peak", e.port1Peak);
+    jw.insertKeyValue("port1Over", e.port1Over);
+    jw.insertKeyValue("port2Rms", e.port2Rms);
+    jw.insertKeyValue("port2Cross", e.port2Crossings);
+    jw.insertKeyValue("pirEdges", e.pirEdges);
+    jw.insertKeyValue("coPpm", e.coPpm);
+    jw.insertKeyValue("pm25", e.pm25);
+    jw.insertKeyValue("pm10", e.pm10);
+}
+
+// The key by key reader the schema replaced: 0, -1 not an object, -2 unknown key / bad value.
+static int handRead(const JsonParser &jp, thresholdProfile &candidate) {
+    const JsonParserGeneratorRK::jsmntok_t *outerObject, *keyToken, *valueToken;
+    char key[16];
+    int intValue;
+    bool valueOk;
+
+    outerObject = jp.getOuterObject();
+    if (outerObject == 0 || outerObject->type != JsonParserGeneratorRK::JSMN_OBJECT) {
+        return -1;
+    }
+    for (size_t ii = 0; jp.getKeyValueTokenByIndex(outerObject, keyToken, valueToken, ii); ii++) {
+        if (valueToken->type != JsonParserGeneratorRK::JSMN_PRIMITIVE) {
+            return -2;
+        }
+        jp.copyTokenValue(keyToken, key, sizeof(key));
+        if (strcmp(key, "tempLow") == 0) valueOk = jp.getTokenValue(valueToken, candidate.tempLow);
+        else if (strcmp(key, "tempHigh") == 0) valueOk = jp.getTokenValue(valueToken, candidate.tempHigh);
+        else if (strcmp(key, "tempDelta") == 0) valueOk = jp.getTokenValue(valueToken, candidate.tempDelta);
+        else if (strcmp(key, "battLow") == 0) valueOk = jp.getTokenValue(valueToken, candidate.battLow);
+        else if (strcmp(key, "interval") == 0) { valueOk = jp.getTokenValue(valueToken, intValue); candidate.collectionInterval = intValue; }
+        else if (strcmp(key, "heartbeat") == 0) { valueOk = jp.getTokenValue(valueToken, intValue); candidate.heartbeatInterval = intValue; }
+        else valueOk = false;
+        if (valueOk == false) {
+            return -2;
+        }
+    }
+    return 0;
+}
+
+static environmentData randomData(std::mt19937 &rng) {
+    environmentData e;
+    auto i32 = [&]() { return (int32_t)(rng() % 200001) - 100000; };
+    auto real = [&]() { return (double)((int)(rng() % 2000001) - 1000000) / ((rng() % 2) ? 100.0 : 7.0); };
+
+    e.time = (long)(rng() % 2000000000);
+    snprintf(e.timeString, sizeof(e.timeString), "Sat Oct %2u %02u:%02u:00 2026", (unsigned)(1 + rng() % 31), (unsigned)(rng() % 24), (unsigned)(rng() % 60));
+    e.timeValid = (rng() % 2) == 0;
+    e.batteryCharge = real();
+    e.batteryState = i32();
+    e.powerSource = i32();
+    e.temperatureF = real();
+    e.humidity = real();
+    e.rhHeaterCycles = i32();
+    e.lightLevel = i32();
+    e.lightMin = i32();
+    e.lightMax = i32();
+    e.lightStdDev = real();
+    e.port1Peak = i32();
+    e.port1Over = i32();
+    e.port2Rms = real();
+    e.port2Crossings = i32();
+    e.pirEdges = i32();
+    e.coPpm = i32();
+    e.pm25 = i32();
+    e.pm10 = i32();
+    return e;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(39);
+    JsonParserStatic<1024, 64> jp;
+
+    // Write: identical bytes; read back: the same integers, strings & flags, and doubles to the written places.
+    for (int trial = 0; trial < 100000 && testFailures == 0; trial++) {
+        environmentData e = randomData(rng);
+        JsonWriterStatic<1024> hand, schema;
+        int places = (int)(rng() % 4);
+        hand.setFloatPlaces(places);
+        schema.setFloatPlaces(places);
+        handWrite(hand, e);
+        json_write_object(schema, e, environmentDataSchema);
+        CHECK(hand.getOffset() == schema.getOffset());
+        CHECK(strcmp(hand.getBuffer(), schema.getBuffer()) == 0);
+
+        environmentData back;
+        memset(&back, 0, sizeof(back));
+        jp.clear();
+        jp.addString(schema.getBuffer());
+        CHECK(jp.parse() == true);
+        CHECK(json_read_object(jp, jp.getOuterObject(), back, environmentDataSchema) == JSON_SCHEMA_OK);
+        CHECK(back.time == e.time && back.timeValid == e.timeValid && strcmp(back.timeString, e.timeString) == 0);
+        CHECK(back.batteryState == e.batteryState && back.pirEdges == e.pirEdges && back.pm10 == e.pm10);
+        CHECK(fabs(back.temperatureF - e.temperatureF) <= 0.5 * pow(10, -places) + 1e-9);
+        CHECK(fabs(back.lightStdDev - e.lightStdDev) <= 0.5 * pow(10, -places) + 1e-9);
+    }
+
+    // Read: the schema reader and the hand-written one agree on result and on every member.
+    const char *keys[] = { "tempLow", "tempHigh", "tempDelta", "battLow", "interval", "heartbeat", "bogus", "tempLo", "tempLowX" };
+    const char *values[] = { "38", "90.5", "-3", "1e2", "\"38\"", "true", "null", "[1]", "0.25" };
+    for (int trial = 0; trial < 200000 && testFailures == 0; trial++) {
+        std::string doc = "{";
+        int n = rng() % 5;
+        for (int i = 0; i < n; i++) {
+            if (i > 0) doc += ",";
+            doc += std::string("\"") + keys[rng() % 9] + "\":" + values[rng() % 9];
+        }
+        doc += "}";
+        if (rng() % 50 == 0) doc = "[1,2]";
+
+        thresholdProfile a = thresholdProfiles[0], b = thresholdProfiles[0];
+        jp.clear();
+        jp.addString(doc.c_str());
+        CHECK(jp.parse() == true);
+        int handResult = handRead(jp, a);
+        int schemaResult = json_read_object(jp, jp.getOuterObject(), b, thresholdSchema);
+        CHECK(handResult == schemaResult);
+        if (handResult == 0) CHECK(memcmp(&a, &b, sizeof(a)) == 0);
+        if (testFailures > 0) printf("  %s: %d %d\n", doc.c_str(), handResult, schemaResult);
+    }
+
+    // A string that doesn't fit the member (with its terminator) is a bad value, not truncated.
+    {
+        environmentData e;
+        std::string fits(TIME_STRING_MAX - 1, 'x');
+        jp.clear();
+        jp.addString(("{\"timeStr\":\"" + fits + "\"}").c_str());
+        jp.parse();
+        CHECK(json_read_object(jp, jp.getOuterObject(), e, environmentDataSchema) == JSON_SCHEMA_OK);
+        CHECK(fits == e.timeString);
+        jp.clear();
+        jp.addString(("{\"timeStr\":\"" + fits + "y\"}").c_str());
+        jp.parse();
+        CHECK(json_read_object(jp, jp.getOuterObject(), e, environmentDataSchema) == JSON_SCHEMA_BAD_VALUE);
+        jp.clear();
+        jp.addString("{\"timeStr\":5}");
+        jp.parse();
+        CHECK(json_read_object(jp, jp.getOuterObject(), e, environmentDataSchema) == JSON_SCHEMA_BAD_VALUE);
+    }
+
+    // A wide object with nested values, read in one walk, with and without the sibling index: later keys win.
+    for (int sibling = 0; sibling < 2; sibling++) {
+        JsonParserStatic<16384, 2048> wide;
+        if (sibling == 1) {
+            wide.enableSiblingIndex();
+        }
+        std::string doc = "{";
+        for (int i = 0; i < 300; i++) {
+            doc += std::string((i > 0) ? "," : "") + "\"tempLow\":" + std::to_string(i) + ",\"tempHigh\":" + std::to_string(i + 50);
+        }
+        doc += "}";
+        wide.addString(doc.c_str());
+        CHECK(wide.parse() == true);
+        thresholdProfile t = thresholdProfiles[0];
+        CHECK(json_read_object(wide, wide.getOuterObject(), t, thresholdSchema) == JSON_SCHEMA_OK);
+        CHECK(t.tempLow == 299 && t.tempHigh == 349);
+        wide.clear();
+        wide.addString("{\"tempLow\":1,\"tempHigh\":2,\"bogus\":[[1,2],{\"a\":[3]}],\"battLow\":4}");
+        CHECK(wide.parse() == true);
+        CHECK(json_read_object(wide, wide.getOuterObject(), t, thresholdSchema) == JSON_SCHEMA_BAD_VALUE);
+        wide.clear();
+        wide.addString("{}");
+        CHECK(wide.parse() == true);
+        CHECK(json_read_object(wide, wide.getOuterObject(), t, thresholdSchema) == JSON_SCHEMA_OK);
+    }
+
+    if (bench == true) {
+        environmentData e = randomData(rng);
+        JsonWriterStatic<1024> jw;
+        jw.setFloatPlaces(2);
+        double handNs = bench_ns(300000, [&](long) { jw.init(); handWrite(jw, e); keep(jw); });
+        double schemaNs = bench_ns(300000, [&](long) { jw.init(); json_write_object(jw, e, environmentDataSchema); keep(jw); });
+        printf("bench write environmentData (%zu B): hand-written %.0f ns, schema %.0f ns\n", jw.getOffset(), handNs, schemaNs);
+
+        const char *doc = "{\"tempLow\":38,\"tempHigh\":90,\"tempDelta\":0.5,\"battLow\":20,\"interval\":900,\"heartbeat\":86400}";
+        thresholdProfile c = thresholdProfiles[0];
+        jp.clear();
+        jp.addString(doc);
+        jp.parse();
+        handNs = bench_ns(300000, [&](long) { handRead(jp, c); keep(c); });
+        schemaNs = bench_ns(300000, [&](long) { json_read_object(jp, jp.getOuterObject(), c, thresholdSchema); keep(c); });
+        printf("bench read config (6 keys, parsed): hand-written %.0f ns, schema %.0f ns\n", handNs, schemaNs);
+    }
+
+    TEST_END();
+}
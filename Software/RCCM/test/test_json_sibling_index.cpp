@@ -0,0 +1,129 @@
+// JsonParser sibling index: indexed element access (getValueTokenByIndex, getValueTokenByColRow, getArraySize)
+// matches the recursive walk on random nested documents, with malloc'd, static & too-small storage.  Benchmarks
+// column/row access on large 2-D arrays.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+#include "json_corpus.h"
+
+using namespace JsonParserGeneratorRK;
+
+static std::string grid(int columns, int rows) {
+    std::string s = "[";
+    for (int c = 0; c < columns; c++) {
+        if (c > 0) s += ",";
+        s += "[";
+        for (int r = 0; r < rows; r++) {
+            if (r > 0) s += ",";
+            s += std::to_string(c * rows + r);
+        }
+        s += "]";
+    }
+    return s + "]";
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(34);
+    long hits = 0;
+
+    for (int trial = 0; trial < 3000; trial++) {
+        std::string s = json_random_document(rng);
+
+        JsonParser walk;
+        walk.addString(s.c_str());
+        CHECK(walk.parse() == true);
+
+        JsonParser indexed;
+        indexed.enableSiblingIndex();
+        indexed.enableKeyIndex();
+        indexed.addString(s.c_str());
+        CHECK(indexed.parse() == true);
+
+        uint16_t next[1024];
+        JsonParserStatic<4096, 1024> pool;
+        pool.enableSiblingIndex(next, 1024);
+        pool.addString(s.c_str());
+        CHECK(pool.parse() == true);
+
+        uint16_t tooFew[4];
+        JsonParserStatic<4096, 1024> small;
+        small.enableSiblingIndex(tooFew, 4);
+        small.addString(s.c_str());
+        CHECK(small.parse() == true);
+
+        JsonParser *parsers[3] = { &indexed, &pool, &small };
+        size_t n = walk.getTokensEnd() - walk.getTokens();
+        for (size_t i = 0; i < n; i++) {
+            const jsmntok_t *container = &walk.getTokens()[i];
+            if ((container->type != JSMN_OBJECT) && (container->type != JSMN_ARRAY)) continue;
+
+            for (JsonParser *p : parsers) {
+                CHECK(p->getArraySize(&p->getTokens()[i]) == walk.getArraySize(container));
+            }
+            for (int k = 0; k < 10; k++) {
+                const jsmntok_t *expected = 0;
+                bool found = walk.getValueTokenByIndex(container, k, expected);
+                hits += found;
+                for (JsonParser *p : parsers) {
+                    const jsmntok_t *value = 0;
+                    CHECK(p->getValueTokenByIndex(&p->getTokens()[i], k, value) == found);
+                    if (found) CHECK(value - p->getTokens() == expected - walk.getTokens());
+                }
+                for (int r = 0; r < 4; r++) {
+                    found = walk.getValueTokenByColRow(container, k, r, expected);
+                    for (JsonParser *p : parsers) {
+                        const jsmntok_t *value = 0;
+                        CHECK(p->getValueTokenByColRow(&p->getTokens()[i], k, r, value) == found);
+                        if (found) CHECK(value - p->getTokens() == expected - walk.getTokens());
+                    }
+                }
+            }
+        }
+    }
+    CHECK(hits > 5000);
+
+    // Every cell of a 2-D array.
+    {
+        JsonParser p;
+        p.enableSiblingIndex();
+        std::string s = grid(40, 30);
+        p.addString(s.c_str());
+        CHECK(p.parse() == true);
+        const jsmntok_t *outer = p.getOuterArray();
+        CHECK(p.getArraySize(outer) == 40);
+        bool all = true;
+        for (int c = 0; c < 40; c++) {
+            for (int r = 0; r < 30; r++) {
+                int v = -1;
+                all = all && p.getValueByColRow(outer, c, r, v) && (v == c * 30 + r);
+            }
+        }
+        CHECK(all == true);
+        int v;
+        CHECK(p.getValueByColRow(outer, 40, 0, v) == false);
+        CHECK(p.getValueByColRow(outer, 0, 30, v) == false);
+    }
+
+    if (bench == true) {
+        for (int size : { 32, 100, 200 }) {             // 200x200 is 40k tokens; the index holds up to 64k
+            std::string s = grid(size, size);
+            double ns[2];
+            for (int idx = 0; idx < 2; idx++) {
+                JsonParser p;
+                if (idx == 1) p.enableSiblingIndex();
+                p.addString(s.c_str());
+                p.parse();
+                const jsmntok_t *outer = p.getOuterArray();
+                long cells = (long)size * size;
+                ns[idx] = bench_ns(std::max(cells, 200000L), [&](long i) {
+                    const jsmntok_t *value;
+                    p.getValueTokenByColRow(outer, (i / size) % size, i % size, value);
+                    keep(value);
+                });
+            }
+            printf("bench getValueTokenByColRow %dx%d: walk %.0f ns, sibling index %.0f ns per cell\n", size, size, ns[0], ns[1]);
+        }
+    }
+
+    TEST_END();
+}
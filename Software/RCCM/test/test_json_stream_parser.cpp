@@ -0,0 +1,237 @@
+// JsonStreamParser: random documents fed as shuffled (and duplicated) hook-response chunks and byte at a time call
+// back with exactly the leaves a reference path matcher selects; malformed documents are errors; \u escapes,
+// including unpaired surrogates, decode to UTF-8; too many out-of-order chunks fail.  Benchmarks against buffering
+// with JsonParser::addChunkedData() and parsing the whole response.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+#include "json_corpus.h"
+#include <algorithm>
+#include <random>
+
+typedef std::vector<std::pair<std::string, std::string>> Leaves;
+
+static std::mt19937 rng(38);
+
+static std::string escaped(const std::string &v) {
+    std::string out = "\"";
+    for (char c : v) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        }
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out + "\"";
+}
+
+// A random value at path; every string & primitive is appended to leaves in document order.  Whitespace varies.
+static std::string generate(int depth, const std::string &path, Leaves &leaves) {
+    int kind = (depth > 4) ? (int)(5 + rng() % 5) : (int)(rng() % 10);
+    auto child = [&](const std::string &seg) { return path.empty() ? seg : path + "/" + seg; };
+
+    if (kind < 2) {
+        std::string s = "{";
+        int n = rng() % 6;
+        for (int i = 0; i < n; i++) {
+            std::string key = "k" + std::to_string(rng() % 50);
+            if (i > 0) s += (rng() % 2) ? ", " : ",";
+            s += "\"" + key + "\"" + ((rng() % 2) ? " : " : ":");
+            s += generate(depth + 1, child(key), leaves);
+        }
+        return s + ((rng() % 2) ? " }" : "}");
+    }
+    if (kind < 4) {
+        std::string s = "[";
+        int n = rng() % 6;
+        for (int i = 0; i < n; i++) {
+            if (i > 0) s += ",\n";
+            s += generate(depth + 1, child(std::to_string(i)), leaves);
+        }
+        return s + "]";
+    }
+    if (kind < 6) {
+        std::string v;
+        int n = rng() % 40;
+        for (int i = 0; i < n; i++) {
+            int c = rng() % 20;
+            v += (c == 0) ? '"' : (c == 1) ? '\\' : (c == 2) ? '\n' : (char)('a' + c);
+        }
+        leaves.push_back({ path, v });
+        return escaped(v);
+    }
+    std::string v = (kind == 6) ? "true" : (kind == 7) ? "null" : std::to_string((int)(rng() % 200000) - 100000) + ((rng() % 2) ? ".25" : "");
+    leaves.push_back({ path, v });
+    return v;
+}
+
+// Reference: segment by segment, * matches any one key or index.
+static bool matches(const std::string &pattern, const std::string &path) {
+    size_t a = 0, b = 0;
+    while (true) {
+        size_t ea = pattern.find('/', a), eb = path.find('/', b);
+        std::string sa = pattern.substr(a, (ea == std::string::npos) ? std::string::npos : ea - a);
+        std::string sb = path.substr(b, (eb == std::string::npos) ? std::string::npos : eb - b);
+        if (sa != "*" && sa != sb) return false;
+        if ((ea == std::string::npos) != (eb == std::string::npos)) return false;
+        if (ea == std::string::npos) return true;
+        a = ea + 1;
+        b = eb + 1;
+    }
+}
+
+// The strings called back for "*" on a single-key document {"s":"<body>"}.
+static std::string decode(const char *body) {
+    JsonStreamParserStatic<16, 64> parser;
+    std::string out;
+    parser.subscribe("*", [&](const char *, const char *value, JsonParserGeneratorRK::jsmntype_t) { out += value; });
+    std::string doc = std::string("{\"s\":\"") + body + "\"}";
+    parser.addData(doc.c_str(), doc.size());
+    CHECK(parser.isDone() == true);
+    CHECK(parser.hasError() == false);
+    return out;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    const std::vector<std::string> patterns = { "*", "k1", "*/k2", "*/*/*", "k3/*/k4", "0/*", "*/0/k5/*", "k7/k8" };
+    size_t chunkCount = 0;
+
+    for (int trial = 0; trial < 4000 && testFailures == 0; trial++) {
+        Leaves leaves;
+        std::string doc;
+        do {
+            leaves.clear();
+            doc = generate(0, "", leaves);
+        } while (doc[0] != '{' && doc[0] != '[');
+
+        // Callbacks come per leaf, then per matching subscription.
+        Leaves expected;
+        for (auto &leaf : leaves) {
+            for (auto &pattern : patterns) {
+                if (matches(pattern, leaf.first)) expected.push_back(leaf);
+            }
+        }
+
+        // Fixed-size chunks, each displaced by up to 3 places, sometimes one delivered twice.
+        size_t chunkSize = 16 + rng() % 64;
+        std::vector<std::pair<double, std::pair<int, std::string>>> order;
+        for (size_t offset = 0, index = 0; offset < doc.size(); offset += chunkSize, index++) {
+            order.push_back({ index + (rng() % 1000) / 250.0, { (int)index, doc.substr(offset, chunkSize) } });
+        }
+        std::sort(order.begin(), order.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        std::vector<std::pair<int, std::string>> chunks;
+        for (auto &o : order) chunks.push_back(o.second);
+        if (rng() % 4 == 0 && chunks.size() > 1) {
+            chunks.insert(chunks.begin() + rng() % chunks.size(), chunks[rng() % chunks.size()]);
+        }
+        chunkCount += chunks.size();
+
+        JsonStreamParserStatic<128, 64, 8, 80> parser;
+        Leaves got;
+        for (auto &pattern : patterns) {
+            parser.subscribe(pattern.c_str(), [&](const char *path, const char *value, JsonParserGeneratorRK::jsmntype_t) {
+                got.push_back({ path, value });
+            });
+        }
+        for (auto &chunk : chunks) {
+            std::string event = "hook-response/forecast/" + std::to_string(chunk.first);
+            parser.addChunkedData(event.c_str(), chunk.second.c_str());
+        }
+        CHECK(parser.isDone() == true);
+        CHECK(parser.hasError() == false);
+        CHECK(parser.isTruncated() == false);
+        CHECK(got == expected);
+
+        // In order, a byte at a time.
+        parser.reset();
+        got.clear();
+        for (char ch : doc) parser.addData(&ch, 1);
+        CHECK(parser.isDone() == true);
+        CHECK(got == expected);
+
+        if (testFailures > 0) printf("  trial %d, %zu chunks of %zu: %s\n", trial, chunks.size(), chunkSize, doc.c_str());
+    }
+    printf("%zu chunks parsed\n", chunkCount);
+
+    // Malformed documents.
+    for (const char *doc : { "{\"a\" 1}", "[1,]x", "{\"a\":tru e}", "[\"\\q\"]", "5 ", "{]", "[1 2]" }) {
+        JsonStreamParserStatic<32, 32> parser;
+        parser.addData(doc, strlen(doc));
+        parser.addData(" ", 1);
+        CHECK(parser.hasError() == true);
+    }
+
+    // \u escapes.  A surrogate pair makes one 4-byte character; either half on its own becomes U+FFFD, and a pending
+    // first half doesn't survive another character or escape to pair with a later, unrelated second half.
+    CHECK(decode("\\u00e9\\u20AC") == "\xc3\xa9\xe2\x82\xac");
+    CHECK(decode("\\ud83d\\ude00") == "\xf0\x9f\x98\x80");
+    CHECK(decode("\\ud83d") == "\xef\xbf\xbd");
+    CHECK(decode("\\ude00x") == "\xef\xbf\xbdx");
+    CHECK(decode("\\ud83dx\\ude00") == "\xef\xbf\xbdx\xef\xbf\xbd");
+    CHECK(decode("\\ud83d\\n\\ude00") == "\xef\xbf\xbd\n\xef\xbf\xbd");
+    CHECK(decode("\\ud83d\\u0041") == "\xef\xbf\xbd" "A");
+    CHECK(decode("\\ud83d\\ud83d\\ude00") == "\xef\xbf\xbd\xf0\x9f\x98\x80");
+
+    // A value longer than the value buffer is truncated and flagged; parsing carries on.
+    {
+        JsonStreamParserStatic<32, 12> parser;
+        std::string out;
+        parser.subscribe("*", [&](const char *, const char *value, JsonParserGeneratorRK::jsmntype_t) { out += value; out += "|"; });
+        const char *doc = "{\"long\":\"0123456789abcdef\",\"n\":-1.5e3}";
+        parser.addData(doc, strlen(doc));
+        CHECK(parser.isTruncated() == true);
+        CHECK(parser.isDone() == true);
+        CHECK(out.substr(out.size() - 7) == "-1.5e3|");
+    }
+
+    // More chunks ahead of the next expected one than there are reorder slots.
+    {
+        JsonStreamParserStatic<32, 8, 1, 4> parser;
+        CHECK(parser.addChunkedData("e/2", "cdef") == true);
+        CHECK(parser.addChunkedData("e/3", "gh") == false);
+        CHECK(parser.hasError() == true);
+    }
+
+    if (bench == true) {
+        // A 6 KB hook-response in 512 byte chunks: subscribe to one field per record, against buffering all of it and
+        // parsing with JsonParser.  Peak RAM is the fixed buffers against the whole response plus its tokens.
+        std::string doc = json_records(6000);
+        std::vector<std::string> chunks;
+        for (size_t offset = 0; offset < doc.size(); offset += 512) chunks.push_back(doc.substr(offset, 512));
+
+        JsonStreamParserStatic<32, 16> stream;
+        double sum = 0;
+        stream.subscribe("records/*/tempF", [&](const char *, const char *value, JsonParserGeneratorRK::jsmntype_t) { sum += atof(value); });
+        double streamNs = bench_ns(2000, [&](long) {
+            stream.reset();
+            for (size_t i = 0; i < chunks.size(); i++) {
+                stream.addChunkedData(("hook-response/x/" + std::to_string(i)).c_str(), chunks[i].c_str());
+            }
+            keep(sum);
+        });
+
+        size_t tokens = 0;
+        double bufferedNs = bench_ns(2000, [&](long) {
+            JsonParser jp;
+            for (size_t i = 0; i < chunks.size(); i++) {
+                jp.addChunkedData(("hook-response/x/" + std::to_string(i)).c_str(), chunks[i].c_str());
+            }
+            jp.parse();
+            const JsonParserGeneratorRK::jsmntok_t *records;
+            jp.getValueTokenByKey(jp.getOuterObject(), "records", records);
+            for (size_t i = 0; i < (size_t)records->size; i++) {
+                const JsonParserGeneratorRK::jsmntok_t *record = jp.getTokenByIndex(records, i);
+                float tempF;
+                if (record != 0 && jp.getValueByKey(record, "tempF", tempF)) sum += tempF;
+            }
+            tokens = jp.getTokensEnd() - jp.getTokens();
+            keep(sum);
+        });
+        printf("bench %zu B response in %zu chunks: buffered JsonParser %.0f us (%zu B + %zu tokens), "
+               "JsonStreamParser %.0f us (%zu B)\n", doc.size(), chunks.size(), bufferedNs / 1000, doc.size(), tokens,
+               streamNs / 1000, sizeof(stream));
+    }
+
+    TEST_END();
+}
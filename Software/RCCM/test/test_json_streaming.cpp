@@ -0,0 +1,183 @@
+// Streaming JsonWriter: multi-chunk output through a sink matches the buffered writer byte for byte at several
+// window sizes; a failing sink truncates; JsonWriterPublishSink reassembles with addChunkedData(), keeps to the
+// publish rate limit (fail early, or pace), publishes exactly dataLen bytes and refuses oversize chunks.
+#include "test.h"
+#include "JsonParserGeneratorRK.cpp"
+
+struct vectorSink : public JsonWriterSink {
+    std::vector<std::string>    chunks;
+    int                         failAt = -1;
+    bool                        terminated = true;
+
+    bool write(const char *data, size_t dataLen) override {
+        if ((int)chunks.size() == failAt) return false;
+        terminated = terminated && (data[dataLen] == 0);
+        chunks.emplace_back(data, dataLen);
+        return true;
+    }
+};
+
+// A report of n entries mixing every insert path, including insertsprintf().
+static void report(JsonWriter &jw, int n) {
+    JsonWriterAutoObject obj(&jw);
+    jw.setFloatPlaces(2);
+    for (int i = 0; i < n; i++) {
+        char key[16];
+        snprintf(key, sizeof(key), "probe%d", i);
+        jw.insertKeyObject(key);
+        jw.insertKeyValue("tempF", 12.5 + i);
+        jw.insertKeyValue("count", i * 1000);
+        jw.insertKeyValue("name", "caf\xc3\xa9 \"crawl\"\n");
+        jw.insertsprintf(",\"pad\":\"%0*d\"", i % 40, i);
+        jw.finishObjectOrArray();
+    }
+}
+
+static std::string buffered(int n) {
+    JsonWriter jw;
+    jw.allocate(100000);
+    report(jw, n);
+    return std::string(jw.getBuffer(), jw.getOffset());
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+
+    // Every window size gives the same bytes as the buffered writer; all chunks but the last are full.
+    for (int n = 0; n < 60; n += 3) {
+        std::string expected = buffered(n);
+        for (size_t window : { (size_t)64, (size_t)65, (size_t)100, (size_t)512 }) {
+            vectorSink sink;
+            std::vector<char> buf(window + 1);
+            JsonWriter jw(buf.data(), window);
+            jw.setSink(&sink);
+            report(jw, n);
+
+            std::string got;
+            bool full = true;
+            for (size_t c = 0; c < sink.chunks.size(); c++) {
+                got += sink.chunks[c];
+                full = full && ((c + 1 == sink.chunks.size()) || (sink.chunks[c].size() == window));
+            }
+            CHECK(got == expected);
+            CHECK(full == true);
+            CHECK(sink.terminated == true);
+            CHECK(jw.isTruncated() == false);
+            CHECK(sink.chunks.size() == (expected.size() + window - 1) / window);
+        }
+    }
+
+    // A sink failure truncates and stops the output.
+    {
+        vectorSink sink;
+        sink.failAt = 2;
+        JsonWriterStreaming<64> jw(sink);
+        report(jw, 20);
+        CHECK(jw.isTruncated() == true);
+        CHECK(sink.chunks.size() == 2);
+    }
+
+    // Publish sink, paced: every chunk goes out, at most 4 back to back then 1 per second, and the events put back
+    // together (in any order) with addChunkedData().
+    {
+        std::string expected = buffered(57);
+        host::published.clear();
+        host::delayedUs = 0;
+        uint64_t startUs = host::nowUs;
+        JsonWriterPublishSink sink("RCCM_Report", JsonWriterPublishSink::PUBLISH_PERIOD_MS);
+        {
+            JsonWriterStreaming<512> jw(sink);
+            report(jw, 57);
+            CHECK(jw.isTruncated() == false);
+        }
+        size_t chunks = (expected.size() + 511) / 512;
+        CHECK(chunks > JsonWriterPublishSink::PUBLISH_BURST);
+        CHECK(host::published.size() == chunks);
+        CHECK(sink.getChunkCount() == chunks);
+
+        // Token bucket: any k consecutive publishes span at least (k - 4) s, and the whole report took (chunks - 4) s
+        // of waiting.
+        for (size_t i = 0; i < host::published.size(); i++) {
+            for (size_t j = 0; j + JsonWriterPublishSink::PUBLISH_BURST < i + 1; j++) {
+                CHECK(host::published[i].atUs - host::published[j].atUs >= (i - j + 1 - JsonWriterPublishSink::PUBLISH_BURST) * 1000000);
+            }
+        }
+        CHECK(host::nowUs - startUs == (chunks - JsonWriterPublishSink::PUBLISH_BURST) * 1000000);
+
+        JsonParser jp;
+        for (size_t i = host::published.size(); i-- > 0; ) {
+            CHECK(host::published[i].name == "RCCM_Report/" + std::to_string(i));
+            jp.addChunkedData(host::published[i].name.c_str(), host::published[i].data.c_str());
+        }
+        CHECK(std::string(jp.getBuffer(), jp.getOffset()) == expected);
+        CHECK(jp.parse() == true);
+    }
+
+    // Publish sink, not paced: the burst goes out, the next chunk fails without publishing and the writer stops.
+    // After the budget refills a new report can start.
+    {
+        host::published.clear();
+        host::advanceMs(10000);
+        JsonWriterPublishSink sink("RCCM_Report");
+        CHECK(sink.getChunksAvailable() == JsonWriterPublishSink::PUBLISH_BURST);
+        {
+            JsonWriterStreaming<512> jw(sink);
+            report(jw, 57);
+            CHECK(jw.isTruncated() == true);
+        }
+        CHECK(host::published.size() == JsonWriterPublishSink::PUBLISH_BURST);
+        CHECK(sink.getChunksAvailable() == 0);
+
+        host::advanceMs(1000);
+        CHECK(sink.getChunksAvailable() == 1);
+        host::advanceMs(5000);
+        CHECK(sink.getChunksAvailable() == JsonWriterPublishSink::PUBLISH_BURST);
+
+        sink.reset();
+        host::published.clear();
+        {
+            JsonWriterStreaming<512> jw(sink);
+            report(jw, 12);
+            CHECK(jw.isTruncated() == false);
+        }
+        CHECK(host::published.size() == (buffered(12).size() + 511) / 512);
+        CHECK(host::published.size() >= 2);
+        CHECK(host::published[0].name == "RCCM_Report/0");
+    }
+
+    // write() publishes exactly dataLen bytes, whatever follows them, and refuses more than an event holds.
+    {
+        host::published.clear();
+        host::advanceMs(10000);
+        JsonWriterPublishSink sink("raw");
+        const char window[] = "{\"a\":1}GARBAGE";
+        CHECK(sink.write(window, 7) == true);
+        CHECK(host::published.size() == 1 && host::published[0].data == "{\"a\":1}");
+        std::string big(JsonWriterPublishSink::MAX_CHUNK_SIZE + 1, 'x');
+        CHECK(sink.write(big.c_str(), big.size()) == false);
+        CHECK(sink.write(big.c_str(), JsonWriterPublishSink::MAX_CHUNK_SIZE) == true);
+        CHECK(host::published.size() == 2 && host::published[1].data.size() == JsonWriterPublishSink::MAX_CHUNK_SIZE);
+    }
+
+    // Buffered mode is unchanged: a static writer that's too small truncates.
+    {
+        JsonWriterStatic<256> jw;
+        report(jw, 10);
+        CHECK(jw.isTruncated() == true);
+        CHECK(jw.getOffset() == 256);
+    }
+
+    if (bench == true) {
+        // Peak RAM is the window; time per report against the buffered writer.
+        vectorSink sink;
+        JsonWriterStreaming<512> jw(sink);
+        JsonWriter big;
+        big.allocate(100000);
+        double streamed = bench_ns(20000, [&](long) { sink.chunks.clear(); jw.init(); report(jw, 57); });
+        double whole = bench_ns(20000, [&](long) { big.init(); report(big, 57); });
+        printf("bench 57 entry report (%zu B): buffered %.0f ns, streamed through a 512 B window %.0f ns\n",
+               buffered(57).size(), whole, streamed);
+    }
+
+    TEST_END();
+}
@@ -0,0 +1,110 @@
+// LightMonitor: synthetic ADC traces through process(); streaming statistics against a two-pass reference,
+// door-open steps, lights-on hold & carry-over between intervals.
+#include "test.h"
+#include "LightMonitor.cpp"
+#include <random>
+
+#define PIN_LIGHT_SEN       19
+#define SAMPLE_PERIOD_MS    1000
+#define STEP_THRESHOLD      800
+#define LIGHTS_ON_LEVEL     2000
+#define LIGHTS_ON_HOLD_MS   (1000 * 60 * 30)
+
+static int32_t level = 0;
+
+// Run process() every 10 ms for the given time, with the ADC at trace(t) (t in seconds from the start).
+template <class F>
+static std::vector<int32_t> run(LightMonitor &monitor, uint32_t seconds, F trace) {
+    std::vector<int32_t> sampled;
+    uint64_t startUs = host::nowUs;
+    uint32_t lastSeen = 0xFFFFFFFF;
+
+    host::analogRead = [&](uint16_t pin) -> int32_t {
+        CHECK(pin == PIN_LIGHT_SEN);
+        sampled.push_back(level);
+        return level;
+    };
+    while (host::nowUs < startUs + (uint64_t)seconds * 1000000) {
+        uint32_t t = (uint32_t)((host::nowUs - startUs) / 1000000);
+        if (t != lastSeen) {
+            level = trace(t);
+            lastSeen = t;
+        }
+        monitor.process();
+        host::advanceMs(10);
+    }
+    host::analogRead = nullptr;
+    return sampled;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    LightMonitor monitor(PIN_LIGHT_SEN, SAMPLE_PERIOD_MS, STEP_THRESHOLD, LIGHTS_ON_LEVEL, LIGHTS_ON_HOLD_MS);
+    struct LightMonitor::intervalSummary summary;
+    std::mt19937 rng(27);
+
+    // Dark, noisy cabin: statistics match a two-pass reference, no events.
+    std::normal_distribution<double> noise(300, 40);
+    std::vector<int32_t> samples = run(monitor, 900, [&](uint32_t) { return (int32_t)noise(rng); });
+    monitor.takeInterval(summary);
+    CHECK(summary.samples == samples.size());
+    CHECK(samples.size() == 900);                       // One sample per period, not per process() call
+    double mean = 0;
+    for (int32_t v : samples) mean += v;
+    mean /= samples.size();
+    double var = 0;
+    for (int32_t v : samples) var += (v - mean) * (v - mean);
+    double stdDev = sqrt(var / (samples.size() - 1));
+    CHECK(fabs(summary.mean - mean) < 1e-9);
+    CHECK(fabs(summary.stdDev - stdDev) < 1e-9);
+    CHECK(summary.min == *std::min_element(samples.begin(), samples.end()));
+    CHECK(summary.max == *std::max_element(samples.begin(), samples.end()));
+    CHECK(summary.doorEvents == 0 && summary.lightsOn == false);
+
+    // Door opened twice (daylight step up, then closed), lights never held.
+    run(monitor, 900, [](uint32_t t) { return ((t >= 100 && t < 160) || (t >= 500 && t < 520)) ? 1500 : 200; });
+    monitor.takeInterval(summary);
+    CHECK(summary.doorEvents == 2);
+    CHECK(summary.lightsOn == false);
+
+    // Slow dawn: a large total rise, but no single step reaches the threshold.
+    run(monitor, 900, [](uint32_t t) { return 200 + (int32_t)t * 2; });
+    monitor.takeInterval(summary);
+    CHECK(summary.doorEvents == 0);
+
+    // Lights switched on at t=60 s and left on: lightsOn once held for 30 min, then every interval after.
+    run(monitor, 900, [](uint32_t t) { return (t >= 60) ? 2500 : 200; });
+    monitor.takeInterval(summary);
+    CHECK(summary.doorEvents == 1);
+    CHECK(summary.lightsOn == false);                   // Only 14 min on
+    run(monitor, 900, [](uint32_t) { return 2500; });
+    monitor.takeInterval(summary);
+    CHECK(summary.lightsOn == false);                   // 29 min
+    run(monitor, 900, [](uint32_t) { return 2500; });
+    monitor.takeInterval(summary);
+    CHECK(summary.lightsOn == true);                    // Held across the interval boundary
+    run(monitor, 900, [](uint32_t) { return 2500; });
+    monitor.takeInterval(summary);
+    CHECK(summary.lightsOn == true);
+    CHECK(summary.doorEvents == 0);
+
+    // A flicker below the level restarts the hold.
+    run(monitor, 900, [](uint32_t t) { return (t == 10) ? 1000 : 2500; });
+    monitor.takeInterval(summary);
+    CHECK(summary.lightsOn == true);                    // Held before the flicker
+    run(monitor, 900, [](uint32_t) { return 2500; });
+    monitor.takeInterval(summary);
+    CHECK(summary.lightsOn == false);                   // 15 + 14 min since the flicker
+
+    // Empty interval
+    monitor.takeInterval(summary);
+    CHECK(summary.samples == 0 && summary.min == 0 && summary.max == 0 && summary.stdDev == 0.0);
+
+    if (bench) {
+        LightMonitor fold(PIN_LIGHT_SEN, SAMPLE_PERIOD_MS, STEP_THRESHOLD, LIGHTS_ON_LEVEL, LIGHTS_ON_HOLD_MS);
+        double ns = bench_ns(10000000, [&](long i) { fold.addSample((int32_t)((i * 2654435761u) & 0xFFF), (uint32_t)i * 1000); });
+        printf("light monitor addSample: %.1f ns/sample\n", ns);
+    }
+
+    TEST_END();
+}
@@ -0,0 +1,125 @@
+// LocalTimeConvert::convertBatch() / formatBatch(): random times 1900-2100, a sorted run crossing DST changes and a
+// year boundary, in northern, southern, half-hour, fixed and UTC zones, give the same struct tm and the same text (ISO
+// 8601, the SMS format and one with %Z %j %a) as convert() & format() one time at a time.  Benchmarks 1M timestamps, a
+// year at 30 s, converted and formatted per call against in batches of 256.
+#include "test.h"
+#include "LocalTimeRK.cpp"
+#include <random>
+#include <vector>
+
+static const char *const zones[] = {
+    "EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00",
+    "AEST-10AEDT,M10.1.0,M4.1.0/3",
+    "GMT0BST,M3.5.0/1,M10.5.0",
+    "CET-1CEST,M3.5.0,M10.5.0/3",
+    "NZST-12NZDT,M9.5.0,M4.1.0/3",
+    "IST-5:30",
+    "UTC",
+    "<-03>3",
+    "HST10",
+};
+
+static bool sameTm(const struct tm &a, const struct tm &b) {
+    return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon && a.tm_mday == b.tm_mday && a.tm_hour == b.tm_hour &&
+           a.tm_min == b.tm_min && a.tm_sec == b.tm_sec && a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday &&
+           a.tm_isdst == b.tm_isdst;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937_64 rng(46);
+    long checked = 0;
+
+    const LocalTimeFormat iso(TIME_FORMAT_ISO8601_FULL), asctime(TIME_FORMAT_DEFAULT), zone("%Y-%m-%d %H:%M:%S %Z %j %a");
+    const size_t stride = 48;
+    for (const char *tz : zones) {
+        std::vector<time_t> times;
+        for (int i = 0; i < 100000; i++) {
+            times.push_back((time_t)(rng() % (4102444800LL + 2208988800LL)) - 2208988800LL);
+        }
+        time_t t = 1700000000;
+        for (int i = 0; i < 100000; i++) {
+            times.push_back(t);
+            t += rng() % 3600;
+        }
+        for (time_t e = 1704067200 - 200000; e < 1704067200 + 200000; e += 97) {
+            times.push_back(e);
+        }
+
+        LocalTimeConvert batch, single;
+        batch.withConfig(LocalTimePosixTimezone(tz));
+        single.withConfig(LocalTimePosixTimezone(tz));
+        std::vector<LocalTimeValue> values(times.size());
+        batch.convertBatch(times.data(), times.size(), values.data());
+        for (size_t i = 0; i < times.size() && testFailures == 0; i++) {
+            single.withTime(times[i]).convert();
+            CHECK(sameTm(single.localTimeValue, values[i]));
+            checked++;
+            if (testFailures > 0) printf("  %s at %lld\n", tz, (long long)times[i]);
+        }
+
+        for (const LocalTimeFormat *fmt : { &iso, &asctime, &zone }) {
+            std::vector<char> text(times.size() * stride);
+            batch.formatBatch(times.data(), times.size(), *fmt, text.data(), stride);
+            for (size_t i = 0; i < times.size() && testFailures == 0; i++) {
+                char expected[stride];
+                single.withTime(times[i]).convert();
+                single.format(*fmt, expected, sizeof(expected));
+                CHECK(strcmp(expected, &text[i * stride]) == 0);
+                checked++;
+                if (testFailures > 0) printf("  %s at %lld: [%s] [%s]\n", tz, (long long)times[i], expected, &text[i * stride]);
+            }
+        }
+    }
+
+    // Nothing, and a stride too small for the text: truncated & terminated in place.
+    {
+        LocalTimeConvert conv;
+        conv.withConfig(LocalTimePosixTimezone(zones[0]));
+        conv.convertBatch(nullptr, 0, nullptr);
+        time_t times[2] = { 1700000000, 1700000001 };
+        char text[2 * 8];
+        memset(text, 'x', sizeof(text));
+        conv.formatBatch(times, 2, iso, text, 8);
+        CHECK(strcmp(text, "2023-11") == 0);
+        CHECK(strcmp(text + 8, "2023-11") == 0);
+    }
+    printf("%ld conversions compared\n", checked);
+
+    if (bench == true) {
+        const size_t count = 1000000, chunk = 256;
+        std::vector<time_t> times(count);
+        for (size_t i = 0; i < count; i++) {
+            times[i] = 1735689600 + (time_t)i * 30;
+        }
+        LocalTimeConvert conv;
+        conv.withConfig(LocalTimePosixTimezone(zones[0]));
+        std::vector<LocalTimeValue> values(chunk);
+        std::vector<char> text(chunk * 26);
+        long sum = 0;
+
+        double convertNs = bench_ns(count, [&](long i) {
+            conv.withTime(times[i]).convert();
+            values[i % chunk] = conv.localTimeValue;
+            sum += values[i % chunk].tm_min;
+        });
+        double convertBatchNs = bench_ns(count / chunk, [&](long i) {
+            conv.convertBatch(&times[i * chunk], chunk, values.data());
+            sum += values[7].tm_min;
+        }) / chunk;
+        double formatNs = bench_ns(count, [&](long i) {
+            conv.withTime(times[i]).convert();
+            sum += conv.format(iso, &text[(i % chunk) * 26], 26);
+        });
+        double formatBatchNs = bench_ns(count / chunk, [&](long i) {
+            conv.formatBatch(&times[i * chunk], chunk, iso, text.data(), 26);
+            sum += text[3];
+        }) / chunk;
+        keep(sum);
+        printf("bench 1M timestamps, %zu per batch: convert() %.1f ms, convertBatch() %.1f ms; convert() + format() %.1f ms, "
+               "formatBatch() %.1f ms\n", chunk, convertNs * count / 1e6, convertBatchNs * count / 1e6,
+               formatNs * count / 1e6, formatBatchNs * count / 1e6);
+    }
+
+    TEST_END();
+}
@@ -0,0 +1,136 @@
+// Closed-form civil dates in LocalTime: timeToTm() / tmToTime() match glibc gmtime_r() / timegm() for every day
+// 1969-2100 (start, end & random second), out-of-range fields normalize the same way, lastDayOfMonth() agrees, and
+// LocalTimeChange::calculate() finds the same day as walking the month with gmtime_r() for every M.w.d rule in every
+// year.  Benchmarks each against the C library.
+#include "test.h"
+#include "LocalTimeRK.cpp"
+#include <random>
+
+static_assert(LocalTime::daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(LocalTime::daysFromCivil(2000, 3, 1) == 11017, "after a century leap day");
+static_assert(LocalTime::dayOfWeekFromDays(0) == 4, "1970-01-01 was a Thursday");
+static_assert(LocalTime::dayOfWeekFromDays(-1) == 3, "and 1969-12-31 a Wednesday");
+
+static bool sameTm(const struct tm &a, const struct tm &b) {
+    return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon && a.tm_mday == b.tm_mday && a.tm_hour == b.tm_hour &&
+           a.tm_min == b.tm_min && a.tm_sec == b.tm_sec && a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday;
+}
+
+// Rule M<month>.<week>.<dayOfWeek>/hms in year, the long way: the matching weekdays of the month by gmtime_r().
+static time_t referenceChange(int year, int month, int week, int dayOfWeek, int hmsSeconds, int tzSeconds) {
+    int mdays[5], found = 0;
+    for (int mday = 1; mday <= 31; mday++) {
+        struct tm tm = {};
+        tm.tm_year = year - 1900;
+        tm.tm_mon = month - 1;
+        tm.tm_mday = mday;
+        time_t t = timegm(&tm);
+        gmtime_r(&t, &tm);
+        if (tm.tm_mon != month - 1) break;
+        if (tm.tm_wday == dayOfWeek) mdays[found++] = mday;
+    }
+    struct tm tm = {};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = mdays[(week >= found) ? found - 1 : week - 1];     // Week 5 is the last one
+    return timegm(&tm) + hmsSeconds + tzSeconds;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(42);
+    long checked = 0;
+
+    // Every day, 1969 to 2100.
+    time_t end = (time_t)LocalTime::daysFromCivil(2101, 1, 1) * 86400;
+    for (time_t day = -86400LL * 365; day < end && testFailures == 0; day += 86400) {
+        for (time_t t : { day, day + 86399, day + (time_t)(rng() % 86400) }) {
+            struct tm ref, got;
+            gmtime_r(&t, &ref);
+            LocalTime::timeToTm(t, &got);
+            CHECK(sameTm(ref, got));
+            struct tm back = ref;
+            CHECK(LocalTime::tmToTime(&back) == t);
+            CHECK(sameTm(back, ref));
+            checked++;
+            if (testFailures > 0) printf("  at %lld\n", (long long)t);
+        }
+    }
+
+    // Out of range fields, as LocalTimeChange and nextDay() produce them.
+    for (int i = 0; i < 2000000 && testFailures == 0; i++) {
+        struct tm a = {};
+        a.tm_year = 70 + rng() % 131;
+        a.tm_mon = (int)(rng() % 40) - 14;
+        a.tm_mday = (int)(rng() % 80) - 20;
+        a.tm_hour = (int)(rng() % 60) - 12;
+        a.tm_min = (int)(rng() % 200) - 50;
+        a.tm_sec = (int)(rng() % 200) - 50;
+        struct tm b = a;
+        CHECK(timegm(&a) == LocalTime::tmToTime(&b));
+        CHECK(sameTm(a, b));
+        checked++;
+    }
+
+    for (int year = 1970; year <= 2100; year++) {
+        for (int month = 1; month <= 12; month++) {
+            struct tm a = {};
+            a.tm_year = year - 1900;
+            a.tm_mon = month;
+            a.tm_mday = 0;
+            timegm(&a);
+            CHECK(LocalTime::lastDayOfMonth(year, month) == a.tm_mday);
+        }
+    }
+
+    // Every rule in every year, at 2:00 local in UTC-5.
+    for (int year = 1970; year <= 2100 && testFailures == 0; year++) {
+        for (int month = 1; month <= 12; month++) {
+            for (int week = 1; week <= 5; week++) {
+                for (int dayOfWeek = 0; dayOfWeek <= 6; dayOfWeek++) {
+                    char rule[24];
+                    snprintf(rule, sizeof(rule), "M%d.%d.%d/2:00:00", month, week, dayOfWeek);
+                    LocalTimeChange change(rule);
+                    struct tm tm = {};
+                    tm.tm_year = year - 1900;
+                    CHECK(change.calculate(&tm, LocalTimeHMS("5")) == referenceChange(year, month, week, dayOfWeek, 2 * 3600, 5 * 3600));
+                    checked++;
+                    if (testFailures > 0) printf("  %s in %d\n", rule, year);
+                }
+            }
+        }
+    }
+    printf("%ld conversions compared\n", checked);
+
+    if (bench == true) {
+        struct tm tm;
+        long sum = 0;
+        double gmtimeNs = bench_ns(5000000, [&](long i) { time_t t = 1600000000 + (time_t)i * 613; gmtime_r(&t, &tm); sum += tm.tm_mday; });
+        double timeToTmNs = bench_ns(5000000, [&](long i) { LocalTime::timeToTm(1600000000 + (time_t)i * 613, &tm); sum += tm.tm_mday; });
+        double timegmNs = bench_ns(5000000, [&](long i) {
+            struct tm a = {};
+            a.tm_year = 100 + i % 100;
+            a.tm_mon = i % 12;
+            a.tm_mday = 1 + i % 28;
+            sum += timegm(&a);
+        });
+        double tmToTimeNs = bench_ns(5000000, [&](long i) {
+            struct tm a = {};
+            a.tm_year = 100 + i % 100;
+            a.tm_mon = i % 12;
+            a.tm_mday = 1 + i % 28;
+            sum += LocalTime::tmToTime(&a);
+        });
+        LocalTimeChange change("M3.2.0/2:00:00");
+        double calculateNs = bench_ns(1000000, [&](long i) {
+            struct tm a = {};
+            a.tm_year = 100 + i % 100;
+            sum += change.calculate(&a, LocalTimeHMS("5"));
+        });
+        keep(sum);
+        printf("bench gmtime_r %.1f ns, timeToTm %.1f ns; timegm %.1f ns, tmToTime %.1f ns; LocalTimeChange::calculate %.1f ns\n",
+               gmtimeNs, timeToTmNs, timegmNs, tmToTimeNs, calculateNs);
+    }
+
+    TEST_END();
+}
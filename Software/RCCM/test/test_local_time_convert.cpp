@@ -0,0 +1,90 @@
+// LocalTimeConvert::convert() with the per-year transition cache: every 15 minutes plus random times over 1971-2099 in
+// northern, southern, half-hour and no-DST zones give the same local time & DST flag as glibc's localtime_r() with
+// TZ set to the same POSIX string, and the same result as with the cache discarded before every conversion.
+// Benchmarks a year of 15-minute timestamps, cached against recomputing the transitions each time.
+#include "test.h"
+#include "LocalTimeRK.cpp"
+#include <random>
+
+// Transition times are explicit: LocalTimeRK takes a rule without one as midnight where POSIX (& glibc) says 02:00.
+static const char *const zones[] = {
+    "EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00",
+    "AEST-10AEDT,M10.1.0/2,M4.1.0/3",
+    "GMT0BST,M3.5.0/1,M10.5.0/2",
+    "NZST-12NZDT,M9.5.0/2,M4.1.0/3",
+    "NST3:30NDT,M3.2.0/2,M11.1.0/2",
+    "MST7",
+    "<+0530>-5:30",
+};
+
+static bool sameTm(const struct tm &a, const struct tm &b) {
+    return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon && a.tm_mday == b.tm_mday && a.tm_hour == b.tm_hour &&
+           a.tm_min == b.tm_min && a.tm_sec == b.tm_sec && a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937_64 rng(41);
+    long checked = 0;
+
+    for (const char *zone : zones) {
+        setenv("TZ", zone, 1);
+        tzset();
+        LocalTimeConvert conv, uncached;
+        conv.withConfig(LocalTimePosixTimezone(zone));
+        uncached.withConfig(LocalTimePosixTimezone(zone));
+        CHECK(conv.config.isValid() == true);
+
+        auto check = [&](time_t t) {
+            struct tm ref;
+            localtime_r(&t, &ref);
+            conv.withTime(t).convert();
+            uncached.config.invalidateTransitions();
+            uncached.withTime(t).convert();
+            CHECK(sameTm(conv.localTimeValue, ref));
+            CHECK(conv.isDST() == (ref.tm_isdst > 0));
+            CHECK(conv.position == uncached.position);
+            CHECK(conv.dstStart == uncached.dstStart && conv.standardStart == uncached.standardStart);
+            CHECK(sameTm(conv.localTimeValue, uncached.localTimeValue));
+            checked++;
+            if (testFailures > 0) {
+                printf("  %s at %lld: got %s isDST %d, localtime_r %02d:%02d isdst %d\n", zone, (long long)t,
+                       conv.format(TIME_FORMAT_ISO8601_FULL).c_str(), conv.isDST(), ref.tm_hour, ref.tm_min, ref.tm_isdst);
+            }
+        };
+
+        // 2019-2027 every 15 minutes (and a second either side of each quarter hour), in order.
+        for (time_t t = 1546300800; t < 1830297600 && testFailures == 0; t += 900) {
+            check(t - 1);
+            check(t);
+            check(t + 1);
+        }
+        // Random times 1971-2099, so the cached year changes on nearly every call.
+        for (int i = 0; i < 200000 && testFailures == 0; i++) {
+            check((time_t)(31536000 + rng() % (4102444800LL - 31536000)));
+        }
+    }
+    unsetenv("TZ");
+    printf("%ld conversions compared\n", checked);
+
+    if (bench == true) {
+        LocalTimeConvert conv;
+        conv.withConfig(LocalTimePosixTimezone(zones[0]));
+        long sum = 0;
+        const long steps = 365 * 96;
+        double uncachedNs = bench_ns(steps, [&](long i) {
+            conv.config.invalidateTransitions();
+            conv.withTime(1767225600 + i * 900).convert();
+            sum += conv.localTimeValue.tm_hour;
+        });
+        double cachedNs = bench_ns(steps, [&](long i) {
+            conv.withTime(1767225600 + i * 900).convert();
+            sum += conv.localTimeValue.tm_hour;
+        });
+        keep(sum);
+        printf("bench a year at 15 minutes (%ld converts): transitions recomputed %.2f ms (%.0f ns each), "
+               "cached %.2f ms (%.0f ns each)\n", steps, uncachedNs * steps / 1e6, uncachedNs, cachedNs * steps / 1e6, cachedNs);
+    }
+
+    TEST_END();
+}
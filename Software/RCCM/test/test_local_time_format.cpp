@@ -0,0 +1,114 @@
+// LocalTimeFormat: precompiled specs give the same text as strftime() for random times 1970-2100 (the SMS / Time.timeStr()
+// format, ISO-8601 and assorted conversions), %z / %Z / ISO-8601 offsets match glibc with TZ set, output truncates
+// cleanly, and unsupported or oversize specs fail to compile.  Benchmarks the String format() path, the precompiled
+// format into a buffer and bare strftime().
+#include "test.h"
+#include "LocalTimeRK.cpp"
+#include <random>
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(43);
+    long checked = 0;
+
+    const char *specs[] = { "%a %b %e %H:%M:%S %Y", "%Y-%m-%dT%H:%M:%S", "%F %T", "%A, %B %d %Y %I:%M %p", "%j %y %%",
+                            "day %d of %m", "%H%M%S" };
+    const LocalTimeFormat asctime(TIME_FORMAT_DEFAULT);
+    CHECK(asctime.isValid() == true);
+    for (int i = 0; i < 300000 && testFailures == 0; i++) {
+        time_t t = (time_t)(rng() % 4102444800u);
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        for (const char *spec : specs) {
+            char ref[64], got[64];
+            strftime(ref, sizeof(ref), spec, &tm);
+            LocalTimeFormat fmt(spec);
+            CHECK(fmt.isValid() == true);
+            CHECK(fmt.format(tm, 0, true, "Z", got, sizeof(got)) == strlen(ref));
+            CHECK(strcmp(ref, got) == 0);
+            checked++;
+            if (testFailures > 0) printf("  %s: [%s] [%s]\n", spec, ref, got);
+        }
+
+        // Time.timeStr() is asctime() without the newline.
+        char ref[32], got[32];
+        asctime_r(&tm, ref);
+        ref[strlen(ref) - 1] = 0;
+        asctime.format(tm, 0, true, "Z", got, sizeof(got));
+        CHECK(strcmp(ref, got) == 0);
+        checked++;
+    }
+
+    // Offsets and zone names, against glibc in the same zone.  LocalTimeRK's %z has always been +hh:mm where glibc's is
+    // +hhmm, and UTC is Z for both %Z and %z; ISO-8601 takes the same offset.
+    const LocalTimeFormat iso(TIME_FORMAT_ISO8601_FULL), zone("%Z %z");
+    for (const char *tz : { "EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00", "IST-5:30", "NST3:30NDT,M3.2.0/2,M11.1.0/2", "UTC0",
+                            "AEST-10AEDT,M10.1.0/2,M4.1.0/3" }) {
+        setenv("TZ", tz, 1);
+        tzset();
+        LocalTimeConvert conv;
+        conv.withConfig(LocalTimePosixTimezone(tz));
+        for (time_t t = 1600000000; t < 1700000000 && testFailures == 0; t += 86400 * 7 + 3601) {
+            conv.withTime(t).convert();
+            struct tm local;
+            localtime_r(&t, &local);
+
+            char offset[16], ref[64], got[64];
+            strftime(offset, sizeof(offset), "%z", &local);
+            if (conv.config.isZ()) {
+                strcpy(ref, "Z Z");
+            }
+            else
+            {
+                snprintf(ref, sizeof(ref), "%s %.3s:%.2s", local.tm_zone, offset, offset + 3);
+            }
+            zone.format(conv.localTimeValue, conv.utcOffset(), conv.config.isZ(), conv.zoneName().c_str(), got, sizeof(got));
+            CHECK(strcmp(ref, got) == 0);
+
+            strftime(ref, sizeof(ref), "%Y-%m-%dT%H:%M:%S", &local);
+            if (conv.config.isZ()) {
+                strcat(ref, "Z");
+            }
+            else
+            {
+                snprintf(ref + strlen(ref), 16, "%.3s:%.2s", offset, offset + 3);
+            }
+            conv.format(iso, got, sizeof(got));
+            CHECK(strcmp(ref, got) == 0);
+            checked += 2;
+            if (testFailures > 0) printf("  %s at %lld: [%s] [%s]\n", tz, (long long)t, ref, got);
+        }
+    }
+    unsetenv("TZ");
+
+    // Truncation: null terminated, and the count is what was written.
+    {
+        char small[8];
+        struct tm tm = {};
+        tm.tm_year = 121;
+        tm.tm_mday = 1;
+        tm.tm_hour = 5;
+        CHECK(LocalTimeFormat("%Y-%m-%dT%H").format(tm, 0, true, "", small, sizeof(small)) == 7);
+        CHECK(strcmp(small, "2021-01") == 0);
+    }
+    CHECK(LocalTimeFormat("%c").isValid() == false);
+    CHECK(LocalTimeFormat("abc%").isValid() == false);
+    CHECK(LocalTimeFormat("%T%T%T%T%T%T%T%T%T").isValid() == false);
+    printf("%ld formats compared\n", checked);
+
+    if (bench == true) {
+        LocalTimeConvert conv;
+        conv.withConfig(LocalTimePosixTimezone("EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00")).withTime(1650000000).convert();
+        char buf[64];
+        size_t sum = 0;
+        double stringNs = bench_ns(500000, [&](long) { String s = conv.format(TIME_FORMAT_ISO8601_FULL); sum += s.length(); });
+        double compiledNs = bench_ns(500000, [&](long) { sum += conv.format(iso, buf, sizeof(buf)); });
+        double strftimeNs = bench_ns(500000, [&](long) { sum += strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &conv.localTimeValue); });
+        double asctimeNs = bench_ns(500000, [&](long) { sum += conv.format(asctime, buf, sizeof(buf)); });
+        keep(sum);
+        printf("bench ISO-8601: format() String %.0f ns, precompiled into a buffer %.0f ns, bare strftime %.0f ns; "
+               "SMS format precompiled %.0f ns\n", stringNs, compiledNs, strftimeNs, asctimeNs);
+    }
+
+    TEST_END();
+}
@@ -0,0 +1,151 @@
+// LocalTimePosixTimezone parsing in place: a corpus of real POSIX TZ strings (US, Europe, Australia, half-hour and
+// quoted numeric names, explicit DST offsets, negative transition times) and malformed ones parses to the expected
+// names, offsets & rules; the valid ones with explicit transition times convert like glibc with TZ set; embedded
+// zones are checked at compile time and the config stays trivially copyable.  Benchmarks parse() and withConfig().
+#include "test.h"
+#include "LocalTimeRK.cpp"
+
+static constexpr LocalTimePosixTimezone tzEastern("EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00");
+static_assert(tzEastern.isValid() && tzEastern.hasDST() && tzEastern.standardHMS.hour == 5, "Eastern offset");
+static_assert(tzEastern.dstStart.month == 3 && tzEastern.dstStart.week == 2 && tzEastern.standardStart.week == 1, "Eastern rules");
+static_assert(LocalTimePosixTimezone("<+0530>-5:30").standardName[0] == '+', "quoted name");
+static_assert(LocalTimePosixTimezone("<+0530>-5:30").standardHMS.minute == 30, "half-hour offset");
+static_assert(!LocalTimePosixTimezone("EST5EDT,M3.2.0").isValid(), "DST without an end rule");
+static_assert(std::is_trivially_copyable<LocalTimeConvert>::value, "converters copy with memcpy");
+
+// Each string and what it parses to, as "v=<valid> dst=<hasDST> std[<name>] <hms> dst[<name>] <hms> <start> <end>".
+static const struct {
+    const char *tz;
+    const char *expected;
+} corpus[] = {
+    { "EST5EDT,M3.2.0/2:00:00,M11.1.0/2:00:00", "v=1 dst=1 std[EST] 5:00:00 dst[EDT] 4:00:00 M3.2.0/2:00:00 M11.1.0/2:00:00" },
+    { "EST5EDT,M3.2.0,M11.1.0", "v=1 dst=1 std[EST] 5:00:00 dst[EDT] 4:00:00 M3.2.0/0:00:00 M11.1.0/0:00:00" },
+    { "CST6CDT,M3.2.0,M11.1.0", "v=1 dst=1 std[CST] 6:00:00 dst[CDT] 5:00:00 M3.2.0/0:00:00 M11.1.0/0:00:00" },
+    { "MST7MDT,M3.2.0,M11.1.0", "v=1 dst=1 std[MST] 7:00:00 dst[MDT] 6:00:00 M3.2.0/0:00:00 M11.1.0/0:00:00" },
+    { "MST7", "v=1 dst=0 std[MST] 7:00:00 dst[] 0:00:00" },
+    { "PST8PDT,M3.2.0,M11.1.0", "v=1 dst=1 std[PST] 8:00:00 dst[PDT] 7:00:00 M3.2.0/0:00:00 M11.1.0/0:00:00" },
+    { "AKST9AKDT,M3.2.0,M11.1.0", "v=1 dst=1 std[AKST] 9:00:00 dst[AKDT] 8:00:00 M3.2.0/0:00:00 M11.1.0/0:00:00" },
+    { "HST10", "v=1 dst=0 std[HST] 10:00:00 dst[] 0:00:00" },
+    { "AST4", "v=1 dst=0 std[AST] 4:00:00 dst[] 0:00:00" },
+    { "NST3:30NDT,M3.2.0,M11.1.0", "v=1 dst=1 std[NST] 3:30:00 dst[NDT] 2:30:00 M3.2.0/0:00:00 M11.1.0/0:00:00" },
+    { "GMT0BST,M3.5.0/1,M10.5.0", "v=1 dst=1 std[GMT] 0:00:00 dst[BST] -1:00:00 M3.5.0/1:00:00 M10.5.0/0:00:00" },
+    { "GMT0IST,M3.5.0/1,M10.5.0", "v=1 dst=1 std[GMT] 0:00:00 dst[IST] -1:00:00 M3.5.0/1:00:00 M10.5.0/0:00:00" },
+    { "WET0WEST,M3.5.0/1,M10.5.0/2", "v=1 dst=1 std[WET] 0:00:00 dst[WEST] -1:00:00 M3.5.0/1:00:00 M10.5.0/2:00:00" },
+    { "CET-1CEST,M3.5.0,M10.5.0/3", "v=1 dst=1 std[CET] -1:00:00 dst[CEST] -2:00:00 M3.5.0/0:00:00 M10.5.0/3:00:00" },
+    { "EET-2EEST,M3.5.0/3,M10.5.0/4", "v=1 dst=1 std[EET] -2:00:00 dst[EEST] -3:00:00 M3.5.0/3:00:00 M10.5.0/4:00:00" },
+    { "MSK-3", "v=1 dst=0 std[MSK] -3:00:00 dst[] 0:00:00" },
+    { "IST-5:30", "v=1 dst=0 std[IST] -5:30:00 dst[] 0:00:00" },
+    { "PKT-5", "v=1 dst=0 std[PKT] -5:00:00 dst[] 0:00:00" },
+    { "NPT-5:45", "v=1 dst=0 std[NPT] -5:45:00 dst[] 0:00:00" },
+    { "CST-8", "v=1 dst=0 std[CST] -8:00:00 dst[] 0:00:00" },
+    { "JST-9", "v=1 dst=0 std[JST] -9:00:00 dst[] 0:00:00" },
+    { "KST-9", "v=1 dst=0 std[KST] -9:00:00 dst[] 0:00:00" },
+    { "ACST-9:30ACDT,M10.1.0,M4.1.0/3", "v=1 dst=1 std[ACST] -9:30:00 dst[ACDT] -10:30:00 M10.1.0/0:00:00 M4.1.0/3:00:00" },
+    { "AEST-10AEDT,M10.1.0,M4.1.0/3", "v=1 dst=1 std[AEST] -10:00:00 dst[AEDT] -11:00:00 M10.1.0/0:00:00 M4.1.0/3:00:00" },
+    { "AEST-10", "v=1 dst=0 std[AEST] -10:00:00 dst[] 0:00:00" },
+    { "AWST-8", "v=1 dst=0 std[AWST] -8:00:00 dst[] 0:00:00" },
+    { "NZST-12NZDT,M9.5.0,M4.1.0/3", "v=1 dst=1 std[NZST] -12:00:00 dst[NZDT] -13:00:00 M9.5.0/0:00:00 M4.1.0/3:00:00" },
+    { "ChST-10", "v=1 dst=0 std[ChST] -10:00:00 dst[] 0:00:00" },
+    { "SAST-2", "v=1 dst=0 std[SAST] -2:00:00 dst[] 0:00:00" },
+    { "WAT-1", "v=1 dst=0 std[WAT] -1:00:00 dst[] 0:00:00" },
+    { "CAT-2", "v=1 dst=0 std[CAT] -2:00:00 dst[] 0:00:00" },
+    { "EAT-3", "v=1 dst=0 std[EAT] -3:00:00 dst[] 0:00:00" },
+    { "HKT-8", "v=1 dst=0 std[HKT] -8:00:00 dst[] 0:00:00" },
+    { "PHT-8", "v=1 dst=0 std[PHT] -8:00:00 dst[] 0:00:00" },
+    { "WIB-7", "v=1 dst=0 std[WIB] -7:00:00 dst[] 0:00:00" },
+    { "UTC0", "v=1 dst=0 std[UTC] 0:00:00 dst[] 0:00:00" },
+    { "UTC", "v=1 dst=0 std[UTC] 0:00:00 dst[] 0:00:00" },
+    { "GMT0", "v=1 dst=0 std[GMT] 0:00:00 dst[] 0:00:00" },
+    { "CST5CDT,M3.2.0/0,M11.1.0/1", "v=1 dst=1 std[CST] 5:00:00 dst[CDT] 4:00:00 M3.2.0/0:00:00 M11.1.0/1:00:00" },
+    { "<-03>3", "v=1 dst=0 std[-03] 3:00:00 dst[] 0:00:00" },
+    { "<+0530>-5:30", "v=1 dst=0 std[+0530] -5:30:00 dst[] 0:00:00" },
+    { "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1", "v=1 dst=1 std[-03] 3:00:00 dst[-02] 2:00:00 M3.5.0/-2:00:00 M10.5.0/-1:00:00" },
+    { "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0", "v=1 dst=1 std[+1030] -10:30:00 dst[+11] -11:00:00 M10.1.0/0:00:00 M4.1.0/0:00:00" },
+    { "<+13>-13", "v=1 dst=0 std[+13] -13:00:00 dst[] 0:00:00" },
+    { "<-0330>3:30", "v=1 dst=0 std[-0330] 3:30:00 dst[] 0:00:00" },
+    { "IST-1GMT0,M10.5.0,M3.5.0/1", "v=1 dst=1 std[IST] -1:00:00 dst[GMT] 0:00:00 M10.5.0/0:00:00 M3.5.0/1:00:00" },
+    { "AEST-10AEDT-11,M10.1.0/2,M4.1.0/3", "v=1 dst=1 std[AEST] -10:00:00 dst[AEDT] -11:00:00 M10.1.0/2:00:00 M4.1.0/3:00:00" },
+    { "EST5EDT4,M3.2.0/02:00:00,M11.1.0/02:00:00", "v=1 dst=1 std[EST] 5:00:00 dst[EDT] 4:00:00 M3.2.0/2:00:00 M11.1.0/2:00:00" },
+    { "MST7MDT,M3.2.0/2:00:00,M11.1.0/2:00:00", "v=1 dst=1 std[MST] 7:00:00 dst[MDT] 6:00:00 M3.2.0/2:00:00 M11.1.0/2:00:00" },
+    { "", "v=0 dst=0 std[] 0:00:00 dst[] 0:00:00" },
+    { "EST5EDT,M3.2.0", "v=0 dst=0 std[EST] 5:00:00 dst[EDT] 4:00:00" },
+    { "EST5EDT,,M3.2.0,M11.1.0", "v=1 dst=1 std[EST] 5:00:00 dst[EDT] 4:00:00 M3.2.0/0:00:00 M11.1.0/0:00:00" },
+    { "XYZ", "v=1 dst=0 std[XYZ] 0:00:00 dst[] 0:00:00" },
+    { "VERYLONGNAME5", "v=0 dst=0 std[] 0:00:00 dst[] 0:00:00" },
+    { "<+0530-5:30", "v=0 dst=0 std[] 0:00:00 dst[] 0:00:00" },
+    { "EST5EDT,J60,M11.1.0", "v=1 dst=0 std[EST] 5:00:00 dst[EDT] 4:00:00  M11.1.0/0:00:00" },
+    { "EST 5EDT,M3.2.0, M11.1.0", "v=0 dst=0 std[EST] 5:00:00 dst[EDT] 4:00:00" },
+};
+
+static std::string summary(const LocalTimePosixTimezone &tz) {
+    char buf[160];
+    snprintf(buf, sizeof(buf), "v=%d dst=%d std[%s] %s dst[%s] %s %s %s", tz.isValid(), tz.hasDST(), tz.standardName,
+             tz.standardHMS.toString().c_str(), tz.dstName, tz.dstHMS.toString().c_str(), tz.dstStart.toString().c_str(),
+             tz.standardStart.toString().c_str());
+    std::string s(buf);
+    return s.substr(0, s.find_last_not_of(' ') + 1);
+}
+
+// Both rules give a time of day; LocalTimeRK takes a rule without one as midnight where POSIX says 02:00.
+static bool explicitTimes(const char *tz) {
+    const char *start = strchr(tz, ',');
+    const char *end = strrchr(tz, ',');
+    return (start != nullptr) && (start != end) && (memchr(start, '/', end - start) != nullptr) && (strchr(end, '/') != nullptr);
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    long checked = 0;
+
+    for (auto &entry : corpus) {
+        LocalTimePosixTimezone tz(entry.tz);
+        CHECK(summary(tz) == entry.expected);
+
+        // Re-parsing into a used object gives the same result.
+        LocalTimePosixTimezone copy = tz;
+        copy.parse(entry.tz);
+        CHECK(summary(copy) == entry.expected);
+        if (testFailures > 0) {
+            printf("  %s: %s\n", entry.tz, summary(tz).c_str());
+            break;
+        }
+
+        // Hourly through 2020-2029 against glibc.  (Not the J rule, which glibc has and LocalTimeRK ignores.)
+        bool comparable = tz.hasDST() ? explicitTimes(entry.tz) : (strchr(entry.tz, ',') == nullptr);
+        if (tz.isValid() == false || comparable == false) {
+            continue;
+        }
+        setenv("TZ", entry.tz, 1);
+        tzset();
+        LocalTimeConvert conv;
+        conv.withConfig(tz);
+        for (time_t t = 1577836800; t < 1893456000 && testFailures == 0; t += 3600) {
+            struct tm ref;
+            localtime_r(&t, &ref);
+            conv.withTime(t).convert();
+            CHECK(conv.localTimeValue.tm_hour == ref.tm_hour && conv.localTimeValue.tm_min == ref.tm_min &&
+                  conv.localTimeValue.tm_mday == ref.tm_mday && conv.isDST() == (ref.tm_isdst > 0));
+            checked++;
+            if (testFailures > 0) printf("  %s at %lld\n", entry.tz, (long long)t);
+        }
+    }
+    unsetenv("TZ");
+    printf("%zu zones, %ld conversions compared\n", sizeof(corpus) / sizeof(corpus[0]), checked);
+
+    if (bench == true) {
+        long sum = 0;
+        const size_t count = sizeof(corpus) / sizeof(corpus[0]);
+        LocalTimePosixTimezone tz;
+        double parseNs = bench_ns(1000000, [&](long i) { tz.parse(corpus[i % count].tz); sum += tz.isValid(); keep(tz); });
+        LocalTimeConvert conv;
+        double withConfigNs = bench_ns(1000000, [&](long i) {
+            tz.standardHMS.second = (int8_t)(i & 1);
+            conv.withConfig(tz);
+            keep(conv);
+        });
+        keep(sum);
+        printf("bench parse %.0f ns, withConfig %.1f ns (%zu B config)\n", parseNs, withConfigNs, sizeof(LocalTimePosixTimezone));
+    }
+
+    TEST_END();
+}
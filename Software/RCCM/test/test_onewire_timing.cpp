@@ -0,0 +1,118 @@
+// OneWire slot timing on the simulated bus: scratchpad reads per bit and as blocks, at every standard speed margin
+// and at overdrive, come back intact with no slot, recovery or reset timing outside the DS18B20 limits; search still
+// finds every part; overdrive reaches only the parts that support it and a standard reset returns them.  Benchmarks
+// bus time (simulated us) and interrupt-off windows per scratchpad read for each mode.
+#include "test.h"
+#include "onewire_model.h"
+#include "OneWire.cpp"
+
+using onewire_model::Device;
+
+// Reset, Match ROM, Read Scratchpad, 9 bytes.
+static void readScratchpad(OneWire &bus, const uint8_t *rom, uint8_t *scratchpad, bool block) {
+    bus.reset();
+    if (block == true) {
+        uint8_t command[10] = { 0x55 };
+        memcpy(&command[1], rom, 8);
+        command[9] = 0xBE;
+        bus.write_block(command, 10);
+        bus.read_block(scratchpad, 9);
+        return;
+    }
+    bus.select(rom);
+    bus.write(0xBE);
+    bus.read_bytes(scratchpad, 9);
+}
+
+// Reads from d; returns bus us per read.
+static double readMany(const char *label, OneWire &bus, const Device &d, bool block, int reads, bool print) {
+    uint8_t scratchpad[9];
+    onewire_model::resetStats();
+    uint64_t start = host::nowUs;
+    int good = 0;
+    for (int i = 0; i < reads; i++) {
+        readScratchpad(bus, d.rom, scratchpad, block);
+        good += (memcmp(scratchpad, d.scratch, 9) == 0) ? 1 : 0;
+    }
+    double us = (double)(host::nowUs - start) / reads;
+    CHECK(good == reads);
+    CHECK(onewire_model::totalViolations() == 0);
+    if (print == true || testFailures > 0) {
+        printf("%-26s %7.1f us per read, %5.1f interrupt-off windows, longest %3llu us\n", label, us,
+               (double)host::irqOffCount / reads, (unsigned long long)host::irqOffMaxUs);
+    }
+    return us;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+
+    onewire_model::attach();
+    onewire_model::devices.push_back(Device::ds18b20(1, 21.5));
+    onewire_model::devices.push_back(Device::ds18b20(2, -3.0));
+    for (auto &d : onewire_model::devices) {
+        d.convert();
+    }
+    OneWire bus(3);
+
+    double perBitUs = readMany("standard, per bit", bus, onewire_model::devices[0], false, 100, bench);
+    double blockUs[ONEWIRE_MARGIN_MAX_US + 1];
+    for (int margin = 0; margin <= ONEWIRE_MARGIN_MAX_US; margin++) {
+        char label[32];
+        snprintf(label, sizeof(label), "standard, block, margin %d", margin);
+        bus.set_margin(margin);
+        blockUs[margin] = readMany(label, bus, onewire_model::devices[0], true, 100, bench);
+    }
+    CHECK(blockUs[0] < blockUs[ONEWIRE_MARGIN_MAX_US]);
+    bus.set_margin(ONEWIRE_MARGIN_MAX_US + 3);      // Clamped
+    CHECK(readMany("standard, block, margin 9", bus, onewire_model::devices[0], true, 20, false) == blockUs[ONEWIRE_MARGIN_MAX_US]);
+    bus.set_margin(ONEWIRE_MARGIN_US);
+
+    // Search at these timings.
+    uint8_t rom[8];
+    int found = 0;
+    bus.reset_search();
+    while (bus.search(rom)) {
+        found++;
+    }
+    CHECK(found == 2);
+    CHECK(onewire_model::totalViolations() == 0);
+
+    // Overdrive: DS18B20s do not support it, so model one part that does.
+    onewire_model::devices[0].supportsOverdrive = false;
+    onewire_model::devices[1].supportsOverdrive = true;
+    CHECK(bus.reset() == 1);
+    bus.overdrive_skip();
+    CHECK(bus.get_overdrive() == true);
+    CHECK(onewire_model::devices[1].overdrive == true && onewire_model::devices[0].overdrive == false);
+    // The standard speed part has to be out of the conversation.
+    onewire_model::devices[0].connected = false;
+    double overdriveBlockUs = readMany("overdrive, block", bus, onewire_model::devices[1], true, 100, bench);
+    double overdrivePerBitUs = readMany("overdrive, per bit", bus, onewire_model::devices[1], false, 100, bench);
+    CHECK(overdriveBlockUs < blockUs[ONEWIRE_MARGIN_US] / 4);
+
+    // A standard reset returns everyone to standard speed.
+    bus.set_overdrive(false);
+    onewire_model::devices[0].connected = true;
+    CHECK(bus.reset() == 1);
+    CHECK(onewire_model::devices[1].overdrive == false);
+    readMany("standard after overdrive", bus, onewire_model::devices[0], true, 10, false);
+
+    // Overdrive Match ROM addresses one part.
+    CHECK(bus.reset() == 1);
+    bus.overdrive_select(onewire_model::devices[1].rom);
+    bus.write(0xBE);
+    uint8_t scratchpad[9];
+    bus.read_block(scratchpad, 9);
+    CHECK(memcmp(scratchpad, onewire_model::devices[1].scratch, 9) == 0);
+    bus.set_overdrive(false);
+    bus.reset();
+
+    if (bench == true) {
+        printf("bench bus time per scratchpad read: per bit %.0f us, block %.0f us (margin %d), overdrive block %.0f us, "
+               "overdrive per bit %.0f us\n", perBitUs, blockUs[ONEWIRE_MARGIN_US], ONEWIRE_MARGIN_US, overdriveBlockUs,
+               overdrivePerBitUs);
+    }
+
+    TEST_END();
+}
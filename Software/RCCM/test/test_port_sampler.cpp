@@ -0,0 +1,157 @@
+// PortSampler: background block capture on the virtual clock (one sample per process() call, on the sample
+// grid, never waiting), block reduction against a scalar reference, leak run length, kernel benchmark.
+#include "test.h"
+#include "PortSampler.cpp"
+#include <random>
+
+#define PIN_ADC_1           18
+#define PIN_ADC_2           17
+
+// Reference reduction, written the obvious way.
+static void reference(const std::vector<uint16_t> &v, uint16_t threshold, struct PortSampler::blockFeatures &f) {
+    double sum = 0, sumSq = 0;
+    uint32_t run = 0;
+    f = {};
+    f.min = UINT16_MAX;
+    for (size_t i = 0; i < v.size(); i++) {
+        sum += v[i];
+        f.min = std::min(f.min, v[i]);
+        f.max = std::max(f.max, v[i]);
+        if (v[i] >= threshold) { f.overThreshold++; run++; f.overRun = std::max(f.overRun, run); } else { run = 0; }
+        if (i > 0 && ((v[i] >= threshold) != (v[i - 1] >= threshold))) f.crossings++;
+    }
+    f.mean = sum / v.size();
+    for (uint16_t x : v) sumSq += (x - f.mean) * (x - f.mean);
+    f.rms = sqrt(sumSq / v.size());
+}
+
+// Loop passes every loopUs (plus jitter), with an occasional long stall like a publish in loop().
+struct sampleLog { uint64_t atUs; uint16_t pin; };
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(28);
+    std::vector<sampleLog> log;
+    double phase60 = 0.3;
+    bool wet = false;
+    std::vector<uint64_t> spikesUs;
+
+    host::analogRead = [&](uint16_t pin) -> int32_t {
+        log.push_back({ host::nowUs, pin });
+        double t = host::nowUs / 1e6;
+        if (pin == PIN_ADC_2) {
+            return (int32_t)lround(2048 + 600 * sin(2 * M_PI * 60 * t + phase60));
+        }
+        for (uint64_t s : spikesUs) {
+            if (host::nowUs >= s && host::nowUs < s + 1000) return 3000;
+        }
+        return wet ? 2600 : 400;
+    };
+
+    PortSampler port1(PIN_ADC_1, 1000, 10000, 1500);
+    PortSampler port2(PIN_ADC_2, 500, 60000, 2048);
+    struct PortSampler::intervalSummary s1, s2;
+    port1.begin();
+    port2.begin();
+
+    // 15 minutes of loop passes every 50..250 us, with a 1.5 s stall each minute.
+    std::uniform_int_distribution<int> jitter(50, 250);
+    uint64_t start = host::nowUs;
+    uint64_t worstPassUs = 0;
+    host::delayedUs = 0;
+    while (host::nowUs < start + 15ULL * 60 * 1000000) {
+        uint64_t before = host::nowUs;
+        port1.process();
+        port2.process();
+        worstPassUs = std::max(worstPassUs, host::nowUs - before);
+        host::advanceUs(jitter(rng));
+        if (((host::nowUs - start) % 60000000ULL) < 200) {
+            host::advanceMs(1500);
+        }
+    }
+    CHECK(host::delayedUs == 0);
+    CHECK(worstPassUs == 0);                            // No busy-wait: the virtual clock never moves inside process()
+
+    port1.takeInterval(s1);
+    port2.takeInterval(s2);
+    CHECK(s1.blocks >= 89 && s1.blocks <= 91);          // One per 10 s
+    CHECK(s2.blocks == 15);                             // One per minute
+    CHECK(s1.overThreshold == 0 && s1.overRunMax == 0 && s1.peak == 400);
+
+    // Samples of each block: at most one per grid slot from the block start, and never more than one loop pass late.
+    size_t port2Samples = 0;
+    uint64_t blockStart = 0, prevSlot = 0;
+    int offGrid = 0, sharedSlot = 0;
+    for (const sampleLog &entry : log) {
+        if (entry.pin != PIN_ADC_2) continue;
+        uint64_t slot = (entry.atUs - blockStart) / 500;
+        if ((port2Samples % PORT_SAMPLER_BLOCK_SIZE) == 0) {
+            blockStart = entry.atUs;
+            slot = 0;
+        }
+        else
+        {
+            sharedSlot  += (slot <= prevSlot);
+            offGrid     += (((entry.atUs - blockStart) % 500) > 250);
+        }
+        prevSlot = slot;
+        port2Samples++;
+    }
+    CHECK(port2Samples == 15 * PORT_SAMPLER_BLOCK_SIZE);
+    CHECK(sharedSlot == 0);
+    CHECK(offGrid == 0);
+
+    // 60 Hz at 600 counts peak: AC RMS ~424 from ~1 sample per 500-750 us.
+    CHECK(fabs(s2.rmsMax - 600 / sqrt(2.0)) < 40);
+    CHECK(s2.crossings > 0);
+
+    // Leak probe: 1 ms spikes over the wet level give short runs only; a wet probe runs the whole block.
+    log.clear();
+    for (int i = 0; i < 1200; i++) spikesUs.push_back(host::nowUs + i * 50000ULL);
+    uint64_t until = host::nowUs + 60ULL * 1000000;
+    while (host::nowUs < until) {
+        port1.process();
+        host::advanceUs(100);
+    }
+    port1.takeInterval(s1);
+    CHECK(s1.overThreshold > 0);
+    CHECK(s1.overRunMax > 0 && s1.overRunMax < 32);
+    spikesUs.clear();
+    wet = true;
+    until = host::nowUs + 30ULL * 1000000;
+    while (host::nowUs < until) {
+        port1.process();
+        host::advanceUs(100);
+    }
+    port1.takeInterval(s1);
+    CHECK(s1.overRunMax == PORT_SAMPLER_BLOCK_SIZE);
+
+    // Kernel against the reference on random & patterned blocks.
+    std::uniform_int_distribution<int> adc(0, 4095);
+    for (int trial = 0; trial < 2000; trial++) {
+        size_t n = 1 + (trial % PORT_SAMPLER_BLOCK_SIZE);
+        std::vector<uint16_t> v(n);
+        for (size_t i = 0; i < n; i++) v[i] = (trial & 1) ? adc(rng) : (uint16_t)(((i / (1 + trial % 7)) & 1) ? 3000 : 1000);
+        struct PortSampler::blockFeatures got, want;
+        PortSampler::reduceBlock(v.data(), n, 2048, got);
+        reference(v, 2048, want);
+        CHECK(got.min == want.min && got.max == want.max);
+        CHECK(got.overThreshold == want.overThreshold && got.overRun == want.overRun && got.crossings == want.crossings);
+        CHECK(fabs(got.mean - want.mean) < 1e-9);
+        CHECK(fabs(got.rms - want.rms) < 1e-6 * (1 + want.rms));
+    }
+
+    if (bench) {
+        std::vector<uint16_t> big(1 << 20);
+        for (uint16_t &x : big) x = adc(rng);
+        struct PortSampler::blockFeatures f;
+        double nsBlock = bench_ns(20000, [&](long i) {
+            PortSampler::reduceBlock(&big[(i * PORT_SAMPLER_BLOCK_SIZE) & ((1 << 20) - 1)], PORT_SAMPLER_BLOCK_SIZE, 2048, f);
+            keep(f);
+        });
+        double nsLarge = bench_ns(50, [&](long) { PortSampler::reduceBlock(big.data(), big.size(), 2048, f); keep(f); });
+        printf("port sampler reduceBlock: %.1f ns per 128-sample block, %.2f ns/sample over 1M samples\n", nsBlock, nsLarge / big.size());
+    }
+
+    TEST_END();
+}
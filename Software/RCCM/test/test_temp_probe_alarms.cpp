@@ -0,0 +1,198 @@
+// TempProbes alarm monitoring on the simulated bus, with every probe parasite powered: TH/TL go out between conversions
+// (never cutting the strong pull-up), a cycle with every probe in range reads no scratchpads, alarms match the exact
+// calibrated comparison plus hysteresis over random temperatures near both thresholds, a probe dithering on a threshold
+// alarms once, power loss and recalibration reprogram TH/TL, and getReadings() leaves the cycle fresh.  Benchmarks bus
+// time per cycle for a full read against the alarm search.
+#include "test.h"
+#include "onewire_model.h"
+#include "OneWire.cpp"
+#include "TempProbes.cpp"
+#include <random>
+
+using onewire_model::Device;
+
+static std::mt19937 rng(49);
+
+static const int    probeCount  = 8;
+static const float  lowC        = 4.4f;     // 40 F
+static const float  highC       = 35.0f;    // 95 F
+
+static uint64_t scratchReads() {
+    uint64_t reads = 0;
+    for (auto &d : onewire_model::devices) {
+        reads += d.scratchReads;
+    }
+    return reads;
+}
+
+// One probe period at a call a second; returns the scratchpad reads, and the bus time spent inside process().
+static uint64_t cycle(TempProbes &probes, uint64_t &busUs) {
+    uint64_t before = scratchReads();
+    busUs = 0;
+    for (int i = 0; i < 60; i++) {
+        uint64_t start = host::nowUs;
+        probes.process();
+        busUs += host::nowUs - start;
+        host::advanceMs(1000);
+    }
+    return scratchReads() - before;
+}
+
+static Device &deviceFor(const TempProbes &probes, int index) {
+    for (auto &d : onewire_model::devices) {
+        if (memcmp(d.rom, probes.getChannel(index).rom, 8) == 0) return d;
+    }
+    return onewire_model::devices[0];
+}
+
+static float calibrated(const TempProbes &probes, int index, double tempC) {
+    const TempProbes::channel &channel = probes.getChannel(index);
+    return ((float)lround(tempC * 16) / 16.0f) * channel.gain + channel.offset;
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+
+    onewire_model::attach();
+    for (int i = 0; i < probeCount; i++) {
+        onewire_model::devices.push_back(Device::ds18b20(10 + i, 10.0 + i));
+        onewire_model::devices.back().parasite = true;
+    }
+    OneWire bus(3);
+    TempProbes probes(bus, 60000);
+    probes.begin(64);
+    CHECK(probes.channelCount() == probeCount);
+    CHECK(probes.configureChannel(1, nullptr, 1.3f, 1.0f) == true);
+    CHECK(probes.configureChannel(2, nullptr, -0.7f, 1.05f) == true);
+    probes.setFullReadPeriod(15 * 60000);
+
+    // Thresholds are stored, not written, until process() runs between conversions.
+    CHECK(probes.programAlarms(NAN, highC) == false);
+    CHECK(probes.programAlarms(highC, lowC) == false);
+    uint64_t writesBefore = 0;
+    for (auto &d : onewire_model::devices) {
+        writesBefore += d.scratchWrites;
+    }
+    onewire_model::resetStats();
+    probes.process();           // Starts the first conversion
+    CHECK(probes.programAlarms(lowC, highC) == true);
+    uint64_t writesAfter = 0;
+    for (auto &d : onewire_model::devices) {
+        writesAfter += d.scratchWrites;
+    }
+    CHECK(writesAfter == writesBefore);
+
+    struct TempProbes::readings readings;
+    uint64_t busUs, reads;
+    cycle(probes, busUs);
+    cycle(probes, busUs);
+    for (int i = 0; i < probeCount; i++) {
+        const TempProbes::channel &channel = probes.getChannel(i);
+        CHECK((int8_t)deviceFor(probes, i).scratch[2] == (int8_t)floorf((highC - channel.offset) / channel.gain));
+        CHECK((int8_t)deviceFor(probes, i).scratch[3] == (int8_t)floorf((lowC - channel.offset) / channel.gain));
+    }
+    CHECK(onewire_model::violations.conversionCut == 0);
+    CHECK(probes.programAlarms(lowC, highC) == true);      // Unchanged: nothing to write
+    probes.takeReadings(readings);
+    for (int i = 0; i < probeCount; i++) {
+        CHECK(readings.valid[i] == true && readings.alarm[i] == false);
+    }
+    CHECK(probes.takeNewAlarms() == 0);
+
+    // Steady state, all in range: the convert and an empty alarm search.
+    onewire_model::resetStats();
+    reads = cycle(probes, busUs);
+    CHECK(reads == 0);
+    CHECK(onewire_model::resets == 2);
+
+    // One probe out of range: only it is read.
+    int hot = 5;
+    deviceFor(probes, hot).tempC = 40.0;
+    reads = cycle(probes, busUs);
+    CHECK(reads == 1);
+    CHECK(probes.takeNewAlarms() == (1UL << hot));
+    CHECK(probes.getReadings().alarm[hot] == true);
+    CHECK(fabs(probes.getReadings().temperatureC[hot] - 40.0) < 0.01);
+    CHECK(probes.takeReadings(readings) == true);           // getReadings() did not take it
+    cycle(probes, busUs);
+    CHECK(probes.takeNewAlarms() == 0);                     // Still out; no new edge
+
+    // Just inside the threshold is still in alarm; past the hysteresis it clears.
+    deviceFor(probes, hot).tempC = highC - TEMP_PROBES_HYSTERESIS_C / 2;
+    cycle(probes, busUs);
+    CHECK(probes.getReadings().alarm[hot] == true);
+    deviceFor(probes, hot).tempC = 20.0;
+    cycle(probes, busUs);
+    CHECK(probes.getReadings().alarm[hot] == false);
+    CHECK(probes.takeNewAlarms() == 0);
+
+    // A probe dithering a count either side of the threshold alarms once.
+    int dither = 3;
+    for (int i = 0; i < 60; i++) {
+        deviceFor(probes, dither).tempC = highC + (((i % 2) == 0) ? 0.0625 : -0.0625);
+        cycle(probes, busUs);
+        uint32_t bits = probes.takeNewAlarms();
+        CHECK(bits == ((i == 0) ? (1UL << dither) : 0));
+    }
+    deviceFor(probes, dither).tempC = 20.0;
+    cycle(probes, busUs);
+
+    // Random temperatures near both thresholds: every cycle's alarms equal the exact comparison on the calibrated
+    // value, with the hysteresis applied to channels already in alarm.
+    std::uniform_real_distribution<double> nearLow(lowC - 3, lowC + 3), nearHigh(highC - 3, highC + 3);
+    bool expected[probeCount] = {};
+    int alarmed = 0;
+    for (int iteration = 0; iteration < 400 && testFailures == 0; iteration++) {
+        for (auto &d : onewire_model::devices) {
+            d.tempC = ((rng() & 1) != 0) ? nearLow(rng) : nearHigh(rng);
+        }
+        cycle(probes, busUs);
+        probes.takeReadings(readings);
+        for (int i = 0; i < probeCount; i++) {
+            float t = calibrated(probes, i, deviceFor(probes, i).tempC);
+            bool outside = (t < lowC) || (t > highC);
+            bool inside = (t >= lowC + TEMP_PROBES_HYSTERESIS_C) && (t <= highC - TEMP_PROBES_HYSTERESIS_C);
+            expected[i] = outside || (expected[i] && !inside);
+            CHECK(readings.alarm[i] == expected[i]);
+            alarmed += expected[i] ? 1 : 0;
+            if (testFailures > 0) printf("  channel %d at %.4f C, iteration %d\n", i, t, iteration);
+        }
+        probes.takeNewAlarms();
+    }
+    CHECK(alarmed > 0);
+
+    // Power loss: TH/TL revert to the probe's EEPROM; the next full read queues it and process() reprograms it.
+    for (auto &d : onewire_model::devices) {
+        d.tempC = 20;
+    }
+    Device &lost = deviceFor(probes, 4);
+    memcpy(&lost.scratch[2], lost.eeprom, 3);
+    lost.scratch[8] = onewire_model::crc8(lost.scratch, 8);
+    host::advanceMs(15 * 60000);
+    cycle(probes, busUs);
+    cycle(probes, busUs);
+    CHECK((int8_t)lost.scratch[2] == (int8_t)floorf((highC - probes.getChannel(4).offset) / probes.getChannel(4).gain));
+    CHECK(memcmp(lost.eeprom, "\x4B\x46\x7F", 3) == 0);     // The probe's EEPROM is never written
+
+    // Recalibration moves TH/TL.
+    CHECK(probes.configureChannel(0, nullptr, 2.0f, 1.0f) == true);
+    cycle(probes, busUs);
+    CHECK((int8_t)deviceFor(probes, 0).scratch[2] == 33 && (int8_t)deviceFor(probes, 0).scratch[3] == 2);
+    CHECK(onewire_model::violations.conversionCut == 0);
+    CHECK(onewire_model::totalViolations() == 0);
+
+    if (bench == true) {
+        cycle(probes, busUs);
+        probes.setFullReadPeriod(0);
+        uint64_t fullReads = cycle(probes, busUs);
+        uint64_t fullUs = busUs;
+        probes.setFullReadPeriod(15 * 60000);
+        cycle(probes, busUs);
+        uint64_t searchReads = cycle(probes, busUs);
+        printf("bench bus time per cycle, %d probes in range: full read %llu us (%llu scratchpads), alarm search %llu us "
+               "(%llu scratchpads)\n", probeCount, (unsigned long long)fullUs, (unsigned long long)fullReads,
+               (unsigned long long)busUs, (unsigned long long)searchReads);
+    }
+
+    TEST_END();
+}
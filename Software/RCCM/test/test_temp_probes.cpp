@@ -0,0 +1,170 @@
+// TempProbes on the simulated 1-Wire bus: discovery maps DS18B20s (and not other families) to named channels, one
+// broadcast convert per period, calibrated readings at every resolution, a bad CRC or a missing probe invalidates only
+// that channel, names & calibration survive a reboot through EEPROM with new probes appended, and the bus timing
+// stays inside the datasheet limits throughout.
+#include "test.h"
+#include "onewire_model.h"
+#include "OneWire.cpp"
+#include "TempProbes.cpp"
+#include <random>
+
+using onewire_model::Device;
+
+static std::mt19937 rng(47);
+
+// process() every millisecond, long enough for a convert & the reads.
+static void runCycle(TempProbes &probes) {
+    for (int i = 0; i < 2000; i++) {
+        probes.process();
+        host::advanceUs(1000);
+    }
+}
+
+static const Device &deviceFor(const TempProbes::channel &channel) {
+    for (auto &d : onewire_model::devices) {
+        if (memcmp(d.rom, channel.rom, 8) == 0) return d;
+    }
+    return onewire_model::devices[0];
+}
+
+int main() {
+    onewire_model::attach();
+    onewire_model::devices.push_back(Device::ds18b20(3, 4.5));
+    onewire_model::devices.push_back(Device::ds18b20(1, -12.25));
+    onewire_model::devices.push_back(Device::ds18b20(2, 21.0625));
+    {
+        // Another family on the same bus is skipped.
+        uint8_t rom[8] = { 0x01, 9, 9, 9, 9, 9, 9, 0 };
+        rom[7] = onewire_model::crc8(rom, 7);
+        onewire_model::devices.push_back(Device(rom));
+    }
+
+    OneWire bus(3);
+    TempProbes probes(bus, 60000);
+    probes.begin(64);
+    CHECK(probes.channelCount() == 3);
+    for (int i = 0; i < 3; i++) {
+        char name[TEMP_PROBES_NAME_SIZE];
+        snprintf(name, sizeof(name), "probe%d", i + 1);
+        CHECK(strcmp(probes.getChannel(i).name, name) == 0);
+        CHECK(probes.getChannel(i).rom[0] == 0x28);
+    }
+    char romString[TEMP_PROBES_ROM_STRING];
+    TempProbes::formatRom(onewire_model::devices[0].rom, romString);
+    CHECK(strlen(romString) == 16 && strncmp(romString, "28", 2) == 0);
+
+    // Names & calibration; bad values and duplicate names are refused.
+    int crawlspace = probes.findChannel("probe1");
+    int pipeChase = probes.findChannel("probe2");
+    CHECK(probes.configureChannel(crawlspace, "crawlspace", 0.5f, 1.0f) == true);
+    CHECK(probes.configureChannel(crawlspace, "", 0, 1) == false);
+    CHECK(probes.configureChannel(crawlspace, "this name is too long", 0, 1) == false);
+    CHECK(probes.configureChannel(crawlspace, nullptr, NAN, 1) == false);
+    CHECK(probes.configureChannel(crawlspace, nullptr, 0, 0.1f) == false);
+    CHECK(probes.configureChannel(pipeChase, "crawlspace", 0, 1) == false);
+    CHECK(probes.configureChannel(pipeChase, "pipe chase", -0.25f, 1.02f) == true);
+    CHECK(probes.findChannel("crawlspace") == crawlspace);
+    CHECK(probes.findChannel("nope") == -1);
+
+    // One broadcast convert reaches every probe; each is read & calibrated.
+    struct TempProbes::readings readings;
+    onewire_model::resetStats();
+    runCycle(probes);
+    CHECK(probes.takeReadings(readings) == true);
+    CHECK(probes.takeReadings(readings) == false);
+    CHECK(readings.count == 3);
+    for (int i = 0; i < 3; i++) {
+        const TempProbes::channel &channel = probes.getChannel(i);
+        CHECK(deviceFor(channel).converts == 1);
+        double expected = (round(deviceFor(channel).tempC * 16) / 16.0) * channel.gain + channel.offset;
+        CHECK(readings.valid[i] == true);
+        CHECK(fabs(readings.temperatureC[i] - expected) < 1e-4);
+    }
+    CHECK(onewire_model::totalViolations() == 0);
+
+    // Random temperatures over the DS18B20 range.
+    for (int cycle = 0; cycle < 200 && testFailures == 0; cycle++) {
+        for (auto &d : onewire_model::devices) {
+            d.tempC = -55 + (rng() % (180 * 16)) / 16.0;
+        }
+        host::advanceMs(60000);
+        runCycle(probes);
+        CHECK(probes.takeReadings(readings) == true);
+        for (int i = 0; i < 3; i++) {
+            const TempProbes::channel &channel = probes.getChannel(i);
+            CHECK(readings.raw[i] == (int16_t)lround(deviceFor(channel).tempC * 16));
+            CHECK(fabs(readings.temperatureC[i] - (readings.raw[i] / 16.0 * channel.gain + channel.offset)) < 1e-3);
+        }
+    }
+    CHECK(onewire_model::totalViolations() == 0);
+
+    // The period holds: no convert before 60 s.
+    uint64_t before = onewire_model::devices[0].converts;
+    for (int i = 0; i < 50; i++) {
+        probes.process();
+        host::advanceMs(1000);
+    }
+    CHECK(onewire_model::devices[0].converts == before);
+    for (int i = 0; i < 10; i++) {
+        probes.process();
+        host::advanceMs(1000);
+    }
+    CHECK(onewire_model::devices[0].converts == before + 1);
+
+    // A bad CRC on one probe: only that channel is invalid.
+    host::advanceMs(60000);
+    onewire_model::devices[1].corruptReads = 1;
+    runCycle(probes);
+    probes.takeReadings(readings);
+    for (int i = 0; i < 3; i++) {
+        bool corrupt = (memcmp(probes.getChannel(i).rom, onewire_model::devices[1].rom, 8) == 0);
+        CHECK(readings.valid[i] == !corrupt);
+        CHECK(isnan(readings.temperatureC[i]) == corrupt);
+    }
+
+    // A disconnected probe: the same.
+    host::advanceMs(60000);
+    onewire_model::devices[0].connected = false;
+    runCycle(probes);
+    probes.takeReadings(readings);
+    for (int i = 0; i < 3; i++) {
+        bool gone = (memcmp(probes.getChannel(i).rom, onewire_model::devices[0].rom, 8) == 0);
+        CHECK(readings.valid[i] == !gone);
+    }
+    onewire_model::devices[0].connected = true;
+
+    // 9 bit resolution: counts in 1/2 °C steps.
+    {
+        uint8_t scratchpad[9] = {};
+        int16_t raw;
+        CHECK(TempProbes::decodeScratchpad(scratchpad, raw) == false);
+        uint8_t nineBit[9] = { 0x57, 0x01, 0x4B, 0x46, 0x1F, 0xFF, 0x0C, 0x10, 0 };
+        nineBit[8] = onewire_model::crc8(nineBit, 8);
+        CHECK(TempProbes::decodeScratchpad(nineBit, raw) == true && raw == 0x150);
+    }
+
+    // Reboot: names, calibration & channel order come back from EEPROM; a new probe is appended.
+    onewire_model::devices.push_back(Device::ds18b20(0, 30.0));
+    TempProbes rebooted(bus, 60000);
+    rebooted.begin(64);
+    CHECK(rebooted.channelCount() == 4);
+    CHECK(rebooted.findChannel("crawlspace") == crawlspace);
+    CHECK(rebooted.findChannel("pipe chase") == pipeChase);
+    CHECK(strcmp(rebooted.getChannel(3).name, "probe4") == 0);
+    CHECK(rebooted.getChannel(pipeChase).gain == 1.02f);
+
+    // An empty bus: the whole cycle is invalid, but it still completes.
+    host::advanceMs(60000);
+    for (auto &d : onewire_model::devices) {
+        d.connected = false;
+    }
+    runCycle(rebooted);
+    CHECK(rebooted.takeReadings(readings) == true);
+    for (int i = 0; i < 4; i++) {
+        CHECK(readings.valid[i] == false);
+    }
+    printf("1-Wire: %llu resets, %llu slots, longest interrupts off %llu us\n", (unsigned long long)onewire_model::resets,
+           (unsigned long long)onewire_model::slots, (unsigned long long)host::irqOffMaxUs);
+
+    TEST_END();
+}
@@ -0,0 +1,186 @@
+// UartBridge: COBS round trips through a stand-in serial port, malformed & oversize frames, and a wire model at
+// 115200 baud (8N1, 11520 B/s) feeding a 64 byte RX ring while loop() calls process() once per millisecond.
+#include "test.h"
+#include "UartBridge.cpp"
+#include <deque>
+#include <random>
+
+#define WIRE_BYTES_PER_SEC      11520       // 115200 baud, 10 bits per byte
+#define RX_RING_SIZE            64          // Device OS Serial1 receive buffer
+
+// Serial port stand-in.  Writes go to tx; the receive side is a bounded ring the test (or the wire model) fills,
+// counting bytes lost to a full ring as the UART would.
+struct PipePort : public Stream {
+    std::vector<uint8_t>    tx;
+    std::deque<uint8_t>     rx;
+    size_t                  rxCapacity = RX_RING_SIZE;
+    uint64_t                rxOverruns = 0;
+    int                     txRoom = 1 << 20;
+
+    size_t write(uint8_t b) override { tx.push_back(b); return 1; }
+    int availableForWrite() override { return txRoom; }
+    int available() override { return (int)rx.size(); }
+    int read() override {
+        if (rx.empty() == true) return -1;
+        uint8_t b = rx.front();
+        rx.pop_front();
+        return b;
+    }
+    void arrive(uint8_t b) {
+        if (rx.size() >= rxCapacity) { rxOverruns++; return; }
+        rx.push_back(b);
+    }
+};
+
+static std::vector<std::vector<uint8_t>> frames;
+static void onFrame(const uint8_t *payload, size_t length) { frames.emplace_back(payload, payload + length); }
+
+// Encode with a second bridge so the test doesn't carry its own COBS encoder.
+static std::vector<uint8_t> encode(uint8_t type, const std::vector<uint8_t> &payload) {
+    PipePort port;
+    UartBridge bridge(port);
+    CHECK(bridge.send(type, payload.data(), payload.size()) > 0);
+    return port.tx;
+}
+
+static void feed(UartBridge &bridge, const std::vector<uint8_t> &bytes) {
+    for (uint8_t b : bytes) bridge.processByte(b);
+}
+
+int main(int argc, char **argv) {
+    bool bench = bench_requested(argc, argv);
+    std::mt19937 rng(29);
+
+    // Round trips: every length that fits, zero-heavy and zero-free payloads.
+    {
+        PipePort port;
+        port.rxCapacity = 1 << 20;
+        UartBridge bridge(port);
+        CHECK(bridge.addHandler(7, onFrame) == true);
+        for (int trial = 0; trial < 4000; trial++) {
+            size_t n = trial % UART_BRIDGE_FRAME_MAX;
+            std::vector<uint8_t> payload(n);
+            for (auto &b : payload) b = (trial & 1) ? (uint8_t)(1 + rng() % 255) : ((rng() % 3 == 0) ? 0 : (uint8_t)rng());
+            frames.clear();
+            CHECK(bridge.send(7, payload.data(), payload.size()) > 0);
+            CHECK(port.tx.size() <= n + 3);
+            CHECK(std::count(port.tx.begin(), port.tx.end(), 0) == 1);      // Only the delimiter is zero
+            for (uint8_t b : port.tx) port.arrive(b);
+            port.tx.clear();
+            while (port.available() > 0) bridge.process();
+            CHECK(frames.size() == 1);
+            CHECK(frames.size() == 1 && frames[0] == payload);
+        }
+        CHECK(bridge.framesReceived == 4000);
+        CHECK(bridge.framesDropped == 0);
+        CHECK(bridge.framesUnhandled == 0);
+    }
+
+    // Too large to send; TX buffer too full to take the whole frame.
+    {
+        PipePort port;
+        UartBridge bridge(port);
+        std::vector<uint8_t> payload(UART_BRIDGE_FRAME_MAX, 0x55);
+        CHECK(bridge.send(1, payload.data(), payload.size()) == 0);
+        CHECK(bridge.send(1, payload.data(), UART_BRIDGE_FRAME_MAX - 1) > 0);
+        port.tx.clear();
+        port.txRoom = 4;
+        CHECK(bridge.send(1, payload.data(), 8) == 0);
+        CHECK(port.tx.empty() == true);
+    }
+
+    // Malformed input: truncated block, oversize frame, unknown type.  The decoder resynchronises on the next
+    // delimiter each time.
+    {
+        PipePort port;
+        UartBridge bridge(port);
+        bridge.addHandler(2, onFrame);
+        frames.clear();
+
+        feed(bridge, { 0x05, 0x02, 0x11, 0x00 });                          // Code promises 4 data bytes, 2 arrive
+        CHECK(bridge.framesDropped == 1);
+        CHECK(frames.empty() == true);
+
+        std::vector<uint8_t> oversize = { 0xFF };
+        for (int i = 0; i < 254; i++) oversize.push_back(0x02);
+        oversize.push_back(0x00);
+        feed(bridge, oversize);
+        CHECK(bridge.framesDropped == 2);
+        CHECK(frames.empty() == true);
+
+        feed(bridge, encode(9, { 1, 2, 3 }));
+        CHECK(bridge.framesUnhandled == 1);
+
+        feed(bridge, { 0x00, 0x00 });                                       // Empty frames are ignored
+        CHECK(bridge.framesReceived == 1);
+
+        feed(bridge, encode(2, { 0x00, 0x10, 0x00 }));
+        CHECK(frames.size() == 1);
+        CHECK(frames.size() == 1 && frames[0] == std::vector<uint8_t>({ 0x00, 0x10, 0x00 }));
+    }
+
+    // Handler table is bounded.
+    {
+        PipePort port;
+        UartBridge bridge(port);
+        for (int i = 0; i < UART_BRIDGE_HANDLERS_MAX; i++) CHECK(bridge.addHandler(i, onFrame) == true);
+        CHECK(bridge.addHandler(0x7F, onFrame) == false);
+    }
+
+    // Wire model: a sensor streams frames back to back at line rate for 60 s.  process() once per 1 ms loop()
+    // pass drains up to UART_BRIDGE_DRAIN_MAX bytes; the 64 byte ring must never overrun.
+    {
+        PipePort port;
+        UartBridge bridge(port);
+        bridge.addHandler(1, onFrame);
+        bridge.addHandler(2, onFrame);
+        frames.clear();
+
+        std::vector<uint8_t> wire;
+        size_t sent = 0;
+        while (wire.size() < (size_t)WIRE_BYTES_PER_SEC * 60) {
+            std::vector<uint8_t> payload((sent & 1) ? 4 : 2);
+            for (auto &b : payload) b = (uint8_t)rng();
+            std::vector<uint8_t> bytes = encode((sent & 1) ? 2 : 1, payload);
+            wire.insert(wire.end(), bytes.begin(), bytes.end());
+            sent++;
+        }
+
+        uint64_t startUs = host::nowUs;
+        size_t onWire = 0;
+        size_t maxQueued = 0;
+        while (onWire < wire.size() || port.available() > 0) {
+            size_t due = (size_t)(((host::nowUs - startUs) * WIRE_BYTES_PER_SEC) / 1000000);
+            while (onWire < due && onWire < wire.size()) port.arrive(wire[onWire++]);
+            maxQueued = std::max(maxQueued, port.rx.size());
+            bridge.process();
+            host::advanceMs(1);
+        }
+        CHECK(port.rxOverruns == 0);
+        CHECK(frames.size() == sent);
+        CHECK(bridge.framesDropped == 0);
+        printf("wire model: %zu frames, %zu bytes in 60 s, ring peak %zu/%d bytes\n", frames.size(), wire.size(),
+               maxQueued, RX_RING_SIZE);
+    }
+
+    if (bench == true) {
+        // Decode cost per byte, against the 86.8 us a byte takes on the wire at 115200 baud.
+        PipePort port;
+        UartBridge bridge(port);
+        bridge.addHandler(2, onFrame);
+        std::vector<uint8_t> stream;
+        for (int i = 0; i < 1000; i++) {
+            std::vector<uint8_t> payload(4);
+            for (auto &b : payload) b = (uint8_t)rng();
+            std::vector<uint8_t> bytes = encode(2, payload);
+            stream.insert(stream.end(), bytes.begin(), bytes.end());
+        }
+        frames.reserve(1000000);
+        double ns = bench_ns((long)stream.size() * 100, [&](long i) { bridge.processByte(stream[i % stream.size()]); });
+        printf("bench processByte: %.1f ns/byte (%.0f bytes/s decode, %d bytes/s on the wire)\n", ns, 1e9 / ns,
+               WIRE_BYTES_PER_SEC);
+        keep(bridge.framesReceived);
+    }
+
+    TEST_END();
+}